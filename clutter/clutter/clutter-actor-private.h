@@ -257,6 +257,12 @@ void                            _clutter_actor_detach_clone
 void                            _clutter_actor_queue_only_relayout                      (ClutterActor *actor);
 void                            clutter_actor_clear_stage_views_recursive               (ClutterActor *actor);
 
+GParamSpec *                    clutter_actor_find_animated_property                    (ClutterActor *self,
+                                                                                         const char   *property_name);
+void                            clutter_actor_set_animated_property                     (ClutterActor *self,
+                                                                                         GParamSpec   *pspec,
+                                                                                         const GValue *value);
+
 float                           clutter_actor_get_real_resource_scale                   (ClutterActor *actor);
 
 ClutterPaintNode *              clutter_actor_create_texture_paint_node                 (ClutterActor *self,
@@ -267,6 +273,10 @@ void clutter_actor_finish_layout (ClutterActor *self,
 
 void clutter_actor_queue_immediate_relayout (ClutterActor *self);
 
+gboolean clutter_actor_allocate_relayout_boundary (ClutterActor *self);
+
+unsigned int clutter_actor_get_allocation_counter (void);
+
 gboolean clutter_actor_is_painting_unmapped (ClutterActor *self);
 
 gboolean clutter_actor_get_redraw_clip (ClutterActor       *self,
@@ -610,6 +610,7 @@
 #include "clutter-action-private.h"
 #include "clutter-actor-meta-private.h"
 #include "clutter-animatable.h"
+#include "clutter-canvas.h"
 #include "clutter-color-state.h"
 #include "clutter-color-static.h"
 #include "clutter-color.h"
@@ -622,10 +623,12 @@
 #include "clutter-enum-types.h"
 #include "clutter-fixed-layout.h"
 #include "clutter-flatten-effect.h"
+#include "clutter-image.h"
 #include "clutter-interval.h"
 #include "clutter-main.h"
 #include "clutter-marshal.h"
 #include "clutter-mutter.h"
+#include "clutter-offscreen-effect.h"
 #include "clutter-paint-context-private.h"
 #include "clutter-paint-nodes.h"
 #include "clutter-paint-node-private.h"
@@ -637,6 +640,7 @@
 #include "clutter-script-private.h"
 #include "clutter-stage-private.h"
 #include "clutter-stage-view-private.h"
+#include "clutter-texture-content.h"
 #include "clutter-timeline.h"
 #include "clutter-transition.h"
 #include "clutter-units.h"
@@ -804,6 +808,14 @@ struct _ClutterActorPrivate
 
   unsigned int n_pointers;
 
+  /* The content nodes of the last paint, reused by the following paints
+   * until a redraw is queued on the actor; see clutter_actor_paint_node()
+   */
+  GPtrArray *retained_paint_nodes;
+  float retained_paint_width;
+  float retained_paint_height;
+  guint8 retained_paint_opacity;
+
   /* bitfields: KEEP AT THE END */
 
   /* fixed position and sizes */
@@ -845,6 +857,11 @@ struct _ClutterActorPrivate
   guint had_effects_on_last_paint_volume_update : 1;
   guint needs_update_stage_views    : 1;
   guint clear_stage_views_needs_stage_views_changed : 1;
+  /* queued on the stage as a relayout boundary, see
+   * clutter_actor_is_relayout_boundary() */
+  guint relayout_boundary_queued    : 1;
+  /* set once the actor got its first allocation */
+  guint was_allocated               : 1;
 };
 
 enum
@@ -1071,6 +1088,9 @@ static void clutter_actor_pop_in_cloned_branch (ClutterActor *self,
                                                 gulong        count);
 static void ensure_valid_actor_transform (ClutterActor *actor);
 
+static void clutter_actor_allocate_internal (ClutterActor          *self,
+                                             const ClutterActorBox *allocation);
+
 static void push_in_paint_unmapped_branch (ClutterActor *self,
                                            guint         count);
 static void pop_in_paint_unmapped_branch (ClutterActor *self,
@@ -1092,6 +1112,9 @@ static GQuark quark_proximity = 0;
 static GQuark quark_pad = 0;
 static GQuark quark_im = 0;
 
+/* number of calls to the allocate() vfunc, for layout instrumentation */
+static unsigned int allocation_counter = 0;
+
 G_DEFINE_TYPE_WITH_CODE (ClutterActor,
                          clutter_actor,
                          G_TYPE_INITIALLY_UNOWNED,
@@ -1649,6 +1672,11 @@ clutter_actor_real_unmap (ClutterActor *self)
 
   CLUTTER_ACTOR_UNSET_FLAGS (self, CLUTTER_ACTOR_MAPPED);
 
+  /* Redraws queued while unmapped are dropped, so the retained nodes
+   * could go stale without us noticing.
+   */
+  g_clear_pointer (&priv->retained_paint_nodes, g_ptr_array_unref);
+
   if (priv->unmapped_paint_branch_counter == 0)
     {
       /* clear the contents of the last paint volume, so that hiding + moving +
@@ -2148,6 +2176,12 @@ unrealize_actor_after_children_cb (ClutterActor *self,
       priv->parent->flags & CLUTTER_ACTOR_NO_LAYOUT)
     clutter_stage_dequeue_actor_relayout (CLUTTER_STAGE (stage), self);
 
+  if (stage != NULL && priv->relayout_boundary_queued)
+    {
+      clutter_stage_dequeue_actor_relayout (CLUTTER_STAGE (stage), self);
+      priv->relayout_boundary_queued = FALSE;
+    }
+
   if (stage != NULL)
     clutter_stage_dequeue_actor_redraw (CLUTTER_STAGE (stage), self);
 
@@ -2553,6 +2587,7 @@ clutter_actor_set_allocation_internal (ClutterActor           *self,
   priv->needs_width_request = FALSE;
   priv->needs_height_request = FALSE;
   priv->needs_allocation = FALSE;
+  priv->was_allocated = TRUE;
 
   if (origin_changed || size_changed)
     {
@@ -2689,6 +2724,115 @@ clutter_actor_needs_relayout (ClutterActor *self)
           priv->needs_allocation);
 }
 
+/*
+ * clutter_actor_is_relayout_boundary:
+ * @self: a #ClutterActor
+ *
+ * Checks whether a relayout queued by one of the children of @self can
+ * stop propagating at @self.
+ *
+ * This is the case if @self has a fixed size request and a valid
+ * allocation: nothing its children do can change the size it reports
+ * to its parent, so the layout of the parent stays valid, and @self can
+ * be allocated again with its current allocation box.
+ */
+static inline gboolean
+clutter_actor_is_relayout_boundary (ClutterActor *self)
+{
+  ClutterActorPrivate *priv = self->priv;
+
+  if (priv->parent == NULL ||
+      priv->parent->flags & CLUTTER_ACTOR_NO_LAYOUT)
+    return FALSE;
+
+  if (!CLUTTER_ACTOR_IS_MAPPED (self) ||
+      CLUTTER_ACTOR_IN_DESTRUCTION (self))
+    return FALSE;
+
+  if (!priv->min_width_set || !priv->natural_width_set ||
+      !priv->min_height_set || !priv->natural_height_set)
+    return FALSE;
+
+  /* the parent still has to request our size and allocate us */
+  if (priv->needs_width_request || priv->needs_height_request)
+    return FALSE;
+
+  /* the current allocation box can only be reused if it is valid, or if
+   * it was valid when we got queued as a boundary before
+   */
+  if (!priv->was_allocated ||
+      (priv->needs_allocation && !priv->relayout_boundary_queued))
+    return FALSE;
+
+  return TRUE;
+}
+
+static void
+clutter_actor_queue_boundary_relayout (ClutterActor *self)
+{
+  ClutterActorPrivate *priv = self->priv;
+  ClutterActor *stage;
+
+  priv->needs_allocation = TRUE;
+
+  if (priv->relayout_boundary_queued)
+    return;
+
+  stage = _clutter_actor_get_stage_internal (self);
+  if (stage == NULL)
+    return;
+
+  CLUTTER_NOTE (LAYOUT, "Stopping relayout at boundary '%s'",
+                _clutter_actor_get_debug_name (self));
+
+  priv->relayout_boundary_queued = TRUE;
+  clutter_stage_queue_actor_relayout (CLUTTER_STAGE (stage), self);
+}
+
+/*
+ * clutter_actor_allocate_relayout_boundary:
+ * @self: a #ClutterActor
+ *
+ * Allocates @self, if it was queued by a child as a relayout boundary,
+ * using its current allocation box.
+ *
+ * Returns: %TRUE if @self was queued as a relayout boundary
+ */
+gboolean
+clutter_actor_allocate_relayout_boundary (ClutterActor *self)
+{
+  ClutterActorPrivate *priv = self->priv;
+  ClutterActorBox allocation;
+
+  if (!priv->relayout_boundary_queued)
+    return FALSE;
+
+  priv->relayout_boundary_queued = FALSE;
+
+  /* A full relayout was queued on us after the boundary one; our parent
+   * takes care of allocating us in that case.
+   */
+  if (priv->needs_width_request || priv->needs_height_request)
+    return TRUE;
+
+  if (!priv->needs_allocation ||
+      !priv->was_allocated ||
+      !CLUTTER_ACTOR_IS_MAPPED (self) ||
+      CLUTTER_ACTOR_IN_RELAYOUT (self))
+    return TRUE;
+
+  allocation = priv->allocation;
+  clutter_actor_allocate_internal (self, &allocation);
+
+  return TRUE;
+}
+
+unsigned int
+clutter_actor_get_allocation_counter (void)
+{
+  return allocation_counter;
+}
+
 static void
 clutter_actor_real_queue_relayout (ClutterActor *self)
 {
@@ -2713,6 +2857,8 @@ clutter_actor_real_queue_relayout (ClutterActor *self)
     {
       if (priv->parent->flags & CLUTTER_ACTOR_NO_LAYOUT)
         clutter_actor_queue_shallow_relayout (self);
+      else if (clutter_actor_is_relayout_boundary (priv->parent))
+        clutter_actor_queue_boundary_relayout (priv->parent);
       else
         _clutter_actor_queue_only_relayout (priv->parent);
     }
@@ -3466,6 +3612,35 @@ needs_flatten_effect (ClutterActor *self)
   return FALSE;
 }
 
+/* Returns the outermost effect that renders the actor into an offscreen
+ * buffer at full opacity, and applies the paint opacity only when painting
+ * that buffer. Redraws that only change the opacity can be queued on it to
+ * reuse its cached contents.
+ */
+static ClutterEffect *
+get_opacity_redraw_effect (ClutterActor *self)
+{
+  ClutterActorPrivate *priv = self->priv;
+  const GList *l;
+
+  if (priv->flatten_effect)
+    return priv->flatten_effect;
+
+  if (priv->effects == NULL)
+    return NULL;
+
+  for (l = _clutter_meta_group_peek_metas (priv->effects); l; l = l->next)
+    {
+      if (!clutter_actor_meta_get_enabled (l->data))
+        continue;
+
+      if (CLUTTER_IS_OFFSCREEN_EFFECT (l->data))
+        return l->data;
+    }
+
+  return NULL;
+}
+
 static void
 add_or_remove_flatten_effect (ClutterActor *self)
 {
@@ -3532,18 +3707,91 @@ clutter_actor_real_paint (ClutterActor        *actor,
 }
 
 static gboolean
-clutter_actor_paint_node (ClutterActor        *actor,
-                          ClutterPaintNode    *root,
-                          ClutterPaintContext *paint_context)
+clutter_actor_can_retain_paint_nodes (ClutterActor *actor)
 {
   ClutterActorPrivate *priv = actor->priv;
-  ClutterActorBox box;
-  ClutterColor bg_color;
 
-  box.x1 = 0.f;
-  box.y1 = 0.f;
-  box.x2 = clutter_actor_box_get_width (&priv->allocation);
-  box.y2 = clutter_actor_box_get_height (&priv->allocation);
+  /* The stage clear node is tied to the framebuffer being painted */
+  if (CLUTTER_ACTOR_IS_TOPLEVEL (actor))
+    return FALSE;
+
+  if (G_UNLIKELY (clutter_paint_debug_flags & CLUTTER_DEBUG_REDRAWS))
+    return FALSE;
+
+  /* Contents may paint depending on the paint context, e.g. its redraw
+   * clip; only retain the ones known to depend on the actor state alone,
+   * which queue a redraw on the actor whenever they change.
+   */
+  if (priv->content != NULL &&
+      !CLUTTER_IS_IMAGE (priv->content) &&
+      !CLUTTER_IS_CANVAS (priv->content) &&
+      !CLUTTER_IS_TEXTURE_CONTENT (priv->content))
+    return FALSE;
+
+  return TRUE;
+}
+
+static gboolean
+clutter_actor_add_retained_paint_nodes (ClutterActor     *actor,
+                                        ClutterPaintNode *root,
+                                        ClutterActorBox  *box,
+                                        guint8            paint_opacity)
+{
+  ClutterActorPrivate *priv = actor->priv;
+  unsigned int i;
+
+  if (priv->retained_paint_nodes == NULL)
+    return FALSE;
+
+  if (priv->retained_paint_width != box->x2 ||
+      priv->retained_paint_height != box->y2 ||
+      priv->retained_paint_opacity != paint_opacity)
+    {
+      g_clear_pointer (&priv->retained_paint_nodes, g_ptr_array_unref);
+      return FALSE;
+    }
+
+  for (i = 0; i < priv->retained_paint_nodes->len; i++)
+    clutter_paint_node_add_child (root, priv->retained_paint_nodes->pdata[i]);
+
+  return TRUE;
+}
+
+static void
+clutter_actor_retain_paint_nodes (ClutterActor     *actor,
+                                  ClutterPaintNode *root,
+                                  ClutterActorBox  *box,
+                                  guint8            paint_opacity)
+{
+  ClutterActorPrivate *priv = actor->priv;
+  ClutterPaintNode *node;
+
+  priv->retained_paint_nodes =
+    g_ptr_array_new_full (clutter_paint_node_get_n_children (root),
+                          (GDestroyNotify) clutter_paint_node_unref);
+
+  for (node = clutter_paint_node_get_first_child (root);
+       node != NULL;
+       node = clutter_paint_node_get_next_sibling (node))
+    {
+      g_ptr_array_add (priv->retained_paint_nodes,
+                       clutter_paint_node_ref (node));
+    }
+
+  priv->retained_paint_width = box->x2;
+  priv->retained_paint_height = box->y2;
+  priv->retained_paint_opacity = paint_opacity;
+}
+
+static void
+clutter_actor_build_paint_nodes (ClutterActor        *actor,
+                                 ClutterPaintNode    *root,
+                                 ClutterActorBox     *box,
+                                 guint8               paint_opacity,
+                                 ClutterPaintContext *paint_context)
+{
+  ClutterActorPrivate *priv = actor->priv;
+  ClutterColor bg_color;
 
   bg_color = priv->bg_color;
 
@@ -3567,7 +3815,7 @@ clutter_actor_paint_node (ClutterActor        *actor,
 
       node = clutter_root_node_new (fb, &bg_color, clear_flags);
       clutter_paint_node_set_static_name (node, "stageClear");
-      clutter_paint_node_add_rectangle (node, &box);
+      clutter_paint_node_add_rectangle (node, box);
       clutter_paint_node_add_child (root, node);
       clutter_paint_node_unref (node);
     }
@@ -3576,20 +3824,55 @@ clutter_actor_paint_node (ClutterActor        *actor,
     {
       ClutterPaintNode *node;
 
-      bg_color.alpha = clutter_actor_get_paint_opacity_internal (actor)
+      bg_color.alpha = paint_opacity
                      * priv->bg_color.alpha
                      / 255;
 
       node = clutter_color_node_new (&bg_color);
       clutter_paint_node_set_static_name (node, "backgroundColor");
-      clutter_paint_node_add_rectangle (node, &box);
+      clutter_paint_node_add_rectangle (node, box);
       clutter_paint_node_add_child (root, node);
       clutter_paint_node_unref (node);
     }
 
   if (priv->content != NULL)
     _clutter_content_paint_content (priv->content, actor, root, paint_context);
+}
+
+static gboolean
+clutter_actor_paint_node (ClutterActor        *actor,
+                          ClutterPaintNode    *root,
+                          ClutterPaintContext *paint_context)
+{
+  ClutterActorPrivate *priv = actor->priv;
+  ClutterActorBox box;
+  guint8 paint_opacity;
 
+  box.x1 = 0.f;
+  box.y1 = 0.f;
+  box.x2 = clutter_actor_box_get_width (&priv->allocation);
+  box.y2 = clutter_actor_box_get_height (&priv->allocation);
+
+  paint_opacity = clutter_actor_get_paint_opacity_internal (actor);
+
+  /* The background and content nodes only record drawing operations
+   * relative to the actor, so the ones built by a previous paint can be
+   * replayed as long as nothing queued a redraw on the actor in between.
+   */
+  if (!clutter_actor_add_retained_paint_nodes (actor, root,
+                                               &box, paint_opacity))
+    {
+      clutter_actor_build_paint_nodes (actor, root,
+                                       &box, paint_opacity,
+                                       paint_context);
+
+      if (clutter_actor_can_retain_paint_nodes (actor))
+        clutter_actor_retain_paint_nodes (actor, root, &box, paint_opacity);
+    }
+
+  /* Subclasses may draw from any state in paint_node(), so it is asked for
+   * fresh nodes on every paint.
+   */
   if (CLUTTER_ACTOR_GET_CLASS (actor)->paint_node != NULL)
     CLUTTER_ACTOR_GET_CLASS (actor)->paint_node (actor, root);
 
@@ -5585,6 +5868,7 @@ clutter_actor_dispose (GObject *object)
     }
 
   g_clear_pointer (&priv->stage_views, g_list_free);
+  g_clear_pointer (&priv->retained_paint_nodes, g_ptr_array_unref);
 
   G_OBJECT_CLASS (clutter_actor_parent_class)->dispose (object);
 }
@@ -7803,6 +8087,8 @@ _clutter_actor_queue_redraw_full (ClutterActor             *self,
   ClutterActorPrivate *priv = self->priv;
   ClutterActor *stage;
 
+  g_clear_pointer (&priv->retained_paint_nodes, g_ptr_array_unref);
+
   /* Here's an outline of the actor queue redraw mechanism:
    *
    * The process starts in clutter_actor_queue_redraw() which is a
@@ -8955,6 +9241,8 @@ clutter_actor_allocate_internal (ClutterActor           *self,
   klass = CLUTTER_ACTOR_GET_CLASS (self);
   klass->allocate (self, allocation);
 
+  allocation_counter++;
+
   CLUTTER_UNSET_PRIVATE_FLAGS (self, CLUTTER_IN_RELAYOUT);
 
   /* Caller should call clutter_actor_queue_redraw() if needed
@@ -10406,15 +10694,15 @@ clutter_actor_set_opacity_internal (ClutterActor *self,
     {
       priv->opacity = opacity;
 
-      /* Queue a redraw from the flatten effect so that it can use
-         its cached image if available instead of having to redraw the
-         actual actor. If it doesn't end up using the FBO then the
-         effect is still able to continue the paint anyway. If there
-         is no flatten effect yet then this is equivalent to queueing
-         a full redraw */
+      /* Queue a redraw from the flatten effect, or the outermost
+         offscreen effect, so that it can use its cached image if
+         available instead of having to redraw the actual actor. If it
+         doesn't end up using the FBO then the effect is still able to
+         continue the paint anyway. If there is no such effect yet then
+         this is equivalent to queueing a full redraw */
       _clutter_actor_queue_redraw_full (self,
                                         NULL, /* clip */
-                                        priv->flatten_effect);
+                                        get_opacity_redraw_effect (self));
 
       g_object_notify_by_pspec (G_OBJECT (self), obj_props[PROP_OPACITY]);
     }
@@ -13037,17 +13325,19 @@ clutter_actor_set_animatable_property (ClutterActor *actor,
 static void
 clutter_actor_update_pointer (ClutterActor *self)
 {
-  ClutterInputDevice *pointer;
   ClutterStage *stage;
-  ClutterSeat *seat;
 
   stage = CLUTTER_STAGE (_clutter_actor_get_stage_internal (self));
   if (!stage)
     return;
 
-  seat = clutter_backend_get_default_seat (clutter_get_default_backend ());
-  pointer = clutter_seat_get_pointer (seat);
-  clutter_stage_repick_device (stage, pointer);
+  /* Transitions update their actors once per frame, from the frame clock,
+   * so instead of repicking for every animated property of every actor,
+   * let the stage update the devices once, after the layout of the frame
+   * being dispatched. Queueing the update also schedules a frame, in case
+   * the property change didn't queue a redraw or a relayout.
+   */
+  clutter_stage_queue_devices_update (stage);
 }
 
 static void
@@ -13105,6 +13395,52 @@ clutter_actor_set_final_state (ClutterAnimatable *animatable,
   g_free (p_name);
 }
 
+/*
+ * clutter_actor_find_animated_property:
+ * @self: a #ClutterActor
+ * @property_name: the name of an animated property
+ *
+ * Looks up @property_name the way clutter_actor_set_final_state() would,
+ * but only succeeds for plain animatable properties of #ClutterActor, for
+ * actors using the default #ClutterAnimatable implementation. The returned
+ * #GParamSpec can be passed to clutter_actor_set_animated_property() to
+ * skip the property name parsing on every frame of a transition.
+ *
+ * Returns: (transfer none) (nullable): the #GParamSpec, or %NULL
+ */
+GParamSpec *
+clutter_actor_find_animated_property (ClutterActor *self,
+                                      const char   *property_name)
+{
+  ClutterAnimatableInterface *iface = CLUTTER_ANIMATABLE_GET_IFACE (self);
+  GParamSpec *pspec;
+
+  if (iface->set_final_state != clutter_actor_set_final_state ||
+      iface->interpolate_value != NULL)
+    return NULL;
+
+  if (property_name[0] == '@')
+    return NULL;
+
+  pspec = g_object_class_find_property (G_OBJECT_GET_CLASS (self),
+                                        property_name);
+  if (!pspec ||
+      pspec->owner_type != CLUTTER_TYPE_ACTOR ||
+      (pspec->flags & CLUTTER_PARAM_ANIMATABLE) == 0)
+    return NULL;
+
+  return pspec;
+}
+
+void
+clutter_actor_set_animated_property (ClutterActor *self,
+                                     GParamSpec   *pspec,
+                                     const GValue *value)
+{
+  clutter_actor_set_animatable_property (self, pspec->param_id, value, pspec);
+  clutter_actor_update_pointer (self);
+}
+
 static ClutterActor *
 clutter_actor_get_actor (ClutterAnimatable *animatable)
 {
@@ -35,6 +35,12 @@ CoglTexture * clutter_blur_get_texture (ClutterBlur *blur);
 
 void clutter_blur_free (ClutterBlur *blur);
 
+CoglFramebuffer * clutter_blur_acquire_framebuffer (int      width,
+                                                    int      height,
+                                                    GError **error);
+
+void clutter_blur_release_framebuffer (CoglFramebuffer *framebuffer);
+
 G_END_DECLS
 
 #endif /* CLUTTER_BLUR_PRIVATE_H */
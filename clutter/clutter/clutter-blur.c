@@ -42,10 +42,25 @@
  * happens in factors of 2 (the image is downscaled either by 2, 4, 8, 16, …)
  * and depends on the blur radius, the texture size, among others.
  *
- * The texture is drawn into a downscaled framebuffer; the blur passes are
- * applied on the downscaled texture contents; and finally, the blurred
- * contents are drawn
- * upscaled again.
+ * The texture is halved repeatedly through a chain of framebuffers, each
+ * level averaging 2x2 texels of the previous one with a single bilinear
+ * sample; the blur passes are applied on the smallest level; and finally,
+ * the blurred contents are drawn upscaled again. Halving one level at a
+ * time keeps texture reads local, and avoids the aliasing of sampling the
+ * full size texture directly at large downscale factors.
+ *
+ * ## Framebuffer pooling
+ *
+ * Blurs are usually created for every frame that is painted. The
+ * framebuffers used by the downscale chain and the blur passes, as well as
+ * the layer of blur nodes, are returned to a pool when they are released,
+ * and reused by the next blur of the same size in a later frame.
+ *
+ * Drawing that samples a released framebuffer may still be batched in the
+ * journal of another framebuffer, so released framebuffers only become
+ * available again from an idle callback, once the frame has been
+ * submitted. The pool is bounded in size, and framebuffers that have not
+ * been reused for a while, e.g. because the stage was resized, are freed.
  *
  * ## Hardware Interpolation
  *
@@ -108,6 +123,9 @@ static const char *gaussian_blur_glsl =
 #define MIN_DOWNSCALE_SIZE 256.f
 #define MAX_SIGMA 6.f
 
+#define MAX_POOLED_FRAMEBUFFER_BYTES (64 * 1024 * 1024) /* 64MB */
+#define POOLED_FRAMEBUFFER_EXPIRE_S 1
+
 enum
 {
   VERTICAL,
@@ -122,15 +140,237 @@ typedef struct
   int orientation;
 } BlurPass;
 
+typedef struct
+{
+  CoglFramebuffer *framebuffer;
+  CoglPipeline *pipeline;
+  CoglTexture *texture;
+} DownscaleLevel;
+
 struct _ClutterBlur
 {
   CoglTexture *source_texture;
   float sigma;
   float downscale_factor;
 
+  GArray *downscale_levels;
   BlurPass pass[2];
 };
 
+typedef struct
+{
+  CoglFramebuffer *framebuffer;
+  int64_t release_time_us;
+} PooledFramebuffer;
+
+typedef struct
+{
+  /* PooledFramebuffer, most recently released first */
+  GQueue framebuffers;
+  size_t n_bytes;
+
+  /* CoglFramebuffer released in the current frame */
+  GList *pending;
+
+  unsigned int recycle_id;
+  unsigned int expire_id;
+} FramebufferPool;
+
+static CoglUserDataKey framebuffer_pool_key;
+
+static size_t
+get_framebuffer_bytes (CoglFramebuffer *framebuffer)
+{
+  return (size_t) cogl_framebuffer_get_width (framebuffer) *
+         cogl_framebuffer_get_height (framebuffer) * 4;
+}
+
+static void
+pooled_framebuffer_free (PooledFramebuffer *pooled)
+{
+  g_object_unref (pooled->framebuffer);
+  g_free (pooled);
+}
+
+static void
+free_framebuffer_pool (FramebufferPool *pool)
+{
+  g_clear_handle_id (&pool->recycle_id, g_source_remove);
+  g_clear_handle_id (&pool->expire_id, g_source_remove);
+  g_list_free_full (pool->pending, g_object_unref);
+  g_queue_clear_full (&pool->framebuffers,
+                      (GDestroyNotify) pooled_framebuffer_free);
+  g_free (pool);
+}
+
+static FramebufferPool *
+get_framebuffer_pool (CoglContext *ctx)
+{
+  FramebufferPool *pool;
+
+  pool = cogl_object_get_user_data (COGL_OBJECT (ctx), &framebuffer_pool_key);
+  if (G_UNLIKELY (pool == NULL))
+    {
+      pool = g_new0 (FramebufferPool, 1);
+      g_queue_init (&pool->framebuffers);
+      cogl_object_set_user_data (COGL_OBJECT (ctx),
+                                 &framebuffer_pool_key,
+                                 pool,
+                                 (CoglUserDataDestroyCallback) free_framebuffer_pool);
+    }
+
+  return pool;
+}
+
+static void
+drop_oldest_framebuffer (FramebufferPool *pool)
+{
+  PooledFramebuffer *pooled = g_queue_pop_tail (&pool->framebuffers);
+
+  pool->n_bytes -= get_framebuffer_bytes (pooled->framebuffer);
+  pooled_framebuffer_free (pooled);
+}
+
+static gboolean
+expire_framebuffers (gpointer user_data)
+{
+  FramebufferPool *pool = user_data;
+  int64_t expire_time_us;
+
+  expire_time_us = g_get_monotonic_time () -
+                   POOLED_FRAMEBUFFER_EXPIRE_S * G_USEC_PER_SEC;
+
+  while (!g_queue_is_empty (&pool->framebuffers))
+    {
+      PooledFramebuffer *pooled = g_queue_peek_tail (&pool->framebuffers);
+
+      if (pooled->release_time_us > expire_time_us)
+        break;
+
+      drop_oldest_framebuffer (pool);
+    }
+
+  if (!g_queue_is_empty (&pool->framebuffers))
+    return G_SOURCE_CONTINUE;
+
+  pool->expire_id = 0;
+  return G_SOURCE_REMOVE;
+}
+
+static gboolean
+recycle_framebuffers (gpointer user_data)
+{
+  FramebufferPool *pool = user_data;
+  int64_t now_us = g_get_monotonic_time ();
+  GList *l;
+
+  pool->pending = g_list_reverse (pool->pending);
+
+  for (l = pool->pending; l; l = l->next)
+    {
+      PooledFramebuffer *pooled;
+
+      pooled = g_new0 (PooledFramebuffer, 1);
+      pooled->framebuffer = l->data;
+      pooled->release_time_us = now_us;
+
+      g_queue_push_head (&pool->framebuffers, pooled);
+      pool->n_bytes += get_framebuffer_bytes (pooled->framebuffer);
+    }
+
+  g_clear_pointer (&pool->pending, g_list_free);
+
+  while (pool->n_bytes > MAX_POOLED_FRAMEBUFFER_BYTES)
+    drop_oldest_framebuffer (pool);
+
+  if (!pool->expire_id && !g_queue_is_empty (&pool->framebuffers))
+    {
+      pool->expire_id = g_timeout_add_seconds (POOLED_FRAMEBUFFER_EXPIRE_S,
+                                               expire_framebuffers,
+                                               pool);
+    }
+
+  pool->recycle_id = 0;
+  return G_SOURCE_REMOVE;
+}
+
+/**
+ * clutter_blur_acquire_framebuffer:
+ * @width: width of the framebuffer
+ * @height: height of the framebuffer
+ * @error: return location for a #GError
+ *
+ * Retrieves an allocated framebuffer of the given size from the blur
+ * framebuffer pool, or creates a new one. Its contents are undefined.
+ *
+ * Returns: (transfer full) (nullable): a #CoglFramebuffer
+ */
+CoglFramebuffer *
+clutter_blur_acquire_framebuffer (int      width,
+                                  int      height,
+                                  GError **error)
+{
+  CoglContext *ctx =
+    clutter_backend_get_cogl_context (clutter_get_default_backend ());
+  FramebufferPool *pool = get_framebuffer_pool (ctx);
+  g_autoptr (CoglOffscreen) offscreen = NULL;
+  CoglTexture *texture;
+  GList *l;
+
+  for (l = pool->framebuffers.head; l; l = l->next)
+    {
+      PooledFramebuffer *pooled = l->data;
+      CoglFramebuffer *framebuffer = pooled->framebuffer;
+
+      if (cogl_framebuffer_get_width (framebuffer) == width &&
+          cogl_framebuffer_get_height (framebuffer) == height)
+        {
+          g_queue_delete_link (&pool->framebuffers, l);
+          pool->n_bytes -= get_framebuffer_bytes (framebuffer);
+          g_free (pooled);
+
+          cogl_framebuffer_identity_matrix (framebuffer);
+          return framebuffer;
+        }
+    }
+
+  texture = COGL_TEXTURE (cogl_texture_2d_new_with_size (ctx, width, height));
+  offscreen = cogl_offscreen_new_with_texture (texture);
+  cogl_object_unref (texture);
+
+  if (!cogl_framebuffer_allocate (COGL_FRAMEBUFFER (offscreen), error))
+    return NULL;
+
+  return COGL_FRAMEBUFFER (g_steal_pointer (&offscreen));
+}
+
+/**
+ * clutter_blur_release_framebuffer:
+ * @framebuffer: (transfer full): a #CoglFramebuffer
+ *
+ * Returns a framebuffer acquired with clutter_blur_acquire_framebuffer()
+ * to the pool. It can be reused once the current frame has been submitted.
+ */
+void
+clutter_blur_release_framebuffer (CoglFramebuffer *framebuffer)
+{
+  CoglContext *ctx =
+    clutter_backend_get_cogl_context (clutter_get_default_backend ());
+  FramebufferPool *pool = get_framebuffer_pool (ctx);
+
+  pool->pending = g_list_prepend (pool->pending, framebuffer);
+
+  if (!pool->recycle_id)
+    pool->recycle_id = g_idle_add (recycle_framebuffers, pool);
+}
+
+static void
+clear_framebuffer (CoglFramebuffer **framebuffer)
+{
+  if (*framebuffer)
+    clutter_blur_release_framebuffer (g_steal_pointer (framebuffer));
+}
+
 static CoglPipeline*
 create_blur_pipeline (void)
 {
@@ -219,58 +459,131 @@ update_blur_uniforms (ClutterBlur *blur,
     }
 }
 
-static gboolean
-create_fbo (ClutterBlur *blur,
-            BlurPass    *pass)
+static CoglPipeline*
+create_downscale_pipeline (void)
 {
+  static CoglPipelineKey downscale_pipeline_key =
+    "clutter-blur-downscale-pipeline-private";
   CoglContext *ctx =
     clutter_backend_get_cogl_context (clutter_get_default_backend ());
-  float scaled_height;
-  float scaled_width;
-  float height;
-  float width;
+  CoglPipeline *downscale_pipeline;
 
-  g_clear_pointer (&pass->texture, cogl_object_unref);
-  g_clear_object (&pass->framebuffer);
+  downscale_pipeline =
+    cogl_context_get_named_pipeline (ctx, &downscale_pipeline_key);
 
-  width = cogl_texture_get_width (blur->source_texture);
-  height = cogl_texture_get_height (blur->source_texture);
-  scaled_width = floorf (width / blur->downscale_factor);
-  scaled_height = floorf (height / blur->downscale_factor);
+  if (G_UNLIKELY (downscale_pipeline == NULL))
+    {
+      downscale_pipeline = cogl_pipeline_new (ctx);
+      cogl_pipeline_set_layer_null_texture (downscale_pipeline, 0);
+      cogl_pipeline_set_layer_filters (downscale_pipeline,
+                                       0,
+                                       COGL_PIPELINE_FILTER_LINEAR,
+                                       COGL_PIPELINE_FILTER_LINEAR);
+      cogl_pipeline_set_layer_wrap_mode (downscale_pipeline,
+                                         0,
+                                         COGL_PIPELINE_WRAP_MODE_CLAMP_TO_EDGE);
+      cogl_pipeline_set_blend (downscale_pipeline,
+                               "RGBA = ADD (SRC_COLOR, 0)",
+                               NULL);
 
-  pass->texture = COGL_TEXTURE (cogl_texture_2d_new_with_size (ctx,
-                                                               scaled_width,
-                                                               scaled_height));
-  if (!pass->texture)
-    return FALSE;
+      cogl_context_set_named_pipeline (ctx,
+                                       &downscale_pipeline_key,
+                                       downscale_pipeline);
+    }
+
+  return cogl_pipeline_copy (downscale_pipeline);
+}
+
+static gboolean
+create_fbo (CoglFramebuffer **out_framebuffer,
+            CoglTexture     **out_texture,
+            float             width,
+            float             height)
+{
+  g_autoptr (GError) error = NULL;
+  CoglFramebuffer *framebuffer;
 
-  pass->framebuffer =
-    COGL_FRAMEBUFFER (cogl_offscreen_new_with_texture (pass->texture));
-  if (!pass->framebuffer)
+  g_clear_pointer (out_texture, cogl_object_unref);
+  clear_framebuffer (out_framebuffer);
+
+  framebuffer = clutter_blur_acquire_framebuffer (width, height, &error);
+  if (!framebuffer)
     {
-      g_warning ("%s: Unable to create an Offscreen buffer", G_STRLOC);
+      g_warning ("%s: Unable to create an Offscreen buffer: %s",
+                 G_STRLOC, error->message);
       return FALSE;
     }
 
-  cogl_framebuffer_orthographic (pass->framebuffer,
+  *out_framebuffer = framebuffer;
+  *out_texture =
+    cogl_object_ref (cogl_offscreen_get_texture (COGL_OFFSCREEN (framebuffer)));
+
+  cogl_framebuffer_orthographic (framebuffer,
                                  0.0, 0.0,
-                                 scaled_width,
-                                 scaled_height,
+                                 width,
+                                 height,
                                  0.0, 1.0);
   return TRUE;
 }
 
+static CoglTexture *
+setup_downscale_levels (ClutterBlur *blur)
+{
+  CoglTexture *texture = blur->source_texture;
+  float downscale_factor = 1.f;
+  float height;
+  float width;
+
+  width = cogl_texture_get_width (blur->source_texture);
+  height = cogl_texture_get_height (blur->source_texture);
+
+  while (downscale_factor < blur->downscale_factor)
+    {
+      DownscaleLevel *level;
+
+      downscale_factor *= 2.f;
+
+      g_array_set_size (blur->downscale_levels,
+                        blur->downscale_levels->len + 1);
+      level = &g_array_index (blur->downscale_levels,
+                              DownscaleLevel,
+                              blur->downscale_levels->len - 1);
+
+      level->pipeline = create_downscale_pipeline ();
+      cogl_pipeline_set_layer_texture (level->pipeline, 0, texture);
+
+      if (!create_fbo (&level->framebuffer,
+                       &level->texture,
+                       floorf (width / downscale_factor),
+                       floorf (height / downscale_factor)))
+        return NULL;
+
+      texture = level->texture;
+    }
+
+  return texture;
+}
+
 static gboolean
 setup_blur_pass (ClutterBlur *blur,
                  BlurPass    *pass,
                  int          orientation,
                  CoglTexture *texture)
 {
+  float height;
+  float width;
+
+  width = cogl_texture_get_width (blur->source_texture);
+  height = cogl_texture_get_height (blur->source_texture);
+
   pass->orientation = orientation;
   pass->pipeline = create_blur_pipeline ();
   cogl_pipeline_set_layer_texture (pass->pipeline, 0, texture);
 
-  if (!create_fbo (blur, pass))
+  if (!create_fbo (&pass->framebuffer,
+                   &pass->texture,
+                   floorf (width / blur->downscale_factor),
+                   floorf (height / blur->downscale_factor)))
     return FALSE;
 
   update_blur_uniforms (blur, pass);
@@ -323,12 +636,30 @@ apply_blur_pass (BlurPass *pass)
                                    cogl_texture_get_height (pass->texture));
 }
 
+static void
+apply_downscale_level (DownscaleLevel *level)
+{
+  cogl_framebuffer_draw_rectangle (level->framebuffer,
+                                   level->pipeline,
+                                   0, 0,
+                                   cogl_texture_get_width (level->texture),
+                                   cogl_texture_get_height (level->texture));
+}
+
 static void
 clear_blur_pass (BlurPass *pass)
 {
   g_clear_pointer (&pass->pipeline, cogl_object_unref);
   g_clear_pointer (&pass->texture, cogl_object_unref);
-  g_clear_object (&pass->framebuffer);
+  clear_framebuffer (&pass->framebuffer);
+}
+
+static void
+clear_downscale_level (DownscaleLevel *level)
+{
+  g_clear_pointer (&level->pipeline, cogl_object_unref);
+  g_clear_pointer (&level->texture, cogl_object_unref);
+  clear_framebuffer (&level->framebuffer);
 }
 
 /**
@@ -344,6 +675,7 @@ ClutterBlur *
 clutter_blur_new (CoglTexture *texture,
                   float        sigma)
 {
+  CoglTexture *downscaled_texture;
   ClutterBlur *blur;
   unsigned int height;
   unsigned int width;
@@ -360,6 +692,9 @@ clutter_blur_new (CoglTexture *texture,
   blur->sigma = sigma;
   blur->source_texture = cogl_object_ref (texture);
   blur->downscale_factor = calculate_downscale_factor (width, height, sigma);
+  blur->downscale_levels = g_array_new (FALSE, TRUE, sizeof (DownscaleLevel));
+  g_array_set_clear_func (blur->downscale_levels,
+                          (GDestroyNotify) clear_downscale_level);
 
   if (G_APPROX_VALUE (sigma, 0.0, FLT_EPSILON))
     goto out;
@@ -367,7 +702,9 @@ clutter_blur_new (CoglTexture *texture,
   vpass = &blur->pass[VERTICAL];
   hpass = &blur->pass[HORIZONTAL];
 
-  if (!setup_blur_pass (blur, vpass, VERTICAL, texture) ||
+  downscaled_texture = setup_downscale_levels (blur);
+  if (!downscaled_texture ||
+      !setup_blur_pass (blur, vpass, VERTICAL, downscaled_texture) ||
       !setup_blur_pass (blur, hpass, HORIZONTAL, vpass->texture))
     {
       clutter_blur_free (blur);
@@ -388,9 +725,18 @@ out:
 void
 clutter_blur_apply (ClutterBlur *blur)
 {
+  unsigned int i;
+
   if (G_APPROX_VALUE (blur->sigma, 0.0, FLT_EPSILON))
     return;
 
+  for (i = 0; i < blur->downscale_levels->len; i++)
+    {
+      apply_downscale_level (&g_array_index (blur->downscale_levels,
+                                             DownscaleLevel,
+                                             i));
+    }
+
   apply_blur_pass (&blur->pass[VERTICAL]);
   apply_blur_pass (&blur->pass[HORIZONTAL]);
 }
@@ -426,6 +772,7 @@ clutter_blur_free (ClutterBlur *blur)
 
   clear_blur_pass (&blur->pass[VERTICAL]);
   clear_blur_pass (&blur->pass[HORIZONTAL]);
+  g_clear_pointer (&blur->downscale_levels, g_array_unref);
   cogl_clear_object (&blur->source_texture);
   g_free (blur);
 }
@@ -38,6 +38,13 @@ CLUTTER_EXPORT
 void            _clutter_event_push                     (const ClutterEvent *event,
                                                          gboolean            do_copy);
 
+CLUTTER_EXPORT
+void            _clutter_event_merge_relative_motion    (ClutterEvent       *event,
+                                                         const ClutterEvent *earlier_event);
+
+CLUTTER_EXPORT
+void            _clutter_event_push_batch               (GPtrArray          *events);
+
 G_END_DECLS
 
 #endif /* __CLUTTER_EVENT_PRIVATE_H__ */
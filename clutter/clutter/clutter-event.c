@@ -33,6 +33,8 @@
 
 #include <math.h>
 
+#define MAX_MOTION_HISTORY_ENTRIES 256
+
 typedef struct _ClutterEventPrivate {
   ClutterEvent base;
 
@@ -44,6 +46,9 @@ typedef struct _ClutterEventPrivate {
 
   ClutterInputDeviceTool *tool;
 
+  /* ClutterMotionHistoryEntry of compressed motion events */
+  GArray *motion_history;
+
   gpointer platform_data;
 
   ClutterModifierType button_state;
@@ -1222,6 +1227,9 @@ clutter_event_copy (const ClutterEvent *event)
   new_real_event->locked_state = real_event->locked_state;
   new_real_event->tool = real_event->tool;
 
+  if (real_event->motion_history)
+    new_real_event->motion_history = g_array_copy (real_event->motion_history);
+
   switch (event->type)
     {
     case CLUTTER_BUTTON_PRESS:
@@ -1295,6 +1303,7 @@ clutter_event_free (ClutterEvent *event)
 
       g_clear_object (&real_event->device);
       g_clear_object (&real_event->source_device);
+      g_clear_pointer (&real_event->motion_history, g_array_unref);
 
       switch (event->type)
         {
@@ -1370,6 +1379,38 @@ _clutter_event_push (const ClutterEvent *event,
   g_main_context_wakeup (NULL);
 }
 
+/*
+ * _clutter_event_push_batch:
+ * @events: (element-type ClutterEvent): events to queue, in order
+ *
+ * Pushes all events in @events onto the event queue, transferring their
+ * ownership, and wakes up the main context once for the whole batch, unless
+ * called from it.
+ * @events is left empty.
+ */
+void
+_clutter_event_push_batch (GPtrArray *events)
+{
+  ClutterMainContext *context = _clutter_context_get_default ();
+  unsigned int i;
+
+  g_assert (context != NULL);
+
+  if (events->len == 0)
+    return;
+
+  g_async_queue_lock (context->events_queue);
+  for (i = 0; i < events->len; i++)
+    g_async_queue_push_unlocked (context->events_queue, events->pdata[i]);
+  g_async_queue_unlock (context->events_queue);
+
+  g_ptr_array_set_size (events, 0);
+
+  /* Only wake up the main context if it's not the one pushing */
+  if (!g_main_context_is_owner (NULL))
+    g_main_context_wakeup (NULL);
+}
+
 /**
  * clutter_event_put:
  * @event: a #ClutterEvent
@@ -2112,3 +2153,118 @@ clutter_event_get_relative_motion (const ClutterEvent *event,
   else
     return FALSE;
 }
+
+/**
+ * clutter_event_get_motion_history:
+ * @event: a #ClutterEvent of type %CLUTTER_MOTION
+ * @n_entries: (out): return location for the number of entries
+ *
+ * Retrieves the relative motion samples that were compressed into @event,
+ * oldest first, including the one of @event itself. Their deltas add up to
+ * the relative motion of @event.
+ *
+ * Returns: (array length=n_entries) (nullable): the motion samples, or
+ *   %NULL if @event is not the result of compressing motion events
+ */
+const ClutterMotionHistoryEntry *
+clutter_event_get_motion_history (const ClutterEvent *event,
+                                  unsigned int       *n_entries)
+{
+  const ClutterEventPrivate *real_event = (const ClutterEventPrivate *) event;
+
+  if (event->type != CLUTTER_MOTION || !real_event->motion_history)
+    {
+      *n_entries = 0;
+      return NULL;
+    }
+
+  *n_entries = real_event->motion_history->len;
+  return (const ClutterMotionHistoryEntry *) real_event->motion_history->data;
+}
+
+static void
+append_motion_samples (GArray             *motion_history,
+                       const ClutterEvent *event)
+{
+  const ClutterEventPrivate *real_event = (const ClutterEventPrivate *) event;
+  ClutterMotionHistoryEntry entry;
+
+  if (real_event->motion_history)
+    {
+      g_array_append_vals (motion_history,
+                           real_event->motion_history->data,
+                           real_event->motion_history->len);
+      return;
+    }
+
+  if (!clutter_event_get_relative_motion (event,
+                                          &entry.dx, &entry.dy,
+                                          &entry.dx_unaccel, &entry.dy_unaccel))
+    return;
+
+  entry.time_us = clutter_event_get_time_us (event);
+  if (entry.time_us == 0)
+    entry.time_us = clutter_event_get_time (event) * 1000LL;
+
+  g_array_append_val (motion_history, entry);
+}
+
+/*< private >
+ * _clutter_event_merge_relative_motion:
+ * @event: a #ClutterEvent of type %CLUTTER_MOTION
+ * @earlier_event: a #ClutterEvent of type %CLUTTER_MOTION preceding @event
+ *
+ * Folds the relative motion of @earlier_event into @event, which replaces
+ * it. The deltas of both add up, and the individual samples are kept as the
+ * motion history of @event.
+ */
+void
+_clutter_event_merge_relative_motion (ClutterEvent       *event,
+                                      const ClutterEvent *earlier_event)
+{
+  ClutterEventPrivate *real_event = (ClutterEventPrivate *) event;
+  GArray *motion_history;
+  double dx, dy, dx_unaccel, dy_unaccel;
+  double dst_dx = 0.0, dst_dy = 0.0;
+  double dst_dx_unaccel = 0.0, dst_dy_unaccel = 0.0;
+
+  if (!clutter_event_get_relative_motion (earlier_event,
+                                          &dx, &dy,
+                                          &dx_unaccel, &dy_unaccel))
+    return;
+
+  clutter_event_get_relative_motion (event,
+                                     &dst_dx, &dst_dy,
+                                     &dst_dx_unaccel, &dst_dy_unaccel);
+
+  motion_history = g_array_new (FALSE, FALSE,
+                                sizeof (ClutterMotionHistoryEntry));
+  append_motion_samples (motion_history, earlier_event);
+  append_motion_samples (motion_history, event);
+
+  /* Fold the oldest samples together rather than growing without bounds
+   * while events are not being dispatched, keeping the total motion.
+   */
+  while (motion_history->len > MAX_MOTION_HISTORY_ENTRIES)
+    {
+      ClutterMotionHistoryEntry *oldest =
+        &g_array_index (motion_history, ClutterMotionHistoryEntry, 0);
+      ClutterMotionHistoryEntry *next =
+        &g_array_index (motion_history, ClutterMotionHistoryEntry, 1);
+
+      next->dx += oldest->dx;
+      next->dy += oldest->dy;
+      next->dx_unaccel += oldest->dx_unaccel;
+      next->dy_unaccel += oldest->dy_unaccel;
+      g_array_remove_index (motion_history, 0);
+    }
+
+  g_clear_pointer (&real_event->motion_history, g_array_unref);
+  real_event->motion_history = motion_history;
+
+  event->motion.flags |= CLUTTER_EVENT_FLAG_RELATIVE_MOTION;
+  event->motion.dx = dx + dst_dx;
+  event->motion.dy = dy + dst_dy;
+  event->motion.dx_unaccel = dx_unaccel + dst_dx_unaccel;
+  event->motion.dy_unaccel = dy_unaccel + dst_dy_unaccel;
+}
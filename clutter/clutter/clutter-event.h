@@ -282,6 +282,25 @@ struct _ClutterMotionEvent
   double dy_unaccel;
 };
 
+/**
+ * ClutterMotionHistoryEntry:
+ * @time_us: time of the motion sample, in microseconds
+ * @dx: accelerated relative motion on the X axis
+ * @dy: accelerated relative motion on the Y axis
+ * @dx_unaccel: unaccelerated relative motion on the X axis
+ * @dy_unaccel: unaccelerated relative motion on the Y axis
+ *
+ * A relative motion sample folded into a compressed motion event.
+ */
+typedef struct _ClutterMotionHistoryEntry
+{
+  int64_t time_us;
+  double dx;
+  double dy;
+  double dx_unaccel;
+  double dy_unaccel;
+} ClutterMotionHistoryEntry;
+
 /**
  * ClutterScrollEvent:
  * @type: event type
@@ -812,6 +831,9 @@ gboolean                 clutter_event_get_relative_motion (const ClutterEvent *
                                                             double             *dy,
                                                             double             *dx_unaccel,
                                                             double             *dy_unaccel);
+CLUTTER_EXPORT
+const ClutterMotionHistoryEntry * clutter_event_get_motion_history (const ClutterEvent *event,
+                                                                    unsigned int       *n_entries);
 
 
 G_END_DECLS
@@ -34,18 +34,34 @@ enum
 
 static guint signals[N_SIGNALS];
 
-/* An estimate queue holds several int64_t values. Adding a new value to the
- * queue overwrites the oldest value.
+/* An estimate histogram holds the last ESTIMATE_WINDOW_LENGTH int64_t values,
+ * together with a histogram of them in buckets of ESTIMATE_BUCKET_WIDTH_US.
+ * Adding a new value overwrites the oldest value. Estimates are based on a
+ * high percentile of the window rather than its maximum, so that a single
+ * slow frame doesn't delay the dispatch of all the frames following it.
  */
-#define ESTIMATE_QUEUE_LENGTH 16
+#define ESTIMATE_WINDOW_LENGTH 64
+#define ESTIMATE_BUCKET_WIDTH_US 50
+#define ESTIMATE_N_BUCKETS 512
+#define ESTIMATE_PERCENTILE 95
 
-typedef struct _EstimateQueue
+typedef struct _EstimateHistogram
 {
-  int64_t values[ESTIMATE_QUEUE_LENGTH];
+  int64_t values[ESTIMATE_WINDOW_LENGTH];
   int next_index;
-} EstimateQueue;
+  int n_values;
 
-static gboolean triple_buffering_disabled = FALSE;
+  uint8_t buckets[ESTIMATE_N_BUCKETS];
+} EstimateHistogram;
+
+typedef enum _TripleBufferingMode
+{
+  TRIPLE_BUFFERING_MODE_NEVER,
+  TRIPLE_BUFFERING_MODE_AUTO,
+  TRIPLE_BUFFERING_MODE_ALWAYS,
+} TripleBufferingMode;
+
+static TripleBufferingMode triple_buffering_mode = TRIPLE_BUFFERING_MODE_AUTO;
 
 #define SYNC_DELAY_FALLBACK_FRACTION 0.875
 
@@ -101,12 +117,12 @@ struct _ClutterFrameClock
 
   ClutterFrameHint last_flip_hints;
 
-  /* Last few durations between dispatch start and buffer swap. */
-  EstimateQueue dispatch_to_swap_us;
-  /* Last few durations between buffer swap and GPU rendering finish. */
-  EstimateQueue swap_to_rendering_done_us;
-  /* Last few durations between buffer swap and KMS submission. */
-  EstimateQueue swap_to_flip_us;
+  /* Last durations between dispatch start and buffer swap. */
+  EstimateHistogram dispatch_to_swap_us;
+  /* Last durations between buffer swap and GPU rendering finish. */
+  EstimateHistogram swap_to_rendering_done_us;
+  /* Last durations between buffer swap and KMS submission. */
+  EstimateHistogram swap_to_flip_us;
   /* If we got new measurements last frame. */
   gboolean got_measurements_last_frame;
 
@@ -121,12 +137,85 @@ struct _ClutterFrameClock
 G_DEFINE_TYPE (ClutterFrameClock, clutter_frame_clock,
                G_TYPE_OBJECT)
 
+static int
+estimate_histogram_get_bucket (int64_t value)
+{
+  return CLAMP (value / ESTIMATE_BUCKET_WIDTH_US, 0, ESTIMATE_N_BUCKETS - 1);
+}
+
 static void
-estimate_queue_add_value (EstimateQueue *queue,
-                          int64_t        value)
+estimate_histogram_add_value (EstimateHistogram *histogram,
+                              int64_t            value)
+{
+  int index = histogram->next_index;
+
+  if (histogram->n_values == ESTIMATE_WINDOW_LENGTH)
+    histogram->buckets[estimate_histogram_get_bucket (histogram->values[index])]--;
+  else
+    histogram->n_values++;
+
+  histogram->values[index] = value;
+  histogram->buckets[estimate_histogram_get_bucket (value)]++;
+  histogram->next_index = (index + 1) % ESTIMATE_WINDOW_LENGTH;
+}
+
+static int64_t
+estimate_histogram_get_max (EstimateHistogram *histogram)
+{
+  int64_t max_value = 0;
+  int i;
+
+  for (i = 0; i < histogram->n_values; i++)
+    max_value = MAX (max_value, histogram->values[i]);
+
+  return max_value;
+}
+
+static int64_t
+estimate_histogram_get_percentile (EstimateHistogram *histogram,
+                                   int                percentile)
 {
-  queue->values[queue->next_index] = value;
-  queue->next_index = (queue->next_index + 1) % ESTIMATE_QUEUE_LENGTH;
+  int n_values_needed;
+  int n_values = 0;
+  int i;
+
+  n_values_needed = (histogram->n_values * percentile + 99) / 100;
+  if (n_values_needed == 0)
+    return 0;
+
+  for (i = 0; i < ESTIMATE_N_BUCKETS - 1; i++)
+    {
+      n_values += histogram->buckets[i];
+      if (n_values >= n_values_needed)
+        return (i + 1) * ESTIMATE_BUCKET_WIDTH_US;
+    }
+
+  /* The last bucket is unbounded. */
+  return estimate_histogram_get_max (histogram);
+}
+
+static int64_t
+estimate_histogram_get_last (EstimateHistogram *histogram)
+{
+  int index;
+
+  if (histogram->n_values == 0)
+    return 0;
+
+  index = (histogram->next_index + ESTIMATE_WINDOW_LENGTH - 1) %
+          ESTIMATE_WINDOW_LENGTH;
+  return histogram->values[index];
+}
+
+/* Predicts the value for the next frame. The workload of consecutive frames
+ * tends to be similar, so if the last frame was heavier than usual, expect the
+ * next one to be just as heavy; otherwise go with the usual worst case. */
+static int64_t
+estimate_histogram_predict (EstimateHistogram *histogram)
+{
+  return MAX (estimate_histogram_get_percentile (histogram,
+                                                 ESTIMATE_PERCENTILE),
+              estimate_histogram_get_last (histogram));
 }
 
 float
@@ -307,12 +396,12 @@ clutter_frame_clock_notify_presented (ClutterFrameClock *frame_clock,
                     swap_to_rendering_done_us,
                     swap_to_flip_us);
 
-      estimate_queue_add_value (&frame_clock->dispatch_to_swap_us,
-                                dispatch_to_swap_us);
-      estimate_queue_add_value (&frame_clock->swap_to_rendering_done_us,
-                                swap_to_rendering_done_us);
-      estimate_queue_add_value (&frame_clock->swap_to_flip_us,
-                                swap_to_flip_us);
+      estimate_histogram_add_value (&frame_clock->dispatch_to_swap_us,
+                                    dispatch_to_swap_us);
+      estimate_histogram_add_value (&frame_clock->swap_to_rendering_done_us,
+                                    swap_to_rendering_done_us);
+      estimate_histogram_add_value (&frame_clock->swap_to_flip_us,
+                                    swap_to_flip_us);
 
       frame_clock->got_measurements_last_frame = TRUE;
     }
@@ -385,7 +474,6 @@ clutter_frame_clock_compute_max_render_time_us (ClutterFrameClock *frame_clock)
   int64_t max_swap_to_flip_us = 0;
   int64_t max_render_time_us;
   int buffer_queue_latency_frames = 0;
-  int i;
 
   refresh_interval_us = frame_clock->refresh_interval_us;
 
@@ -395,25 +483,19 @@ clutter_frame_clock_compute_max_render_time_us (ClutterFrameClock *frame_clock)
     {
       int64_t ret = refresh_interval_us * SYNC_DELAY_FALLBACK_FRACTION;
 
-      if (!triple_buffering_disabled &&
+      if (triple_buffering_mode != TRIPLE_BUFFERING_MODE_NEVER &&
           frame_clock->state == CLUTTER_FRAME_CLOCK_STATE_DISPATCHED_ONE)
         ret += refresh_interval_us;
 
       return ret;
     }
 
-  for (i = 0; i < ESTIMATE_QUEUE_LENGTH; ++i)
-    {
-      max_dispatch_to_swap_us =
-        MAX (max_dispatch_to_swap_us,
-             frame_clock->dispatch_to_swap_us.values[i]);
-      max_swap_to_rendering_done_us =
-        MAX (max_swap_to_rendering_done_us,
-             frame_clock->swap_to_rendering_done_us.values[i]);
-      max_swap_to_flip_us =
-        MAX (max_swap_to_flip_us,
-             frame_clock->swap_to_flip_us.values[i]);
-    }
+  max_dispatch_to_swap_us =
+    estimate_histogram_predict (&frame_clock->dispatch_to_swap_us);
+  max_swap_to_rendering_done_us =
+    estimate_histogram_predict (&frame_clock->swap_to_rendering_done_us);
+  max_swap_to_flip_us =
+    estimate_histogram_predict (&frame_clock->swap_to_flip_us);
 
   switch (frame_clock->state)
     {
@@ -455,6 +537,29 @@ clutter_frame_clock_compute_max_render_time_us (ClutterFrameClock *frame_clock)
   return max_render_time_us;
 }
 
+/*
+ * Whether the next frame may be dispatched while the previous one is still
+ * waiting to be presented. In the automatic mode this is avoided after a
+ * direct scanout attempt, as scanout buffers can't be queued behind a
+ * pending flip.
+ */
+static gboolean
+want_triple_buffering (ClutterFrameClock *frame_clock)
+{
+  switch (triple_buffering_mode)
+    {
+    case TRIPLE_BUFFERING_MODE_NEVER:
+      return FALSE;
+    case TRIPLE_BUFFERING_MODE_AUTO:
+      return !(frame_clock->last_flip_hints &
+               CLUTTER_FRAME_HINT_DIRECT_SCANOUT_ATTEMPTED);
+    case TRIPLE_BUFFERING_MODE_ALWAYS:
+      return TRUE;
+    }
+
+  g_assert_not_reached ();
+}
+
 static void
 calculate_next_update_time_us (ClutterFrameClock *frame_clock,
                                int64_t           *out_next_update_time_us,
@@ -684,6 +789,13 @@ clutter_frame_clock_schedule_update_now (ClutterFrameClock *frame_clock)
     case CLUTTER_FRAME_CLOCK_STATE_DISPATCHED_ONE_AND_SCHEDULED:
       return;
     case CLUTTER_FRAME_CLOCK_STATE_DISPATCHED_ONE:
+      if (!want_triple_buffering (frame_clock))
+        {
+          frame_clock->pending_reschedule = TRUE;
+          frame_clock->pending_reschedule_now = TRUE;
+          return;
+        }
+
       next_update_time_us = g_get_monotonic_time ();
       frame_clock->state =
         CLUTTER_FRAME_CLOCK_STATE_DISPATCHED_ONE_AND_SCHEDULED;
@@ -700,6 +812,24 @@ clutter_frame_clock_schedule_update_now (ClutterFrameClock *frame_clock)
   frame_clock->is_next_presentation_time_valid = FALSE;
 }
 
+/*
+ * Moves an update that is already scheduled to now, without scheduling one
+ * if there is none. The presentation time it aims for is kept. Returns TRUE
+ * if the update will be dispatched.
+ */
+gboolean
+clutter_frame_clock_advance_scheduled_update (ClutterFrameClock *frame_clock)
+{
+  if (frame_clock->inhibit_count > 0)
+    return FALSE;
+
+  if (frame_clock->state != CLUTTER_FRAME_CLOCK_STATE_SCHEDULED)
+    return FALSE;
+
+  g_source_set_ready_time (frame_clock->source, g_get_monotonic_time ());
+  return TRUE;
+}
+
 void
 clutter_frame_clock_schedule_update (ClutterFrameClock *frame_clock)
 {
@@ -729,8 +859,7 @@ clutter_frame_clock_schedule_update (ClutterFrameClock *frame_clock)
     case CLUTTER_FRAME_CLOCK_STATE_DISPATCHED_ONE_AND_SCHEDULED:
       return;
     case CLUTTER_FRAME_CLOCK_STATE_DISPATCHED_ONE:
-      if (frame_clock->last_flip_hints & CLUTTER_FRAME_HINT_DIRECT_SCANOUT_ATTEMPTED ||
-          triple_buffering_disabled)
+      if (!want_triple_buffering (frame_clock))
         {
           /* Force double buffering, disable triple buffering */
           frame_clock->pending_reschedule = TRUE;
@@ -892,14 +1021,13 @@ clutter_frame_clock_record_flip (ClutterFrameClock *frame_clock,
 GString *
 clutter_frame_clock_get_max_render_time_debug_info (ClutterFrameClock *frame_clock)
 {
-  int64_t max_dispatch_to_swap_us = 0;
-  int64_t max_swap_to_rendering_done_us = 0;
-  int64_t max_swap_to_flip_us = 0;
-  int i;
+  int64_t predicted_dispatch_to_swap_us = 0;
+  int64_t predicted_swap_to_rendering_done_us = 0;
+  int64_t predicted_swap_to_flip_us = 0;
   GString *string;
 
   string = g_string_new (NULL);
-  g_string_append_printf (string, "Max render time: %ld µs",
+  g_string_append_printf (string, "Predicted render time: %ld µs",
                           clutter_frame_clock_compute_max_render_time_us (frame_clock));
 
   if (frame_clock->got_measurements_last_frame)
@@ -907,27 +1035,21 @@ clutter_frame_clock_get_max_render_time_debug_info (ClutterFrameClock *frame_clo
   else
     g_string_append_printf (string, " (no measurements last frame)");
 
-  for (i = 0; i < ESTIMATE_QUEUE_LENGTH; ++i)
-    {
-      max_dispatch_to_swap_us =
-        MAX (max_dispatch_to_swap_us,
-             frame_clock->dispatch_to_swap_us.values[i]);
-      max_swap_to_rendering_done_us =
-        MAX (max_swap_to_rendering_done_us,
-             frame_clock->swap_to_rendering_done_us.values[i]);
-      max_swap_to_flip_us =
-        MAX (max_swap_to_flip_us,
-             frame_clock->swap_to_flip_us.values[i]);
-    }
+  predicted_dispatch_to_swap_us =
+    estimate_histogram_predict (&frame_clock->dispatch_to_swap_us);
+  predicted_swap_to_rendering_done_us =
+    estimate_histogram_predict (&frame_clock->swap_to_rendering_done_us);
+  predicted_swap_to_flip_us =
+    estimate_histogram_predict (&frame_clock->swap_to_flip_us);
 
   g_string_append_printf (string, "\nVblank duration: %ld µs +",
                           frame_clock->vblank_duration_us);
-  g_string_append_printf (string, "\nDispatch to swap: %ld µs +",
-                          max_dispatch_to_swap_us);
-  g_string_append_printf (string, "\nmax(Swap to rendering done: %ld µs,",
-                          max_swap_to_rendering_done_us);
-  g_string_append_printf (string, "\nSwap to flip: %ld µs) +",
-                          max_swap_to_flip_us);
+  g_string_append_printf (string, "\nPredicted dispatch to swap: %ld µs +",
+                          predicted_dispatch_to_swap_us);
+  g_string_append_printf (string, "\nmax(Predicted swap to rendering done: %ld µs,",
+                          predicted_swap_to_rendering_done_us);
+  g_string_append_printf (string, "\nPredicted swap to flip: %ld µs) +",
+                          predicted_swap_to_flip_us);
   g_string_append_printf (string, "\nConstant: %d µs",
                           clutter_max_render_time_constant_us);
 
@@ -1016,9 +1138,20 @@ static void
 clutter_frame_clock_class_init (ClutterFrameClockClass *klass)
 {
   GObjectClass *object_class = G_OBJECT_CLASS (klass);
+  const char *mode_str;
+
+  mode_str = g_getenv ("MUTTER_DEBUG_TRIPLE_BUFFERING");
+  if (!g_strcmp0 (mode_str, "never"))
+    triple_buffering_mode = TRIPLE_BUFFERING_MODE_NEVER;
+  else if (!g_strcmp0 (mode_str, "auto"))
+    triple_buffering_mode = TRIPLE_BUFFERING_MODE_AUTO;
+  else if (!g_strcmp0 (mode_str, "always"))
+    triple_buffering_mode = TRIPLE_BUFFERING_MODE_ALWAYS;
+  else if (mode_str)
+    g_warning ("Unknown MUTTER_DEBUG_TRIPLE_BUFFERING mode '%s'", mode_str);
 
   if (!g_strcmp0 (g_getenv ("MUTTER_DEBUG_DISABLE_TRIPLE_BUFFERING"), "1"))
-    triple_buffering_disabled = TRUE;
+    triple_buffering_mode = TRIPLE_BUFFERING_MODE_NEVER;
 
   object_class->dispose = clutter_frame_clock_dispose;
 
@@ -81,6 +81,9 @@ void clutter_frame_clock_schedule_update (ClutterFrameClock *frame_clock);
 CLUTTER_EXPORT
 void clutter_frame_clock_schedule_update_now (ClutterFrameClock *frame_clock);
 
+CLUTTER_EXPORT
+gboolean clutter_frame_clock_advance_scheduled_update (ClutterFrameClock *frame_clock);
+
 CLUTTER_EXPORT
 void clutter_frame_clock_inhibit (ClutterFrameClock *frame_clock);
 
@@ -83,6 +83,16 @@
  *
  * In both cases, the "Pipeline" node is created with the return value
  * of [vfunc@OffscreenEffect.create_pipeline].
+ *
+ * ## Caching
+ *
+ * The contents of the offscreen buffer are only painted again when the
+ * actor or one of its children queued a redraw. Changes that only affect
+ * how the offscreen buffer is painted, like the paint opacity of the actor
+ * or the uniforms of a shader, reuse the cached contents; sub-classes
+ * should use [method@Effect.queue_repaint] for those. Sub-classes that
+ * need the actor to be painted into the offscreen buffer again without
+ * the actor itself changing can call [method@OffscreenEffect.invalidate].
  */
 
 #include "clutter-build-config.h"
@@ -122,6 +132,8 @@ struct _ClutterOffscreenEffectPrivate
   int target_width;
   int target_height;
 
+  gboolean contents_invalid;
+
   gulong purge_handler_id;
 };
 
@@ -549,10 +561,17 @@ clutter_offscreen_effect_paint (ClutterEffect           *effect,
   /* If we've already got a cached image and the actor hasn't been redrawn
    * then we can just use the cached image in the FBO.
    */
-  if (priv->offscreen == NULL || (flags & CLUTTER_EFFECT_PAINT_ACTOR_DIRTY))
-    parent_class->paint (effect, node, paint_context, flags);
+  if (priv->offscreen == NULL ||
+      priv->contents_invalid ||
+      (flags & CLUTTER_EFFECT_PAINT_ACTOR_DIRTY))
+    {
+      priv->contents_invalid = FALSE;
+      parent_class->paint (effect, node, paint_context, flags);
+    }
   else
-    clutter_offscreen_effect_paint_texture (self, node, paint_context);
+    {
+      clutter_offscreen_effect_paint_texture (self, node, paint_context);
+    }
 }
 
 static void
@@ -637,6 +656,26 @@ clutter_offscreen_effect_get_texture (ClutterOffscreenEffect *effect)
   return effect->priv->texture;
 }
 
+/**
+ * clutter_offscreen_effect_invalidate:
+ * @effect: a #ClutterOffscreenEffect
+ *
+ * Discards the cached contents of the offscreen buffer of @effect, and
+ * queues a redraw, so that the actor is painted into the offscreen buffer
+ * again the next time @effect is painted.
+ *
+ * Changes that only affect how the offscreen buffer is painted should use
+ * [method@Effect.queue_repaint] instead, which keeps the cached contents.
+ */
+void
+clutter_offscreen_effect_invalidate (ClutterOffscreenEffect *effect)
+{
+  g_return_if_fail (CLUTTER_IS_OFFSCREEN_EFFECT (effect));
+
+  effect->priv->contents_invalid = TRUE;
+  clutter_effect_queue_repaint (CLUTTER_EFFECT (effect));
+}
+
 /**
  * clutter_offscreen_effect_get_pipeline:
  * @effect: a #ClutterOffscreenEffect
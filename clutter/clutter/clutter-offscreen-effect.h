@@ -108,6 +108,9 @@ gboolean        clutter_offscreen_effect_get_target_size        (ClutterOffscree
                                                                  gfloat                 *width,
                                                                  gfloat                 *height);
 
+CLUTTER_EXPORT
+void            clutter_offscreen_effect_invalidate             (ClutterOffscreenEffect *effect);
+
 G_END_DECLS
 
 #endif /* __CLUTTER_OFFSCREEN_EFFECT_H__ */
@@ -1826,9 +1826,13 @@ static void
 clutter_blur_node_finalize (ClutterPaintNode *node)
 {
   ClutterBlurNode *blur_node = CLUTTER_BLUR_NODE (node);
+  ClutterLayerNode *layer_node = CLUTTER_LAYER_NODE (node);
 
   g_clear_pointer (&blur_node->blur, clutter_blur_free);
 
+  if (layer_node->offscreen)
+    clutter_blur_release_framebuffer (g_steal_pointer (&layer_node->offscreen));
+
   CLUTTER_PAINT_NODE_CLASS (clutter_blur_node_parent_class)->finalize (node);
 }
 
@@ -1885,12 +1889,10 @@ clutter_blur_node_new (unsigned int width,
                        unsigned int height,
                        float        sigma)
 {
-  g_autoptr (CoglOffscreen) offscreen = NULL;
+  g_autoptr (CoglFramebuffer) offscreen = NULL;
   g_autoptr (GError) error = NULL;
   ClutterLayerNode *layer_node;
   ClutterBlurNode *blur_node;
-  CoglTexture2D *tex_2d;
-  CoglContext *context;
   CoglTexture *texture;
   ClutterBlur *blur;
 
@@ -1898,32 +1900,33 @@ clutter_blur_node_new (unsigned int width,
 
   blur_node = _clutter_paint_node_create (CLUTTER_TYPE_BLUR_NODE);
   blur_node->sigma = sigma;
-  context = clutter_backend_get_cogl_context (clutter_get_default_backend ());
-  tex_2d = cogl_texture_2d_new_with_size (context, width, height);
-
-  texture = COGL_TEXTURE (tex_2d);
-  cogl_texture_set_premultiplied (texture, TRUE);
 
-  offscreen = cogl_offscreen_new_with_texture (texture);
-  cogl_object_unref (tex_2d);
-  if (!cogl_framebuffer_allocate (COGL_FRAMEBUFFER (offscreen), &error))
+  /* The layer is drawn into for every frame, take it from the blur
+   * framebuffer pool instead of allocating a new one each time.
+   */
+  offscreen = clutter_blur_acquire_framebuffer (width, height, &error);
+  if (!offscreen)
     {
       g_warning ("Unable to allocate paint node offscreen: %s",
                  error->message);
       goto out;
     }
 
+  texture = cogl_offscreen_get_texture (COGL_OFFSCREEN (offscreen));
+  cogl_texture_set_premultiplied (texture, TRUE);
+
   blur = clutter_blur_new (texture, sigma);
   blur_node->blur = blur;
 
   if (!blur)
     {
       g_warning ("Failed to create blur pipeline");
+      clutter_blur_release_framebuffer (g_steal_pointer (&offscreen));
       goto out;
     }
 
   layer_node = CLUTTER_LAYER_NODE (blur_node);
-  layer_node->offscreen = COGL_FRAMEBUFFER (g_steal_pointer (&offscreen));
+  layer_node->offscreen = g_steal_pointer (&offscreen);
   layer_node->pipeline = cogl_pipeline_copy (default_texture_pipeline);
   cogl_pipeline_set_layer_filters (layer_node->pipeline, 0,
                                    COGL_PIPELINE_FILTER_LINEAR,
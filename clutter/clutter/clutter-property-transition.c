@@ -43,6 +43,9 @@ struct _ClutterPropertyTransitionPrivate
   char *property_name;
 
   GParamSpec *pspec;
+
+  /* Set when the property can be written directly on the actor */
+  GParamSpec *actor_pspec;
 };
 
 enum
@@ -107,6 +110,13 @@ clutter_property_transition_attached (ClutterTransition *transition,
   if (priv->pspec == NULL)
     return;
 
+  if (CLUTTER_IS_ACTOR (animatable))
+    {
+      priv->actor_pspec =
+        clutter_actor_find_animated_property (CLUTTER_ACTOR (animatable),
+                                              priv->property_name);
+    }
+
   interval = clutter_transition_get_interval (transition);
   if (interval == NULL)
     return;
@@ -121,7 +131,33 @@ clutter_property_transition_detached (ClutterTransition *transition,
   ClutterPropertyTransition *self = CLUTTER_PROPERTY_TRANSITION (transition);
   ClutterPropertyTransitionPrivate *priv = self->priv;
 
-  priv->pspec = NULL; 
+  priv->pspec = NULL;
+  priv->actor_pspec = NULL;
+}
+
+static gboolean
+clutter_property_transition_compute_actor_value (ClutterPropertyTransition *self,
+                                                 ClutterActor              *actor,
+                                                 ClutterInterval           *interval,
+                                                 double                     progress)
+{
+  ClutterPropertyTransitionPrivate *priv = self->priv;
+  GValue value = G_VALUE_INIT;
+  GType value_type;
+
+  value_type = clutter_interval_get_value_type (interval);
+  if (value_type != G_PARAM_SPEC_VALUE_TYPE (priv->actor_pspec))
+    return FALSE;
+
+  /* Same as going through ClutterAnimatable, minus the lookup of the
+   * property by name and the type checks for every frame.
+   */
+  g_value_init (&value, value_type);
+  if (clutter_interval_compute_value (interval, progress, &value))
+    clutter_actor_set_animated_property (actor, priv->actor_pspec, &value);
+  g_value_unset (&value);
+
+  return TRUE;
 }
 
 static void
@@ -142,6 +178,13 @@ clutter_property_transition_compute_value (ClutterTransition *transition,
 
   clutter_property_transition_ensure_interval (self, animatable, interval);
 
+  if (priv->actor_pspec &&
+      clutter_property_transition_compute_actor_value (self,
+                                                       CLUTTER_ACTOR (animatable),
+                                                       interval,
+                                                       progress))
+    return;
+
   p_type = G_PARAM_SPEC_VALUE_TYPE (priv->pspec);
   i_type = clutter_interval_get_value_type (interval);
 
@@ -335,6 +378,7 @@ clutter_property_transition_set_property_name (ClutterPropertyTransition *transi
   g_free (priv->property_name);
   priv->property_name = g_strdup (property_name);
   priv->pspec = NULL;
+  priv->actor_pspec = NULL;
 
   animatable =
     clutter_transition_get_animatable (CLUTTER_TRANSITION (transition));
@@ -342,6 +386,13 @@ clutter_property_transition_set_property_name (ClutterPropertyTransition *transi
     {
       priv->pspec = clutter_animatable_find_property (animatable,
                                                       priv->property_name);
+
+      if (priv->pspec != NULL && CLUTTER_IS_ACTOR (animatable))
+        {
+          priv->actor_pspec =
+            clutter_actor_find_animated_property (CLUTTER_ACTOR (animatable),
+                                                  priv->property_name);
+        }
     }
 
   g_object_notify_by_pspec (G_OBJECT (transition),
@@ -82,6 +82,7 @@ GSList *            clutter_stage_find_updated_devices   (ClutterStage
 void                clutter_stage_update_devices         (ClutterStage          *stage,
                                                           GSList                *devices);
 void                clutter_stage_finish_layout          (ClutterStage          *stage);
+void                clutter_stage_queue_devices_update   (ClutterStage          *stage);
 
 CLUTTER_EXPORT
 void     _clutter_stage_queue_event                       (ClutterStage *stage,
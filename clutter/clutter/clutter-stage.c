@@ -645,32 +645,6 @@ _clutter_stage_has_queued_events (ClutterStage *stage)
   return priv->event_queue->length > 0;
 }
 
-static void
-clutter_stage_compress_motion (ClutterStage       *stage,
-                               ClutterEvent       *event,
-                               const ClutterEvent *to_discard)
-{
-  double dx, dy;
-  double dx_unaccel, dy_unaccel;
-  double dst_dx = 0.0, dst_dy = 0.0;
-  double dst_dx_unaccel = 0.0, dst_dy_unaccel = 0.0;
-
-  if (!clutter_event_get_relative_motion (to_discard,
-                                          &dx, &dy,
-                                          &dx_unaccel, &dy_unaccel))
-    return;
-
-  clutter_event_get_relative_motion (event,
-                                     &dst_dx, &dst_dy,
-                                     &dst_dx_unaccel, &dst_dy_unaccel);
-
-  event->motion.flags |= CLUTTER_EVENT_FLAG_RELATIVE_MOTION;
-  event->motion.dx = dx + dst_dx;
-  event->motion.dy = dy + dst_dy;
-  event->motion.dx_unaccel = dx_unaccel + dst_dx_unaccel;
-  event->motion.dy_unaccel = dy_unaccel + dst_dy_unaccel;
-}
-
 void
 _clutter_stage_process_queued_events (ClutterStage *stage)
 {
@@ -729,7 +703,7 @@ _clutter_stage_process_queued_events (ClutterStage *stage)
                             (int) event->motion.y);
 
               if (next_event->type == CLUTTER_MOTION)
-                clutter_stage_compress_motion (stage, next_event, event);
+                _clutter_event_merge_relative_motion (next_event, event);
 
               goto next_event;
             }
@@ -805,6 +779,13 @@ clutter_stage_invalidate_views_devices (ClutterStage *stage)
     }
 }
 
+void
+clutter_stage_queue_devices_update (ClutterStage *stage)
+{
+  clutter_stage_invalidate_views_devices (stage);
+  clutter_stage_schedule_update (stage);
+}
+
 void
 clutter_stage_maybe_relayout (ClutterActor *actor)
 {
@@ -813,6 +794,7 @@ clutter_stage_maybe_relayout (ClutterActor *actor)
   g_autoptr (GSList) stolen_list = NULL;
   GSList *l;
   int count = 0;
+  unsigned int n_allocated;
 
   /* No work to do? Avoid the extraneous debug log messages too. */
   if (priv->pending_relayouts == NULL)
@@ -822,6 +804,8 @@ clutter_stage_maybe_relayout (ClutterActor *actor)
 
   CLUTTER_NOTE (ACTOR, ">>> Recomputing layout");
 
+  n_allocated = clutter_actor_get_allocation_counter ();
+
   stolen_list = g_steal_pointer (&priv->pending_relayouts);
   for (l = stolen_list; l; l = l->next)
     {
@@ -829,6 +813,17 @@ clutter_stage_maybe_relayout (ClutterActor *actor)
       float x = 0.f;
       float y = 0.f;
 
+      /* Queued by a child with the actor as relayout boundary, the
+       * allocation box of the actor itself stays the same.
+       */
+      if (clutter_actor_allocate_relayout_boundary (queued_actor))
+        {
+          CLUTTER_NOTE (ACTOR, "    Relayout of boundary actor %s",
+                        _clutter_actor_get_debug_name (queued_actor));
+          count++;
+          continue;
+        }
+
       if (CLUTTER_ACTOR_IN_RELAYOUT (queued_actor))  /* avoid reentrancy */
         continue;
 
@@ -849,7 +844,21 @@ clutter_stage_maybe_relayout (ClutterActor *actor)
       count++;
     }
 
-  CLUTTER_NOTE (ACTOR, "<<< Completed recomputing layout of %d subtrees", count);
+  n_allocated = clutter_actor_get_allocation_counter () - n_allocated;
+
+  CLUTTER_NOTE (ACTOR, "<<< Completed recomputing layout of %d subtrees, "
+                "%u actors allocated", count, n_allocated);
+
+#ifdef COGL_HAS_TRACING
+  if (G_UNLIKELY (cogl_is_tracing_enabled ()))
+    {
+      g_autofree char *description = NULL;
+
+      description = g_strdup_printf ("%d subtrees, %u actors allocated",
+                                     count, n_allocated);
+      COGL_TRACE_DESCRIBE (ClutterStageRelayout, description);
+    }
+#endif
 
   if (count)
     clutter_stage_invalidate_views_devices (stage);
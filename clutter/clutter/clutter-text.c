@@ -118,6 +118,11 @@ struct _ClutterTextPrivate
   LayoutCache cached_layouts[N_CACHED_LAYOUTS];
   guint cache_age;
 
+  /* Private copy of a shared layout handed out by clutter_text_get_layout(),
+   * and the shared layout it was copied from */
+  PangoLayout *public_layout;
+  PangoLayout *public_layout_source;
+
   /* These are the attributes set by the attributes property */
   PangoAttrList *attrs;
   /* These are the attributes derived from the text when the
@@ -279,6 +284,7 @@ static void clutter_text_settings_changed_cb (ClutterText *text);
 static void buffer_connect_signals (ClutterText *self);
 static void buffer_disconnect_signals (ClutterText *self);
 static ClutterTextBuffer *get_buffer (ClutterText *self);
+static PangoLayout *clutter_text_get_current_layout (ClutterText *self);
 
 static const ClutterColor default_cursor_color    = {   0,   0,   0, 255 };
 static const ClutterColor default_selection_color = {   0,   0,   0, 255 };
@@ -733,6 +739,75 @@ clutter_text_ensure_effective_attributes (ClutterText *self)
     }
 }
 
+static PangoDirection
+clutter_text_resolve_direction (ClutterText *text,
+                                const char  *contents,
+                                gsize        contents_len)
+{
+  ClutterTextPrivate *priv = text->priv;
+  PangoDirection pango_dir;
+
+  if (priv->password_char != 0)
+    pango_dir = PANGO_DIRECTION_NEUTRAL;
+  else
+    pango_dir = _clutter_pango_find_base_dir (contents, contents_len);
+
+  if (pango_dir == PANGO_DIRECTION_NEUTRAL)
+    {
+      ClutterBackend *backend = clutter_get_default_backend ();
+      ClutterTextDirection text_dir;
+
+      if (clutter_actor_has_key_focus (CLUTTER_ACTOR (text)))
+        {
+          ClutterSeat *seat;
+          ClutterKeymap *keymap;
+
+          seat = clutter_backend_get_default_seat (backend);
+          keymap = clutter_seat_get_keymap (seat);
+          pango_dir = clutter_keymap_get_direction (keymap);
+        }
+      else
+        {
+          text_dir = clutter_actor_get_text_direction (CLUTTER_ACTOR (text));
+
+          if (text_dir == CLUTTER_TEXT_DIRECTION_RTL)
+            pango_dir = PANGO_DIRECTION_RTL;
+          else
+            pango_dir = PANGO_DIRECTION_LTR;
+       }
+    }
+
+  return pango_dir;
+}
+
+static void
+clutter_text_setup_layout (ClutterText        *text,
+                           PangoLayout        *layout,
+                           gint                width,
+                           gint                height,
+                           PangoEllipsizeMode  ellipsize)
+{
+  ClutterTextPrivate *priv = text->priv;
+
+  pango_layout_set_font_description (layout, priv->font_desc);
+
+  /* This will merge the markup attributes and the attributes
+   * property if needed */
+  clutter_text_ensure_effective_attributes (text);
+
+  if (priv->effective_attrs != NULL)
+    pango_layout_set_attributes (layout, priv->effective_attrs);
+
+  pango_layout_set_alignment (layout, priv->alignment);
+  pango_layout_set_single_paragraph_mode (layout, priv->single_line_mode);
+  pango_layout_set_justify (layout, priv->justify);
+  pango_layout_set_wrap (layout, priv->wrap_mode);
+
+  pango_layout_set_ellipsize (layout, ellipsize);
+  pango_layout_set_width (layout, width);
+  pango_layout_set_height (layout, height);
+}
+
 static PangoLayout *
 clutter_text_create_layout_no_cache (ClutterText       *text,
 				     gint               width,
@@ -745,7 +820,6 @@ clutter_text_create_layout_no_cache (ClutterText       *text,
   gsize contents_len;
 
   layout = clutter_actor_create_pango_layout (CLUTTER_ACTOR (text), NULL);
-  pango_layout_set_font_description (layout, priv->font_desc);
 
   contents = clutter_text_get_display_text (text);
   contents_len = strlen (contents);
@@ -781,62 +855,281 @@ clutter_text_create_layout_no_cache (ClutterText       *text,
     {
       PangoDirection pango_dir;
 
-      if (priv->password_char != 0)
-        pango_dir = PANGO_DIRECTION_NEUTRAL;
-      else
-        pango_dir = _clutter_pango_find_base_dir (contents, contents_len);
+      pango_dir = clutter_text_resolve_direction (text, contents, contents_len);
 
-      if (pango_dir == PANGO_DIRECTION_NEUTRAL)
-        {
-          ClutterBackend *backend = clutter_get_default_backend ();
-          ClutterTextDirection text_dir;
+      pango_context_set_base_dir (clutter_actor_get_pango_context (CLUTTER_ACTOR (text)), pango_dir);
 
-          if (clutter_actor_has_key_focus (CLUTTER_ACTOR (text)))
-            {
-              ClutterSeat *seat;
-              ClutterKeymap *keymap;
+      priv->resolved_direction = pango_dir;
 
-              seat = clutter_backend_get_default_seat (backend);
-              keymap = clutter_seat_get_keymap (seat);
-              pango_dir = clutter_keymap_get_direction (keymap);
-            }
-          else
-            {
-              text_dir = clutter_actor_get_text_direction (CLUTTER_ACTOR (text));
+      pango_layout_set_text (layout, contents, contents_len);
+    }
 
-              if (text_dir == CLUTTER_TEXT_DIRECTION_RTL)
-                pango_dir = PANGO_DIRECTION_RTL;
-              else
-                pango_dir = PANGO_DIRECTION_LTR;
-           }
-        }
+  clutter_text_setup_layout (text, layout, width, height, ellipsize);
 
-      pango_context_set_base_dir (clutter_actor_get_pango_context (CLUTTER_ACTOR (text)), pango_dir);
+  g_free (contents);
 
-      priv->resolved_direction = pango_dir;
+  return layout;
+}
 
-      pango_layout_set_text (layout, contents, contents_len);
+/* Shaped layouts shared between all the non-editable ClutterText
+ * actors, so that identical labels in different actors (like the
+ * ones in app grids or window lists) are only shaped once.
+ *
+ * The layouts are created using contexts owned by the cache, one for
+ * each base direction, as the base direction is a property of the
+ * context and the context of the actor creating a layout could change
+ * after the layout is shared. The contexts are created with the
+ * current backend settings, so the whole cache is dropped when those
+ * change.
+ */
+#define N_SHARED_LAYOUTS        256
+
+typedef struct _SharedLayoutKey
+{
+  char *text;
+  PangoFontDescription *font_desc;
+  PangoAttrList *attrs;
+  int width;
+  int height;
+  PangoEllipsizeMode ellipsize;
+  PangoAlignment alignment;
+  PangoWrapMode wrap_mode;
+  PangoDirection direction;
+  gboolean single_line_mode;
+  gboolean justify;
+} SharedLayoutKey;
+
+typedef struct _SharedLayout
+{
+  SharedLayoutKey key;
+  PangoLayout *layout;
+  GList link;
+} SharedLayout;
+
+typedef struct _SharedLayoutCache
+{
+  GHashTable *layouts;
+  GQueue lru;
+  PangoContext *contexts[PANGO_DIRECTION_NEUTRAL + 1];
+  unsigned int hits;
+  unsigned int misses;
+} SharedLayoutCache;
+
+static SharedLayoutCache *shared_layout_cache = NULL;
+
+static guint
+shared_layout_key_hash (gconstpointer data)
+{
+  const SharedLayoutKey *key = data;
+  guint hash;
+
+  hash = g_str_hash (key->text);
+  hash = hash * 31 + pango_font_description_hash (key->font_desc);
+  hash = hash * 31 + (guint) key->width;
+  hash = hash * 31 + (guint) key->height;
+  hash = hash * 31 + (guint) key->direction;
+
+  return hash;
+}
+
+static gboolean
+shared_layout_key_equal (gconstpointer a,
+                         gconstpointer b)
+{
+  const SharedLayoutKey *key_a = a;
+  const SharedLayoutKey *key_b = b;
+
+  if (key_a->width != key_b->width ||
+      key_a->height != key_b->height ||
+      key_a->ellipsize != key_b->ellipsize ||
+      key_a->alignment != key_b->alignment ||
+      key_a->wrap_mode != key_b->wrap_mode ||
+      key_a->direction != key_b->direction ||
+      key_a->single_line_mode != key_b->single_line_mode ||
+      key_a->justify != key_b->justify)
+    return FALSE;
+
+  if (strcmp (key_a->text, key_b->text) != 0)
+    return FALSE;
+
+  if (!pango_font_description_equal (key_a->font_desc, key_b->font_desc))
+    return FALSE;
+
+  if (key_a->attrs == key_b->attrs)
+    return TRUE;
+
+  if (key_a->attrs == NULL || key_b->attrs == NULL)
+    return FALSE;
+
+  return pango_attr_list_equal (key_a->attrs, key_b->attrs);
+}
+
+static void
+shared_layout_free (SharedLayout *shared)
+{
+  g_free (shared->key.text);
+  pango_font_description_free (shared->key.font_desc);
+  g_clear_pointer (&shared->key.attrs, pango_attr_list_unref);
+  g_object_unref (shared->layout);
+  g_free (shared);
+}
+
+static void
+shared_layout_cache_flush (void)
+{
+  SharedLayoutCache *cache = shared_layout_cache;
+  int i;
+
+  if (cache == NULL)
+    return;
+
+  CLUTTER_NOTE (ACTOR, "ClutterText: dropping %u shared layouts "
+                "(%u hits, %u misses)",
+                g_hash_table_size (cache->layouts),
+                cache->hits, cache->misses);
+
+  g_hash_table_remove_all (cache->layouts);
+  g_queue_init (&cache->lru);
+
+  for (i = 0; i < G_N_ELEMENTS (cache->contexts); i++)
+    g_clear_object (&cache->contexts[i]);
+}
+
+static void
+on_backend_settings_changed (ClutterBackend *backend,
+                             gpointer        user_data)
+{
+  shared_layout_cache_flush ();
+}
+
+static SharedLayoutCache *
+shared_layout_cache_get (void)
+{
+  ClutterBackend *backend;
+
+  if (G_LIKELY (shared_layout_cache != NULL))
+    return shared_layout_cache;
+
+  shared_layout_cache = g_new0 (SharedLayoutCache, 1);
+  shared_layout_cache->layouts =
+    g_hash_table_new_full (shared_layout_key_hash,
+                           shared_layout_key_equal,
+                           NULL,
+                           (GDestroyNotify) shared_layout_free);
+  g_queue_init (&shared_layout_cache->lru);
+
+  backend = clutter_get_default_backend ();
+  g_signal_connect (backend, "font-changed",
+                    G_CALLBACK (on_backend_settings_changed), NULL);
+  g_signal_connect (backend, "resolution-changed",
+                    G_CALLBACK (on_backend_settings_changed), NULL);
+
+  return shared_layout_cache;
+}
+
+static gboolean
+shared_layout_is_shared (PangoLayout *layout)
+{
+  PangoContext *context = pango_layout_get_context (layout);
+  int i;
+
+  if (shared_layout_cache == NULL)
+    return FALSE;
+
+  for (i = 0; i < G_N_ELEMENTS (shared_layout_cache->contexts); i++)
+    {
+      if (shared_layout_cache->contexts[i] == context)
+        return TRUE;
     }
 
-  /* This will merge the markup attributes and the attributes
-   * property if needed */
+  return FALSE;
+}
+
+static gboolean
+clutter_text_can_share_layouts (ClutterText *text)
+{
+  ClutterTextPrivate *priv = text->priv;
+
+  /* Editable actors have per-actor state in their layouts, and we don't
+   * want to keep the contents of password entries around
+   */
+  return !priv->editable && priv->password_char == 0;
+}
+
+static PangoLayout *
+clutter_text_create_layout_shared (ClutterText       *text,
+                                   gint               width,
+                                   gint               height,
+                                   PangoEllipsizeMode ellipsize)
+{
+  ClutterTextPrivate *priv = text->priv;
+  SharedLayoutCache *cache = shared_layout_cache_get ();
+  SharedLayoutKey key;
+  SharedLayout *shared;
+  PangoContext *context;
+  gsize contents_len;
+
   clutter_text_ensure_effective_attributes (text);
 
+  key.text = clutter_text_get_display_text (text);
+  key.font_desc = priv->font_desc;
+  key.attrs = priv->effective_attrs;
+  key.width = width;
+  key.height = height;
+  key.ellipsize = ellipsize;
+  key.alignment = priv->alignment;
+  key.wrap_mode = priv->wrap_mode;
+  key.single_line_mode = priv->single_line_mode;
+  key.justify = priv->justify;
+
+  contents_len = strlen (key.text);
+  key.direction = clutter_text_resolve_direction (text, key.text, contents_len);
+  priv->resolved_direction = key.direction;
+
+  shared = g_hash_table_lookup (cache->layouts, &key);
+  if (shared != NULL)
+    {
+      g_queue_unlink (&cache->lru, &shared->link);
+      g_queue_push_head_link (&cache->lru, &shared->link);
+      cache->hits++;
+
+      g_free (key.text);
+
+      return g_object_ref (shared->layout);
+    }
+
+  cache->misses++;
+
+  context = cache->contexts[key.direction];
+  if (context == NULL)
+    {
+      context = clutter_actor_create_pango_context (CLUTTER_ACTOR (text));
+      pango_context_set_base_dir (context, key.direction);
+      cache->contexts[key.direction] = context;
+    }
+
+  shared = g_new0 (SharedLayout, 1);
+  shared->key = key;
+  shared->key.font_desc = pango_font_description_copy (priv->font_desc);
   if (priv->effective_attrs != NULL)
-    pango_layout_set_attributes (layout, priv->effective_attrs);
+    shared->key.attrs = pango_attr_list_ref (priv->effective_attrs);
+  shared->link.data = shared;
 
-  pango_layout_set_alignment (layout, priv->alignment);
-  pango_layout_set_single_paragraph_mode (layout, priv->single_line_mode);
-  pango_layout_set_justify (layout, priv->justify);
-  pango_layout_set_wrap (layout, priv->wrap_mode);
+  shared->layout = pango_layout_new (context);
+  pango_layout_set_text (shared->layout, shared->key.text, contents_len);
+  clutter_text_setup_layout (text, shared->layout, width, height, ellipsize);
 
-  pango_layout_set_ellipsize (layout, ellipsize);
-  pango_layout_set_width (layout, width);
-  pango_layout_set_height (layout, height);
+  g_hash_table_add (cache->layouts, shared);
+  g_queue_push_head_link (&cache->lru, &shared->link);
 
-  g_free (contents);
+  while (cache->lru.length > N_SHARED_LAYOUTS)
+    {
+      GList *oldest = g_queue_pop_tail_link (&cache->lru);
 
-  return layout;
+      g_hash_table_remove (cache->layouts, oldest->data);
+    }
+
+  return g_object_ref (shared->layout);
 }
 
 static void
@@ -1116,8 +1409,12 @@ clutter_text_create_layout (ClutterText *text,
   if (oldest_cache->layout)
     g_object_unref (oldest_cache->layout);
 
-  oldest_cache->layout =
-    clutter_text_create_layout_no_cache (text, width, height, ellipsize);
+  if (clutter_text_can_share_layouts (text))
+    oldest_cache->layout =
+      clutter_text_create_layout_shared (text, width, height, ellipsize);
+  else
+    oldest_cache->layout =
+      clutter_text_create_layout_no_cache (text, width, height, ellipsize);
 
   cogl_pango_ensure_glyph_cache_for_layout (oldest_cache->layout);
 
@@ -1186,7 +1483,7 @@ clutter_text_coords_to_position (ClutterText *self,
   px = logical_pixels_to_pango (x - self->priv->text_logical_x, resource_scale);
   py = logical_pixels_to_pango (y - self->priv->text_logical_y, resource_scale);
 
-  pango_layout_xy_to_index (clutter_text_get_layout (self),
+  pango_layout_xy_to_index (clutter_text_get_current_layout (self),
                             px, py,
                             &index_, &trailing);
 
@@ -1258,7 +1555,7 @@ clutter_text_position_to_coords_internal (ClutterText *self,
       g_string_free (tmp, TRUE);
     }
 
-  pango_layout_get_cursor_pos (clutter_text_get_layout (self),
+  pango_layout_get_cursor_pos (clutter_text_get_current_layout (self),
                                index_,
                                &rect, NULL);
 
@@ -1794,6 +2091,8 @@ clutter_text_dispose (GObject *gobject)
 
   /* get rid of the entire cache */
   clutter_text_dirty_cache (self);
+  g_clear_object (&self->priv->public_layout);
+  g_clear_object (&self->priv->public_layout_source);
 
   g_clear_signal_handler (&priv->direction_changed_id, self);
   g_clear_signal_handler (&priv->settings_changed_id,
@@ -1844,7 +2143,7 @@ clutter_text_foreach_selection_rectangle (ClutterText              *self,
                                           gpointer                  user_data)
 {
   ClutterTextPrivate *priv = self->priv;
-  PangoLayout *layout = clutter_text_get_layout (self);
+  PangoLayout *layout = clutter_text_get_current_layout (self);
   gchar *utf8 = clutter_text_get_display_text (self);
   gint lines;
   gint start_index;
@@ -1943,7 +2242,7 @@ paint_selection_rectangle (ClutterText           *self,
   ClutterActor *actor = CLUTTER_ACTOR (self);
   guint8 paint_opacity = clutter_actor_get_paint_opacity (actor);
   CoglPipeline *color_pipeline = cogl_pipeline_copy (default_color_pipeline);
-  PangoLayout *layout = clutter_text_get_layout (self);
+  PangoLayout *layout = clutter_text_get_current_layout (self);
   CoglColor cogl_color = { 0, };
   const ClutterColor *color;
 
@@ -2043,7 +2342,7 @@ clutter_text_move_word_backward (ClutterText *self,
 
   if (clutter_text_buffer_get_length (get_buffer (self)) > 0 && start > 0)
     {
-      PangoLayout *layout = clutter_text_get_layout (self);
+      PangoLayout *layout = clutter_text_get_current_layout (self);
       PangoLogAttr *log_attrs = NULL;
       gint n_attrs = 0;
 
@@ -2069,7 +2368,7 @@ clutter_text_move_word_forward (ClutterText *self,
   n_chars = clutter_text_buffer_get_length (get_buffer (self));
   if (n_chars > 0 && start < n_chars)
     {
-      PangoLayout *layout = clutter_text_get_layout (self);
+      PangoLayout *layout = clutter_text_get_current_layout (self);
       PangoLogAttr *log_attrs = NULL;
       gint n_attrs = 0;
 
@@ -2096,7 +2395,7 @@ clutter_text_move_line_start (ClutterText *self,
   gint position;
   const gchar *text;
 
-  layout = clutter_text_get_layout (self);
+  layout = clutter_text_get_current_layout (self);
   text = clutter_text_buffer_get_text (get_buffer (self));
 
   if (start == 0)
@@ -2132,7 +2431,7 @@ clutter_text_move_line_end (ClutterText *self,
   gint position;
   const gchar *text;
 
-  layout = clutter_text_get_layout (self);
+  layout = clutter_text_get_current_layout (self);
   text = clutter_text_buffer_get_text (get_buffer (self));
 
   if (start == 0)
@@ -2930,7 +3229,7 @@ clutter_text_get_paint_volume (ClutterActor       *self,
 
       _clutter_paint_volume_init_static (&priv->paint_volume, self);
 
-      layout = clutter_text_get_layout (text);
+      layout = clutter_text_get_current_layout (text);
       pango_layout_get_extents (layout, &ink_rect, NULL);
 
       origin.x = pango_to_logical_pixels (ink_rect.x, resource_scale);
@@ -3305,7 +3604,7 @@ clutter_text_real_move_up (ClutterText         *self,
   gint x;
   const gchar *text;
 
-  layout = clutter_text_get_layout (self);
+  layout = clutter_text_get_current_layout (self);
   text = clutter_text_buffer_get_text (get_buffer (self));
 
   if (priv->position == 0)
@@ -3362,7 +3661,7 @@ clutter_text_real_move_down (ClutterText         *self,
   gint pos;
   const gchar *text;
 
-  layout = clutter_text_get_layout (self);
+  layout = clutter_text_get_current_layout (self);
   text = clutter_text_buffer_get_text (get_buffer (self));
 
   if (priv->position == 0)
@@ -4569,6 +4868,49 @@ clutter_text_class_init (ClutterTextClass *klass)
                                        NULL, NULL);
 }
 
+static gboolean glyph_cache_prewarm_scheduled = FALSE;
+
+/* Fills the glyph cache with the printable Latin-1 range of the default
+ * font, in regular and bold weight, so that the first labels shown
+ * don't have to rasterize them one by one and reorganize the glyph
+ * atlas while doing so.
+ */
+static gboolean
+prewarm_glyph_cache_cb (gpointer user_data)
+{
+  g_autoptr (GString) glyphs = NULL;
+  ClutterText *text;
+  PangoAttrList *attrs;
+  gunichar c;
+
+  glyphs = g_string_new (NULL);
+  for (c = 0x21; c <= 0x7e; c++)
+    g_string_append_unichar (glyphs, c);
+  for (c = 0xa1; c <= 0xff; c++)
+    g_string_append_unichar (glyphs, c);
+
+  text = CLUTTER_TEXT (clutter_text_new ());
+  g_object_ref_sink (text);
+
+  clutter_text_set_text (text, glyphs->str);
+  clutter_text_create_layout (text, -1, -1);
+
+  attrs = pango_attr_list_new ();
+  pango_attr_list_insert (attrs, pango_attr_weight_new (PANGO_WEIGHT_BOLD));
+  clutter_text_set_attributes (text, attrs);
+  pango_attr_list_unref (attrs);
+  clutter_text_create_layout (text, -1, -1);
+
+  CLUTTER_NOTE (ACTOR, "ClutterText: pre-warmed the glyph cache with %ld "
+                "characters of the default font",
+                g_utf8_strlen (glyphs->str, -1));
+
+  clutter_actor_destroy (CLUTTER_ACTOR (text));
+  g_object_unref (text);
+
+  return G_SOURCE_REMOVE;
+}
+
 static void
 clutter_text_init (ClutterText *self)
 {
@@ -4648,6 +4990,12 @@ clutter_text_init (ClutterText *self)
                       NULL);
 
   priv->input_focus = clutter_text_input_focus_new (self);
+
+  if (G_UNLIKELY (!glyph_cache_prewarm_scheduled))
+    {
+      g_idle_add_full (G_PRIORITY_LOW, prewarm_glyph_cache_cb, NULL, NULL);
+      glyph_cache_prewarm_scheduled = TRUE;
+    }
 }
 
 /**
@@ -5685,6 +6033,24 @@ clutter_text_set_markup (ClutterText *self,
     clutter_text_buffer_set_text (get_buffer (self), "", 0);
 }
 
+static PangoLayout *
+clutter_text_get_current_layout (ClutterText *self)
+{
+  PangoLayout *layout;
+  gfloat width, height;
+
+  if (self->priv->editable && self->priv->single_line_mode)
+    return clutter_text_create_layout (self, -1, -1);
+
+  clutter_actor_get_size (CLUTTER_ACTOR (self), &width, &height);
+  layout = maybe_create_text_layout_with_resource_scale (self, width, height);
+
+  if (!layout)
+    layout = clutter_text_create_layout (self, width, height);
+
+  return layout;
+}
+
 /**
  * clutter_text_get_layout:
  * @self: a #ClutterText
@@ -5697,21 +6063,28 @@ clutter_text_set_markup (ClutterText *self,
 PangoLayout *
 clutter_text_get_layout (ClutterText *self)
 {
+  ClutterTextPrivate *priv;
   PangoLayout *layout;
-  gfloat width, height;
 
   g_return_val_if_fail (CLUTTER_IS_TEXT (self), NULL);
 
-  if (self->priv->editable && self->priv->single_line_mode)
-    return clutter_text_create_layout (self, -1, -1);
+  priv = self->priv;
+  layout = clutter_text_get_current_layout (self);
 
-  clutter_actor_get_size (CLUTTER_ACTOR (self), &width, &height);
-  layout = maybe_create_text_layout_with_resource_scale (self, width, height);
+  if (!shared_layout_is_shared (layout))
+    return layout;
 
-  if (!layout)
-    layout = clutter_text_create_layout (self, width, height);
+  /* Layouts from the shared cache are also used by other actors, so
+   * callers get a copy of their own in case they modify it anyway.
+   */
+  if (priv->public_layout_source != layout)
+    {
+      g_set_object (&priv->public_layout_source, layout);
+      g_clear_object (&priv->public_layout);
+      priv->public_layout = pango_layout_copy (layout);
+    }
 
-  return layout;
+  return priv->public_layout;
 }
 
 /**
@@ -35,6 +35,16 @@
 #include "cogl/cogl-atlas.h"
 #include "cogl/cogl-atlas-texture-private.h"
 
+/* Glyphs are evicted from the cache once they haven't been looked up
+   for this many generations. The generation of the cache advances
+   whenever the atlases are reorganized (other than for compaction) or
+   glyphs are evicted, which are also points where all the display
+   lists built from the cache are thrown away. A glyph that wasn't
+   looked up since then isn't used by any display list anymore, unless
+   it belongs to a layout that is being ensured or drawn, see
+   cogl_pango_glyph_cache_pin_generation(). */
+#define GLYPH_CACHE_MAX_AGE 2
+
 typedef struct _CoglPangoGlyphCacheKey     CoglPangoGlyphCacheKey;
 
 struct _CoglPangoGlyphCache
@@ -64,6 +74,26 @@ struct _CoglPangoGlyphCache
   /* Whether mipmapping is being used for this cache. This only
      affects whether we decide to put the glyph in the global atlas */
   gboolean          use_mipmapping;
+
+  /* Set when the global atlas was reorganized, so that unused glyphs
+     get evicted before adding new ones to it */
+  gboolean          global_atlas_reorganized;
+
+  /* Incremented whenever the display lists using the cache are
+     invalidated, see GLYPH_CACHE_MAX_AGE */
+  unsigned int      generation;
+
+  /* While a layout is being ensured and drawn the generation it
+     started with is pinned, and glyphs looked up since then are never
+     evicted, as the layout may still use them */
+  unsigned int      pin_count;
+  unsigned int      pinned_generation;
+
+  /* Statistics, reported with the "pango" debug flag */
+  unsigned int      n_reorganizations;
+  unsigned int      n_evictions;
+  unsigned int      n_evicted_glyphs;
+  uint64_t          local_glyph_area;
 };
 
 struct _CoglPangoGlyphCacheKey
@@ -142,17 +172,155 @@ cogl_pango_glyph_cache_new (CoglContext *ctx,
 
   cache->use_mipmapping = use_mipmapping;
 
+  cache->global_atlas_reorganized = FALSE;
+  cache->generation = 0;
+  cache->pin_count = 0;
+  cache->pinned_generation = 0;
+
+  cache->n_reorganizations = 0;
+  cache->n_evictions = 0;
+  cache->n_evicted_glyphs = 0;
+  cache->local_glyph_area = 0;
+
   return cache;
 }
 
+static void
+cogl_pango_glyph_cache_log_stats (CoglPangoGlyphCache *cache)
+{
+  uint64_t atlas_area = 0;
+  GSList *l;
+
+  if (!COGL_DEBUG_ENABLED (COGL_DEBUG_PANGO))
+    return;
+
+  for (l = cache->atlases; l; l = l->next)
+    {
+      CoglAtlas *atlas = l->data;
+
+      if (atlas->texture)
+        atlas_area += (cogl_texture_get_width (atlas->texture) *
+                       cogl_texture_get_height (atlas->texture));
+    }
+
+  COGL_NOTE (PANGO,
+             "Glyph cache %p: %u glyphs, %u local atlases %d%% full, "
+             "%u reorganizations, %u evictions of %u glyphs",
+             cache,
+             g_hash_table_size (cache->hash_table),
+             g_slist_length (cache->atlases),
+             atlas_area ? (int) (cache->local_glyph_area * 100 / atlas_area) : 0,
+             cache->n_reorganizations,
+             cache->n_evictions,
+             cache->n_evicted_glyphs);
+}
+
 static void
 cogl_pango_glyph_cache_reorganize_cb (void *user_data)
 {
   CoglPangoGlyphCache *cache = user_data;
 
+  cache->generation++;
+  cache->n_reorganizations++;
+
+  cogl_pango_glyph_cache_log_stats (cache);
+
   g_hook_list_invoke (&cache->reorganize_callbacks, FALSE);
 }
 
+static void
+cogl_pango_glyph_cache_global_reorganize_cb (void *user_data)
+{
+  CoglPangoGlyphCache *cache = user_data;
+
+  /* Compacting the atlas moves glyphs around without dropping any, so
+     the display lists still need to be rebuilt for the new positions.
+     That doesn't make the glyphs any older though, and there is no
+     point in evicting glyphs to make room */
+  if (_cogl_atlas_texture_is_defragmenting (cache->ctx))
+    {
+      g_hook_list_invoke (&cache->reorganize_callbacks, FALSE);
+      return;
+    }
+
+  cache->global_atlas_reorganized = TRUE;
+
+  cogl_pango_glyph_cache_reorganize_cb (cache);
+}
+
+/* Removes the glyphs that weren't used for GLYPH_CACHE_MAX_AGE
+   generations, giving their space back to the atlases. Returns
+   whether any glyph was evicted */
+static gboolean
+cogl_pango_glyph_cache_evict (CoglPangoGlyphCache *cache)
+{
+  GHashTableIter iter;
+  CoglPangoGlyphCacheValue *value;
+  unsigned int n_evicted = 0;
+
+  if (cache->generation < GLYPH_CACHE_MAX_AGE)
+    return FALSE;
+
+  g_hash_table_iter_init (&iter, cache->hash_table);
+  while (g_hash_table_iter_next (&iter, NULL, (void **) &value))
+    {
+      if (value->generation + GLYPH_CACHE_MAX_AGE > cache->generation)
+        continue;
+
+      if (cache->pin_count > 0 &&
+          value->generation >= cache->pinned_generation)
+        continue;
+
+      if (value->atlas)
+        {
+          _cogl_atlas_remove (value->atlas, &value->atlas_rect);
+          cache->local_glyph_area -= (value->atlas_rect.width *
+                                      value->atlas_rect.height);
+        }
+
+      g_hash_table_iter_remove (&iter);
+      n_evicted++;
+    }
+
+  if (n_evicted == 0)
+    return FALSE;
+
+  cache->generation++;
+  cache->n_evictions++;
+  cache->n_evicted_glyphs += n_evicted;
+
+  COGL_NOTE (PANGO, "Glyph cache %p: evicted %u unused glyphs",
+             cache, n_evicted);
+  cogl_pango_glyph_cache_log_stats (cache);
+
+  /* The space of the evicted glyphs can now be reused by other glyphs
+     so the display lists have to be rebuilt */
+  g_hook_list_invoke (&cache->reorganize_callbacks, FALSE);
+
+  return TRUE;
+}
+
+void
+cogl_pango_glyph_cache_pin_generation (CoglPangoGlyphCache *cache)
+{
+  if (cache->pin_count++ == 0)
+    cache->pinned_generation = cache->generation;
+}
+
+void
+cogl_pango_glyph_cache_unpin_generation (CoglPangoGlyphCache *cache)
+{
+  g_return_if_fail (cache->pin_count > 0);
+
+  cache->pin_count--;
+}
+
+unsigned int
+cogl_pango_glyph_cache_get_generation (CoglPangoGlyphCache *cache)
+{
+  return cache->generation;
+}
+
 void
 cogl_pango_glyph_cache_clear (CoglPangoGlyphCache *cache)
 {
@@ -160,6 +328,7 @@ cogl_pango_glyph_cache_clear (CoglPangoGlyphCache *cache)
   g_slist_free (cache->atlases);
   cache->atlases = NULL;
   cache->has_dirty_glyphs = FALSE;
+  cache->local_glyph_area = 0;
 
   g_hash_table_remove_all (cache->hash_table);
 }
@@ -171,7 +340,8 @@ cogl_pango_glyph_cache_free (CoglPangoGlyphCache *cache)
     {
       _cogl_atlas_texture_remove_reorganize_callback (
                                   cache->ctx,
-                                  cogl_pango_glyph_cache_reorganize_cb, cache);
+                                  cogl_pango_glyph_cache_global_reorganize_cb,
+                                  cache);
     }
 
   cogl_pango_glyph_cache_clear (cache);
@@ -206,6 +376,8 @@ cogl_pango_glyph_cache_update_position_cb (void *user_data,
   value->tx_pixel = rect->x;
   value->ty_pixel = rect->y;
 
+  value->atlas_rect = *rect;
+
   /* The glyph has changed position so it will need to be redrawn */
   value->dirty = TRUE;
 }
@@ -252,7 +424,7 @@ cogl_pango_glyph_cache_add_to_global_atlas (CoglPangoGlyphCache *cache,
     {
       _cogl_atlas_texture_add_reorganize_callback
         (cache->ctx,
-         cogl_pango_glyph_cache_reorganize_cb, cache);
+         cogl_pango_glyph_cache_global_reorganize_cb, cache);
       cache->using_global_atlas = TRUE;
     }
 
@@ -268,17 +440,47 @@ cogl_pango_glyph_cache_add_to_local_atlas (CoglPangoGlyphCache *cache,
   CoglAtlas *atlas = NULL;
   GSList *l;
 
-  /* Look for an atlas that can reserve the space */
+  /* Look for an atlas that has space left for the glyph... */
   for (l = cache->atlases; l; l = l->next)
-    if (_cogl_atlas_reserve_space (l->data,
-                                   value->draw_width + 1,
-                                   value->draw_height + 1,
-                                   value))
+    if (_cogl_atlas_try_reserve_space (l->data,
+                                       value->draw_width + 1,
+                                       value->draw_height + 1,
+                                       value))
       {
         atlas = l->data;
         break;
       }
 
+  /* ...otherwise make some by evicting unused glyphs, which is a lot
+     cheaper than reorganizing an atlas and redrawing all of its
+     glyphs */
+  if (atlas == NULL && cache->atlases && cogl_pango_glyph_cache_evict (cache))
+    {
+      for (l = cache->atlases; l; l = l->next)
+        if (_cogl_atlas_try_reserve_space (l->data,
+                                           value->draw_width + 1,
+                                           value->draw_height + 1,
+                                           value))
+          {
+            atlas = l->data;
+            break;
+          }
+    }
+
+  /* Look for an atlas that can reserve the space by reorganizing */
+  if (atlas == NULL)
+    {
+      for (l = cache->atlases; l; l = l->next)
+        if (_cogl_atlas_reserve_space (l->data,
+                                       value->draw_width + 1,
+                                       value->draw_height + 1,
+                                       value))
+          {
+            atlas = l->data;
+            break;
+          }
+    }
+
   /* If we couldn't find one then start a new atlas */
   if (atlas == NULL)
     {
@@ -304,6 +506,9 @@ cogl_pango_glyph_cache_add_to_local_atlas (CoglPangoGlyphCache *cache,
       cache->atlases = g_slist_prepend (cache->atlases, atlas);
     }
 
+  value->atlas = atlas;
+  cache->local_glyph_area += value->atlas_rect.width * value->atlas_rect.height;
+
   return TRUE;
 }
 
@@ -326,6 +531,14 @@ cogl_pango_glyph_cache_lookup (CoglPangoGlyphCache *cache,
       CoglPangoGlyphCacheKey *key;
       PangoRectangle ink_rect;
 
+      /* Make room in the global atlas before it has to be
+         reorganized again */
+      if (cache->global_atlas_reorganized)
+        {
+          cache->global_atlas_reorganized = FALSE;
+          cogl_pango_glyph_cache_evict (cache);
+        }
+
       value = g_new0 (CoglPangoGlyphCacheValue, 1);
       value->texture = NULL;
 
@@ -369,6 +582,9 @@ cogl_pango_glyph_cache_lookup (CoglPangoGlyphCache *cache,
       g_hash_table_insert (cache->hash_table, key, value);
     }
 
+  if (value)
+    value->generation = cache->generation;
+
   return value;
 }
 
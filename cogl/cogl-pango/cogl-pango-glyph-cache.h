@@ -33,6 +33,7 @@
 #include <pango/pango-font.h>
 
 #include "cogl/cogl-texture.h"
+#include "cogl/cogl-atlas.h"
 
 G_BEGIN_DECLS
 
@@ -56,6 +57,14 @@ struct _CoglPangoGlyphCacheValue
   int draw_width;
   int draw_height;
 
+  /* The local atlas holding the glyph and its position in it, or NULL
+     if the glyph is stored in the global atlas */
+  CoglAtlas *atlas;
+  CoglRectangleMapEntry atlas_rect;
+
+  /* Generation of the cache when the glyph was last looked up */
+  unsigned int generation;
+
   /* This will be set to TRUE when the glyph atlas is reorganized
      which means the glyph will need to be redrawn */
   guint dirty : 1;
@@ -83,6 +92,15 @@ cogl_pango_glyph_cache_lookup (CoglPangoGlyphCache *cache,
 COGL_EXPORT void
 cogl_pango_glyph_cache_clear (CoglPangoGlyphCache *cache);
 
+COGL_EXPORT void
+cogl_pango_glyph_cache_pin_generation (CoglPangoGlyphCache *cache);
+
+COGL_EXPORT void
+cogl_pango_glyph_cache_unpin_generation (CoglPangoGlyphCache *cache);
+
+COGL_EXPORT unsigned int
+cogl_pango_glyph_cache_get_generation (CoglPangoGlyphCache *cache);
+
 void
 _cogl_pango_glyph_cache_add_reorganize_callback (CoglPangoGlyphCache *cache,
                                                  GHookFunc func,
@@ -413,6 +413,10 @@ cogl_pango_show_layout (CoglFramebuffer *fb,
         &priv->mipmap_caches :
         &priv->no_mipmap_caches;
 
+      /* Keep the glyphs looked up for the layout from being evicted
+         until it has been drawn into the display list */
+      cogl_pango_glyph_cache_pin_generation (caches->glyph_cache);
+
       cogl_pango_ensure_glyph_cache_for_layout (layout);
 
       qdata->display_list =
@@ -429,6 +433,8 @@ cogl_pango_show_layout (CoglFramebuffer *fb,
       pango_renderer_draw_layout (PANGO_RENDERER (priv), layout, 0, 0);
       priv->display_list = NULL;
 
+      cogl_pango_glyph_cache_unpin_generation (caches->glyph_cache);
+
       qdata->mipmapping_used = priv->use_mipmapping;
     }
 
@@ -479,11 +485,15 @@ cogl_pango_show_layout_line (CoglFramebuffer *fb,
 
   priv->display_list = _cogl_pango_display_list_new (caches->pipeline_cache);
 
+  cogl_pango_glyph_cache_pin_generation (caches->glyph_cache);
+
   _cogl_pango_ensure_glyph_cache_for_layout_line (line);
 
   pango_renderer_draw_layout_line (PANGO_RENDERER (priv), line,
                                    pango_x, pango_y);
 
+  cogl_pango_glyph_cache_unpin_generation (caches->glyph_cache);
+
   _cogl_pango_display_list_render (fb,
                                    priv->display_list,
                                    color);
@@ -687,6 +697,7 @@ cogl_pango_ensure_glyph_cache_for_layout (PangoLayout *layout)
 {
   PangoContext *context;
   CoglPangoRenderer *priv;
+  CoglPangoRendererCaches *caches;
   PangoLayoutIter *iter;
 
   context = pango_layout_get_context (layout);
@@ -697,6 +708,14 @@ cogl_pango_ensure_glyph_cache_for_layout (PangoLayout *layout)
   if ((iter = pango_layout_get_iter (layout)) == NULL)
     return;
 
+  caches = (priv->use_mipmapping ?
+            &priv->mipmap_caches :
+            &priv->no_mipmap_caches);
+
+  /* Adding glyphs for later lines may reorganize the atlases more
+     than once, which must not evict the glyphs of earlier lines */
+  cogl_pango_glyph_cache_pin_generation (caches->glyph_cache);
+
   do
     {
       PangoLayoutLine *line;
@@ -707,6 +726,8 @@ cogl_pango_ensure_glyph_cache_for_layout (PangoLayout *layout)
     }
   while (pango_layout_iter_next_line (iter));
 
+  cogl_pango_glyph_cache_unpin_generation (caches->glyph_cache);
+
   pango_layout_iter_free (iter);
 
   /* Now that we know all of the positions are settled we'll fill in
@@ -75,6 +75,19 @@ _cogl_atlas_texture_remove_reorganize_callback (CoglContext *ctx,
                                                 GHookFunc callback,
                                                 void *user_data);
 
+/* Moves a bounded number of rectangles in fragmented atlases, returns
+   how many were moved. This normally runs from an idle source queued
+   when textures are removed from the atlases */
+COGL_EXPORT unsigned int
+_cogl_atlas_texture_defragment_atlases (CoglContext *ctx);
+
+/* Whether the atlas reorganize callbacks are being invoked because of
+   rectangles moved by _cogl_atlas_texture_defragment_atlases(). The
+   textures keep their contents in that case, only their positions in
+   the atlas change */
+COGL_EXPORT gboolean
+_cogl_atlas_texture_is_defragmenting (CoglContext *ctx);
+
 gboolean
 _cogl_is_atlas_texture (void *object);
 
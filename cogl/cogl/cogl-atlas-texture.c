@@ -223,6 +223,76 @@ _cogl_atlas_texture_create_atlas (CoglContext *ctx)
   return atlas;
 }
 
+/* The number of rectangles that may be moved in one idle dispatch. Each
+   move is two small blits so this keeps a dispatch short while still
+   compacting a fragmented atlas within a few dispatches */
+#define COGL_ATLAS_TEXTURE_DEFRAGMENT_MOVES_PER_IDLE 8
+
+unsigned int
+_cogl_atlas_texture_defragment_atlases (CoglContext *ctx)
+{
+  unsigned int budget = COGL_ATLAS_TEXTURE_DEFRAGMENT_MOVES_PER_IDLE;
+  GSList *l, *next;
+
+  ctx->atlas_defragmenting = TRUE;
+
+  for (l = ctx->atlases; l && budget > 0; l = next)
+    {
+      CoglAtlas *atlas = l->data;
+
+      next = l->next;
+
+      if (!_cogl_atlas_is_fragmented (atlas))
+        continue;
+
+      /* Keep the atlas alive in case moving the textures around
+         causes the last one to be destroyed */
+      cogl_object_ref (atlas);
+      budget -= _cogl_atlas_defragment (atlas, budget);
+      cogl_object_unref (atlas);
+    }
+
+  ctx->atlas_defragmenting = FALSE;
+
+  return COGL_ATLAS_TEXTURE_DEFRAGMENT_MOVES_PER_IDLE - budget;
+}
+
+gboolean
+_cogl_atlas_texture_is_defragmenting (CoglContext *ctx)
+{
+  return ctx->atlas_defragmenting;
+}
+
+static gboolean
+_cogl_atlas_texture_defragment_idle_cb (void *user_data)
+{
+  CoglContext *ctx = user_data;
+
+  /* Keep going for as long as rectangles could be moved. An atlas
+     that can't make progress stops counting as fragmented until a
+     rectangle is removed from it, which queues this again */
+  if (_cogl_atlas_texture_defragment_atlases (ctx) > 0)
+    return G_SOURCE_CONTINUE;
+
+  ctx->atlas_defragment_idle_id = 0;
+  return G_SOURCE_REMOVE;
+}
+
+static void
+_cogl_atlas_texture_queue_defragment (CoglContext *ctx)
+{
+  if (ctx->atlas_defragment_idle_id)
+    return;
+
+  /* Compacting only needs to happen before the atlas fills up, so it
+     is done when there is nothing else to do rather than as part of
+     painting a frame */
+  ctx->atlas_defragment_idle_id =
+    g_idle_add_full (G_PRIORITY_LOW,
+                     _cogl_atlas_texture_defragment_idle_cb,
+                     ctx, NULL);
+}
+
 static void
 _cogl_atlas_texture_foreach_sub_texture_in_region (
                                        CoglTexture *tex,
@@ -266,9 +336,14 @@ _cogl_atlas_texture_remove_from_atlas (CoglAtlasTexture *atlas_tex)
 {
   if (atlas_tex->atlas)
     {
+      CoglContext *ctx = COGL_TEXTURE (atlas_tex)->context;
+
       _cogl_atlas_remove (atlas_tex->atlas,
                           &atlas_tex->rectangle);
 
+      if (_cogl_atlas_is_fragmented (atlas_tex->atlas))
+        _cogl_atlas_texture_queue_defragment (ctx);
+
       cogl_object_unref (atlas_tex->atlas);
       atlas_tex->atlas = NULL;
     }
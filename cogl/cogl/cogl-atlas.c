@@ -60,6 +60,7 @@ _cogl_atlas_new (CoglPixelFormat texture_format,
   atlas->map = NULL;
   atlas->texture = NULL;
   atlas->flags = flags;
+  atlas->defragment_stalled = FALSE;
   atlas->texture_format = texture_format;
   g_hook_list_init (&atlas->pre_reorganize_callbacks, sizeof (GHook));
   g_hook_list_init (&atlas->post_reorganize_callbacks, sizeof (GHook));
@@ -369,16 +370,11 @@ _cogl_atlas_notify_post_reorganize (CoglAtlas *atlas)
 }
 
 gboolean
-_cogl_atlas_reserve_space (CoglAtlas             *atlas,
-                           unsigned int           width,
-                           unsigned int           height,
-                           void                  *user_data)
+_cogl_atlas_try_reserve_space (CoglAtlas             *atlas,
+                               unsigned int           width,
+                               unsigned int           height,
+                               void                  *user_data)
 {
-  CoglAtlasGetRectanglesData data;
-  CoglRectangleMap *new_map;
-  CoglTexture2D *new_tex;
-  unsigned int map_width = 0, map_height = 0;
-  gboolean ret;
   CoglRectangleMapEntry new_position;
 
   /* Check if we can fit the rectangle into the existing map */
@@ -404,6 +400,138 @@ _cogl_atlas_reserve_space (CoglAtlas             *atlas,
       return TRUE;
     }
 
+  return FALSE;
+}
+
+typedef struct _CoglAtlasUpdatePositionsData
+{
+  CoglAtlas *atlas;
+  CoglTexture *new_texture;
+} CoglAtlasUpdatePositionsData;
+
+static void
+_cogl_atlas_update_positions_cb (const CoglRectangleMapEntry *rectangle,
+                                 void                        *rect_data,
+                                 void                        *user_data)
+{
+  CoglAtlasUpdatePositionsData *data = user_data;
+
+  data->atlas->update_position_cb (rect_data,
+                                   data->new_texture,
+                                   rectangle);
+}
+
+static gboolean
+_cogl_atlas_grow (CoglAtlas    *atlas,
+                  unsigned int  width,
+                  unsigned int  height,
+                  void         *user_data)
+{
+  CoglAtlasUpdatePositionsData data;
+  CoglTexture2D *new_tex;
+  unsigned int old_width, old_height;
+  unsigned int map_width, map_height;
+  GLenum gl_intformat;
+  GLenum gl_format;
+  GLenum gl_type;
+
+  _COGL_GET_CONTEXT (ctx, FALSE);
+
+  old_width = map_width = _cogl_rectangle_map_get_width (atlas->map);
+  old_height = map_height = _cogl_rectangle_map_get_height (atlas->map);
+  _cogl_atlas_get_next_size (&map_width, &map_height);
+
+  /* Growing only adds space to the right of or below the existing
+     rectangles so the new one has to fit entirely within that
+     space. Otherwise we leave it to a full reorganization */
+  if (width > map_width - (map_width > old_width ? old_width : 0) ||
+      height > map_height - (map_height > old_height ? old_height : 0))
+    return FALSE;
+
+  ctx->driver_vtable->pixel_format_to_gl (ctx,
+                                          atlas->texture_format,
+                                          &gl_intformat,
+                                          &gl_format,
+                                          &gl_type);
+
+  if (!ctx->texture_driver->size_supported (ctx,
+                                            GL_TEXTURE_2D,
+                                            gl_intformat,
+                                            gl_format,
+                                            gl_type,
+                                            map_width, map_height))
+    return FALSE;
+
+  new_tex = _cogl_atlas_create_texture (atlas, map_width, map_height);
+  if (new_tex == NULL)
+    return FALSE;
+
+  COGL_NOTE (ATLAS, "%p: Atlas grown in place to %ux%u",
+             atlas, map_width, map_height);
+
+  _cogl_atlas_notify_pre_reorganize (atlas);
+
+  /* None of the existing rectangles move so all of their contents can
+     be copied over with a single blit instead of one per texture */
+  if (!(atlas->flags & COGL_ATLAS_DISABLE_MIGRATION))
+    {
+      CoglBlitData blit_data;
+
+      _cogl_blit_begin (&blit_data, COGL_TEXTURE (new_tex), atlas->texture);
+      _cogl_blit (&blit_data, 0, 0, 0, 0, old_width, old_height);
+      _cogl_blit_end (&blit_data);
+    }
+
+  _cogl_rectangle_map_grow (atlas->map, map_width, map_height);
+
+  /* This can't fail because the new space is big enough */
+  _cogl_rectangle_map_add (atlas->map, width, height, user_data, NULL);
+
+  /* Point all of the textures, including the new one, at the new
+     texture */
+  data.atlas = atlas;
+  data.new_texture = COGL_TEXTURE (new_tex);
+  _cogl_rectangle_map_foreach (atlas->map,
+                               _cogl_atlas_update_positions_cb,
+                               &data);
+
+  cogl_object_unref (atlas->texture);
+  atlas->texture = COGL_TEXTURE (new_tex);
+
+  _cogl_atlas_notify_post_reorganize (atlas);
+
+  return TRUE;
+}
+
+gboolean
+_cogl_atlas_reserve_space (CoglAtlas             *atlas,
+                           unsigned int           width,
+                           unsigned int           height,
+                           void                  *user_data)
+{
+  CoglAtlasGetRectanglesData data;
+  CoglRectangleMap *new_map;
+  CoglTexture2D *new_tex;
+  unsigned int map_width = 0, map_height = 0;
+  gboolean ret;
+
+  if (_cogl_atlas_try_reserve_space (atlas, width, height, user_data))
+    return TRUE;
+
+  /* Repacking every rectangle into a new texture means a blit per
+     texture so we only do it when it would let the atlas stay the
+     same size. If the atlas needs to get bigger anyway then it's much
+     cheaper to grow it in place */
+  if (atlas->map &&
+      (_cogl_rectangle_map_get_width (atlas->map) *
+       _cogl_rectangle_map_get_height (atlas->map) -
+       _cogl_rectangle_map_get_remaining_space (atlas->map) +
+       width * height) * 53 / 50 >
+      _cogl_rectangle_map_get_width (atlas->map) *
+      _cogl_rectangle_map_get_height (atlas->map) &&
+      _cogl_atlas_grow (atlas, width, height, user_data))
+    return TRUE;
+
   /* If we make it here then we need to reorganize the atlas. First
      we'll notify any users of the atlas that this is going to happen
      so that for example in CoglAtlasTexture it can notify that the
@@ -545,6 +673,9 @@ _cogl_atlas_remove (CoglAtlas *atlas,
 {
   _cogl_rectangle_map_remove (atlas->map, rectangle);
 
+  /* There might be somewhere for the other rectangles to go now */
+  atlas->defragment_stalled = FALSE;
+
   COGL_NOTE (ATLAS, "%p: Removed rectangle sized %ix%i",
              atlas,
              rectangle->width,
@@ -637,6 +768,161 @@ _cogl_atlas_copy_rectangle (CoglAtlas *atlas,
   return tex;
 }
 
+static int
+_cogl_atlas_compare_position_cb (const void *a,
+                                 const void *b)
+{
+  const CoglAtlasRepositionData *ta = a;
+  const CoglAtlasRepositionData *tb = b;
+
+  /* Sort the rectangles furthest from the top-left corner first */
+  if (ta->old_position.y != tb->old_position.y)
+    return ta->old_position.y < tb->old_position.y ? 1 : -1;
+  if (ta->old_position.x != tb->old_position.x)
+    return ta->old_position.x < tb->old_position.x ? 1 : -1;
+  return 0;
+}
+
+gboolean
+_cogl_atlas_is_fragmented (CoglAtlas *atlas)
+{
+  unsigned int remaining_space, atlas_size;
+
+  if (atlas->map == NULL || atlas->defragment_stalled)
+    return FALSE;
+
+  remaining_space = _cogl_rectangle_map_get_remaining_space (atlas->map);
+  atlas_size = (_cogl_rectangle_map_get_width (atlas->map) *
+                _cogl_rectangle_map_get_height (atlas->map));
+
+  /* It's only worth compacting if a reasonable amount of the atlas is
+     free and less than half of that free space is in one piece */
+  return (remaining_space >= atlas_size / 8 &&
+          _cogl_rectangle_map_get_largest_gap (atlas->map) <
+          remaining_space / 2);
+}
+
+unsigned int
+_cogl_atlas_defragment (CoglAtlas    *atlas,
+                        unsigned int  max_moves)
+{
+  CoglAtlasGetRectanglesData data;
+  unsigned int n_moved = 0;
+  unsigned int i;
+
+  if ((atlas->flags & COGL_ATLAS_DISABLE_MIGRATION) ||
+      max_moves == 0 ||
+      !_cogl_atlas_is_fragmented (atlas))
+    return 0;
+
+  data.n_textures = 0;
+  data.textures = g_new (CoglAtlasRepositionData,
+                         _cogl_rectangle_map_get_n_rectangles (atlas->map));
+  _cogl_rectangle_map_foreach (atlas->map,
+                               _cogl_atlas_get_rectangles_cb,
+                               &data);
+
+  qsort (data.textures, data.n_textures,
+         sizeof (CoglAtlasRepositionData),
+         _cogl_atlas_compare_position_cb);
+
+  /* Try to move the rectangles that are furthest from the origin into
+     gaps nearer to it. Rectangles only ever move towards the top-left
+     so repeated calls will always settle down, and the free space
+     collects into one block at the far end of the atlas where it can
+     be merged back together by the rectangle map. The number of tree
+     searches is bounded as well as the number of blits so that this
+     is cheap enough to call every frame */
+  for (i = 0;
+       i < data.n_textures && i < max_moves * 4 && n_moved < max_moves;
+       i++)
+    {
+      CoglAtlasRepositionData *texture = data.textures + i;
+      CoglRectangleMapEntry *old_position = &texture->old_position;
+      CoglRectangleMapEntry *new_position = &texture->new_position;
+      CoglTexture *tmp_tex;
+      CoglBlitData blit_data;
+
+      if (!_cogl_rectangle_map_add (atlas->map,
+                                    old_position->width,
+                                    old_position->height,
+                                    texture->user_data,
+                                    new_position))
+        continue;
+
+      if (new_position->y > old_position->y ||
+          (new_position->y == old_position->y &&
+           new_position->x >= old_position->x))
+        {
+          _cogl_rectangle_map_remove (atlas->map, new_position);
+          continue;
+        }
+
+      if (n_moved == 0)
+        {
+          /* The listeners expect to see each texture in the map once
+             when they are notified so the new rectangle has to be
+             taken out again while that happens. Adding it back will
+             put it in the same place */
+          _cogl_rectangle_map_remove (atlas->map, new_position);
+          _cogl_atlas_notify_pre_reorganize (atlas);
+          _cogl_rectangle_map_add (atlas->map,
+                                   old_position->width,
+                                   old_position->height,
+                                   texture->user_data,
+                                   new_position);
+        }
+
+      /* The source and destination are in the same texture so go via
+         a temporary texture rather than reading and rendering to the
+         atlas texture in the same blit */
+      tmp_tex = _cogl_atlas_copy_rectangle (atlas,
+                                            old_position->x,
+                                            old_position->y,
+                                            old_position->width,
+                                            old_position->height,
+                                            atlas->texture_format);
+      if (tmp_tex == NULL)
+        {
+          _cogl_rectangle_map_remove (atlas->map, new_position);
+          break;
+        }
+
+      _cogl_blit_begin (&blit_data, atlas->texture, tmp_tex);
+      _cogl_blit (&blit_data,
+                  0, 0,
+                  new_position->x, new_position->y,
+                  new_position->width, new_position->height);
+      _cogl_blit_end (&blit_data);
+
+      cogl_object_unref (tmp_tex);
+
+      atlas->update_position_cb (texture->user_data,
+                                 atlas->texture,
+                                 new_position);
+      _cogl_rectangle_map_remove (atlas->map, old_position);
+
+      n_moved++;
+    }
+
+  g_free (data.textures);
+
+  if (n_moved == 0)
+    atlas->defragment_stalled = TRUE;
+  else
+    {
+      COGL_NOTE (ATLAS, "%p: Moved %u rectangles while defragmenting, "
+                 "largest gap is now %u of %u",
+                 atlas, n_moved,
+                 _cogl_rectangle_map_get_largest_gap (atlas->map),
+                 _cogl_rectangle_map_get_remaining_space (atlas->map));
+
+      _cogl_atlas_notify_post_reorganize (atlas);
+    }
+
+  return n_moved;
+}
+
 void
 _cogl_atlas_add_reorganize_callback (CoglAtlas            *atlas,
                                      GHookFunc             pre_callback,
@@ -60,6 +60,10 @@ struct _CoglAtlas
 
   CoglAtlasUpdatePositionCallback update_position_cb;
 
+  /* Set when _cogl_atlas_defragment() couldn't move anything so that
+     it isn't retried until a rectangle is removed */
+  gboolean defragment_stalled;
+
   GHookList pre_reorganize_callbacks;
   GHookList post_reorganize_callbacks;
 };
@@ -75,10 +79,31 @@ _cogl_atlas_reserve_space (CoglAtlas             *atlas,
                            unsigned int           height,
                            void                  *user_data);
 
-void
+/* Like _cogl_atlas_reserve_space() but fails instead of reorganizing
+   or resizing the atlas when the rectangle doesn't fit */
+COGL_EXPORT gboolean
+_cogl_atlas_try_reserve_space (CoglAtlas             *atlas,
+                               unsigned int           width,
+                               unsigned int           height,
+                               void                  *user_data);
+
+COGL_EXPORT void
 _cogl_atlas_remove (CoglAtlas *atlas,
                     const CoglRectangleMapEntry *rectangle);
 
+/* Returns whether enough of the free space in the atlas is split into
+   small gaps that it would be worth calling _cogl_atlas_defragment() */
+COGL_EXPORT gboolean
+_cogl_atlas_is_fragmented (CoglAtlas *atlas);
+
+/* Moves at most max_moves rectangles into gaps nearer the start of the
+   atlas so that the free space gets merged back together without
+   having to reorganize the whole atlas at once. Returns the number of
+   rectangles that were moved */
+unsigned int
+_cogl_atlas_defragment (CoglAtlas    *atlas,
+                        unsigned int  max_moves);
+
 CoglTexture *
 _cogl_atlas_copy_rectangle (CoglAtlas *atlas,
                             int x,
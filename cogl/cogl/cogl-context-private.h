@@ -194,6 +194,10 @@ struct _CoglContext
 
   GSList           *atlases;
   GHookList         atlas_reorganize_callbacks;
+  /* Idle source compacting fragmented atlases, and whether the atlas
+     reorganize callbacks are currently invoked for moves done by it */
+  unsigned int      atlas_defragment_idle_id;
+  gboolean          atlas_defragmenting;
 
   /* This debugging variable is used to pick a colour for visually
      displaying the quad batches. It needs to be global so that it can
@@ -357,6 +357,7 @@ _cogl_rectangle_map_add (CoglRectangleMap *map,
   /* Stack of nodes to search in */
   GArray *stack = map->stack;
   CoglRectangleMapNode *found_node = NULL;
+  unsigned int best_waste = 0;
 
   /* Zero-sized rectangles break the algorithm for removing rectangles
      so we'll disallow them */
@@ -366,7 +367,12 @@ _cogl_rectangle_map_add (CoglRectangleMap *map,
   g_array_set_size (stack, 0);
   _cogl_rectangle_map_stack_push (stack, map->root, FALSE);
 
-  /* Depth-first search for an empty node that is big enough */
+  /* Depth-first search for the empty node that fits the rectangle
+     most tightly. Always taking the first node that is big enough
+     tends to carve small rectangles out of the large gaps near the
+     start of the tree which makes it fragment quickly, so instead we
+     keep looking for the node that would leave the least space
+     unused. An exact fit can't be beaten so we stop there */
   while (stack->len > 0)
     {
       CoglRectangleMapStackEntry *stack_top;
@@ -388,9 +394,16 @@ _cogl_rectangle_map_add (CoglRectangleMap *map,
         {
           if (node->type == COGL_RECTANGLE_MAP_EMPTY_LEAF)
             {
-              /* We've found a node we can use */
-              found_node = node;
-              break;
+              unsigned int waste = node->largest_gap - rectangle_size;
+
+              if (found_node == NULL || waste < best_waste)
+                {
+                  found_node = node;
+                  best_waste = waste;
+
+                  if (waste == 0)
+                    break;
+                }
             }
           else if (node->type == COGL_RECTANGLE_MAP_BRANCH)
             {
@@ -561,6 +574,106 @@ _cogl_rectangle_map_remove (CoglRectangleMap *map,
 #endif
 }
 
+static CoglRectangleMapNode *
+_cogl_rectangle_map_node_new_parent (CoglRectangleMapNode *child,
+                                     unsigned int width,
+                                     unsigned int height)
+{
+  /* Creates a new branch node of the given size whose left child is
+     the given node and whose right child is an empty leaf covering
+     the rest of the space. The new space is either entirely to the
+     right of or entirely below the child */
+  CoglRectangleMapNode *parent = _cogl_rectangle_map_node_new ();
+  CoglRectangleMapNode *right = _cogl_rectangle_map_node_new ();
+
+  right->type = COGL_RECTANGLE_MAP_EMPTY_LEAF;
+  right->parent = parent;
+
+  if (width > child->rectangle.width)
+    {
+      g_assert (height == child->rectangle.height);
+
+      right->rectangle.x = child->rectangle.width;
+      right->rectangle.y = 0;
+      right->rectangle.width = width - child->rectangle.width;
+      right->rectangle.height = height;
+    }
+  else
+    {
+      g_assert (width == child->rectangle.width);
+
+      right->rectangle.x = 0;
+      right->rectangle.y = child->rectangle.height;
+      right->rectangle.width = width;
+      right->rectangle.height = height - child->rectangle.height;
+    }
+
+  right->largest_gap = right->rectangle.width * right->rectangle.height;
+
+  parent->type = COGL_RECTANGLE_MAP_BRANCH;
+  parent->parent = NULL;
+  parent->rectangle.x = 0;
+  parent->rectangle.y = 0;
+  parent->rectangle.width = width;
+  parent->rectangle.height = height;
+  parent->d.branch.left = child;
+  parent->d.branch.right = right;
+  parent->largest_gap = MAX (child->largest_gap, right->largest_gap);
+
+  child->parent = parent;
+
+  return parent;
+}
+
+void
+_cogl_rectangle_map_grow (CoglRectangleMap *map,
+                          unsigned int new_width,
+                          unsigned int new_height)
+{
+  CoglRectangleMapNode *root = map->root;
+  unsigned int old_width = root->rectangle.width;
+  unsigned int old_height = root->rectangle.height;
+
+  g_return_if_fail (new_width >= old_width && new_height >= old_height);
+
+  if (root->type == COGL_RECTANGLE_MAP_EMPTY_LEAF)
+    {
+      /* Nothing has been placed yet so the root can simply cover the
+         new size */
+      root->rectangle.width = new_width;
+      root->rectangle.height = new_height;
+      root->largest_gap = new_width * new_height;
+    }
+  else
+    {
+      /* Keep the existing tree as it is so that none of the
+         rectangles move and hang the new space off of new root
+         nodes. This works with _cogl_rectangle_map_remove because the
+         old tree always ends up as the left child and it covers the
+         top-left corner of the new root */
+      if (new_width > old_width)
+        root = _cogl_rectangle_map_node_new_parent (root,
+                                                    new_width,
+                                                    old_height);
+      if (new_height > old_height)
+        root = _cogl_rectangle_map_node_new_parent (root,
+                                                    new_width,
+                                                    new_height);
+
+      map->root = root;
+    }
+
+  map->space_remaining += new_width * new_height - old_width * old_height;
+
+#ifdef COGL_ENABLE_DEBUG
+  if (G_UNLIKELY (COGL_DEBUG_ENABLED (COGL_DEBUG_DUMP_ATLAS_IMAGE)))
+    {
+      _cogl_rectangle_map_dump_image (map);
+      _cogl_rectangle_map_verify (map);
+    }
+#endif
+}
+
 unsigned int
 _cogl_rectangle_map_get_width (CoglRectangleMap *map)
 {
@@ -585,6 +698,12 @@ _cogl_rectangle_map_get_n_rectangles (CoglRectangleMap *map)
   return map->n_rectangles;
 }
 
+unsigned int
+_cogl_rectangle_map_get_largest_gap (CoglRectangleMap *map)
+{
+  return map->root->largest_gap;
+}
+
 static void
 _cogl_rectangle_map_internal_foreach (CoglRectangleMap *map,
                                       CoglRectangleMapInternalForeachCb func,
@@ -61,18 +61,30 @@ void
 _cogl_rectangle_map_remove (CoglRectangleMap *map,
                             const CoglRectangleMapEntry *rectangle);
 
+/* Enlarges the map without moving any of the existing rectangles. The
+   new size must be at least as big as the old size in both
+   dimensions */
+void
+_cogl_rectangle_map_grow (CoglRectangleMap *map,
+                          unsigned int new_width,
+                          unsigned int new_height);
+
 unsigned int
 _cogl_rectangle_map_get_width (CoglRectangleMap *map);
 
 unsigned int
 _cogl_rectangle_map_get_height (CoglRectangleMap *map);
 
-unsigned int
+COGL_EXPORT unsigned int
 _cogl_rectangle_map_get_remaining_space (CoglRectangleMap *map);
 
 unsigned int
 _cogl_rectangle_map_get_n_rectangles (CoglRectangleMap *map);
 
+/* Returns the area of the biggest empty rectangle in the map */
+COGL_EXPORT unsigned int
+_cogl_rectangle_map_get_largest_gap (CoglRectangleMap *map);
+
 void
 _cogl_rectangle_map_foreach (CoglRectangleMap *map,
                              CoglRectangleMapCallback callback,
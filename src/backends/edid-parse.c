@@ -47,6 +47,18 @@
 #define EDID_EXT_CTA_TAG_EXTENDED_COLORIMETRY             0x0705
 #define EDID_EXT_CTA_TAG_EXTENDED_HDR_STATIC_METADATA     0x0706
 
+typedef struct _MetaEdidCacheEntry
+{
+  GBytes *edid;
+  MetaEdidInfo *info;
+  GList link;
+} MetaEdidCacheEntry;
+
+G_LOCK_DEFINE_STATIC (edid_cache);
+static GHashTable *edid_cache;
+static GQueue edid_cache_lru = G_QUEUE_INIT;
+static unsigned int edid_cache_hits;
+
 static int
 get_bit (int in, int bit)
 {
@@ -700,3 +712,97 @@ meta_edid_info_new_parse (const uint8_t *edid)
       return NULL;
     }
 }
+
+static void
+edid_cache_entry_free (MetaEdidCacheEntry *entry)
+{
+  g_bytes_unref (entry->edid);
+  g_free (entry->info);
+  g_free (entry);
+}
+
+/**
+ * meta_edid_info_new_from_bytes:
+ * @edid: the raw EDID blob
+ *
+ * Decodes @edid like meta_edid_info_new_parse(), but looks up the result in a
+ * process wide cache keyed by the content of the blob first. The same panels
+ * are enumerated again on every hotplug and on every GPU they are connected
+ * to, so this avoids decoding identical blobs over and over.
+ *
+ * Returns: (transfer full) (nullable): a newly allocated #MetaEdidInfo, or
+ *   %NULL if @edid could not be decoded
+ */
+MetaEdidInfo *
+meta_edid_info_new_from_bytes (GBytes *edid)
+{
+  MetaEdidCacheEntry *entry;
+  MetaEdidInfo *info;
+
+  G_LOCK (edid_cache);
+
+  if (!edid_cache)
+    {
+      edid_cache = g_hash_table_new_full (g_bytes_hash,
+                                          g_bytes_equal,
+                                          NULL,
+                                          (GDestroyNotify) edid_cache_entry_free);
+    }
+
+  entry = g_hash_table_lookup (edid_cache, edid);
+  if (entry)
+    {
+      edid_cache_hits++;
+
+      g_queue_unlink (&edid_cache_lru, &entry->link);
+      g_queue_push_tail_link (&edid_cache_lru, &entry->link);
+
+      info = entry->info ? g_memdup2 (entry->info, sizeof (MetaEdidInfo))
+                         : NULL;
+
+      G_UNLOCK (edid_cache);
+      return info;
+    }
+
+  G_UNLOCK (edid_cache);
+
+  info = meta_edid_info_new_parse (g_bytes_get_data (edid, NULL));
+
+  G_LOCK (edid_cache);
+
+  if (!g_hash_table_contains (edid_cache, edid))
+    {
+      if (g_queue_get_length (&edid_cache_lru) >= EDID_CACHE_MAX_SIZE)
+        {
+          MetaEdidCacheEntry *oldest;
+
+          oldest = g_queue_peek_head (&edid_cache_lru);
+          g_queue_unlink (&edid_cache_lru, &oldest->link);
+          g_hash_table_remove (edid_cache, oldest->edid);
+        }
+
+      entry = g_new0 (MetaEdidCacheEntry, 1);
+      entry->edid = g_bytes_ref (edid);
+      entry->info = info ? g_memdup2 (info, sizeof (MetaEdidInfo)) : NULL;
+      entry->link.data = entry;
+
+      g_hash_table_insert (edid_cache, entry->edid, entry);
+      g_queue_push_tail_link (&edid_cache_lru, &entry->link);
+    }
+
+  G_UNLOCK (edid_cache);
+
+  return info;
+}
+
+unsigned int
+meta_edid_info_get_cache_hits (void)
+{
+  unsigned int hits;
+
+  G_LOCK (edid_cache);
+  hits = edid_cache_hits;
+  G_UNLOCK (edid_cache);
+
+  return hits;
+}
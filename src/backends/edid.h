@@ -25,10 +25,14 @@
 #ifndef EDID_H
 #define EDID_H
 
+#include <glib.h>
 #include <stdint.h>
 
 #include "core/util-private.h"
 
+/* Number of distinct EDID blobs whose decoded info is kept around */
+#define EDID_CACHE_MAX_SIZE 16
+
 typedef struct _MetaEdidInfo MetaEdidInfo;
 typedef struct _MetaEdidTiming MetaEdidTiming;
 typedef struct _MetaEdidDetailedTiming MetaEdidDetailedTiming;
@@ -235,4 +239,10 @@ struct _MetaEdidInfo
 META_EXPORT_TEST
 MetaEdidInfo *meta_edid_info_new_parse (const uint8_t *data);
 
+META_EXPORT_TEST
+MetaEdidInfo *meta_edid_info_new_from_bytes (GBytes *edid);
+
+META_EXPORT_TEST
+unsigned int meta_edid_info_get_cache_hits (void);
+
 #endif
@@ -1104,6 +1104,16 @@ clutter_source_check (GSource *source)
   return clutter_events_pending ();
 }
 
+static void
+dispatch_clutter_event (MetaBackend  *backend,
+                        ClutterEvent *event)
+{
+  event->any.stage = CLUTTER_STAGE (meta_backend_get_stage (backend));
+  clutter_do_event (event);
+  meta_backend_update_from_event (backend, event);
+  clutter_event_free (event);
+}
+
 static gboolean
 clutter_source_dispatch (GSource     *source,
                          GSourceFunc  callback,
@@ -1113,17 +1123,25 @@ clutter_source_dispatch (GSource     *source,
   ClutterEvent *event = clutter_event_get ();
 
   if (event)
-    {
-      event->any.stage =
-        CLUTTER_STAGE (meta_backend_get_stage (backend_source->backend));
-      clutter_do_event (event);
-      meta_backend_update_from_event (backend_source->backend, event);
-      clutter_event_free (event);
-    }
+    dispatch_clutter_event (backend_source->backend, event);
 
   return TRUE;
 }
 
+/*
+ * Dispatches the events queued so far right away, for callers on the main
+ * context that queued events themselves, instead of leaving them to the
+ * next main loop iteration.
+ */
+void
+meta_backend_dispatch_pending_events (MetaBackend *backend)
+{
+  ClutterEvent *event;
+
+  while ((event = clutter_event_get ()))
+    dispatch_clutter_event (backend, event);
+}
+
 static GSourceFuncs clutter_source_funcs = {
   clutter_source_prepare,
   clutter_source_check,
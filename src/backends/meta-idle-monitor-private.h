@@ -35,7 +35,14 @@ typedef struct
   GDestroyNotify            notify;
   guint64                   timeout_msec;
   int                       idle_source_id;
-  GSource                  *timeout_source;
+
+  /* Position in the monitor's list of idle watches sorted by timeout, or
+   * in its list of user active watches */
+  GSequenceIter            *idle_iter;
+  GList                     user_active_link;
+
+  /* Value of the monitor's reset serial when the watch last fired */
+  unsigned int              fired_serial;
 } MetaIdleMonitorWatch;
 
 struct _MetaIdleMonitorClass
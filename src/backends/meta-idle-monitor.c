@@ -61,6 +61,18 @@ struct _MetaIdleMonitor
   GHashTable *watches;
   ClutterInputDevice *device;
   int64_t last_event_time;
+
+  /* Idle watches sorted by increasing timeout. As every watch counts
+   * from the same last event time, this is also the order they fire
+   * in, so a single source armed for the first one that hasn't fired
+   * yet is enough for all of them. */
+  GSequence *idle_watches;
+  GQueue user_active_watches;
+  GSource *timeout_source;
+
+  /* Increased on every reset so that watches don't have to be visited
+   * to mark them as not having fired yet */
+  unsigned int reset_serial;
 };
 
 G_DEFINE_TYPE (MetaIdleMonitor, meta_idle_monitor, G_TYPE_OBJECT)
@@ -79,6 +91,7 @@ meta_idle_monitor_watch_fire (MetaIdleMonitorWatch *watch)
 
   id = watch->id;
   is_user_active_watch = (watch->timeout_msec == 0);
+  watch->fired_serial = monitor->reset_serial;
 
   if (watch->callback)
     watch->callback (monitor, id, watch->user_data);
@@ -95,6 +108,12 @@ meta_idle_monitor_dispose (GObject *object)
   MetaIdleMonitor *monitor = META_IDLE_MONITOR (object);
 
   g_clear_pointer (&monitor->watches, g_hash_table_destroy);
+  g_clear_pointer (&monitor->idle_watches, g_sequence_free);
+  if (monitor->timeout_source)
+    {
+      g_source_destroy (monitor->timeout_source);
+      g_clear_pointer (&monitor->timeout_source, g_source_unref);
+    }
   g_clear_object (&monitor->session_proxy);
 
   G_OBJECT_CLASS (meta_idle_monitor_parent_class)->dispose (object);
@@ -174,34 +193,57 @@ free_watch (gpointer data)
   if (watch->notify != NULL)
     watch->notify (watch->user_data);
 
-  if (watch->timeout_source != NULL)
-    g_source_destroy (watch->timeout_source);
+  /* If this was the watch the timeout was armed for, the timeout will
+   * just find nothing to fire and rearm itself for the next one */
+  if (watch->idle_iter)
+    g_sequence_remove (watch->idle_iter);
+  else
+    g_queue_unlink (&monitor->user_active_watches, &watch->user_active_link);
 
   g_object_unref (monitor);
   g_free (watch);
 }
 
-static void
-update_inhibited_watch (gpointer key,
-                        gpointer value,
-                        gpointer user_data)
+static MetaIdleMonitorWatch *
+get_next_idle_watch (MetaIdleMonitor *monitor)
 {
-  MetaIdleMonitor *monitor = user_data;
-  MetaIdleMonitorWatch *watch = value;
+  GSequenceIter *iter;
 
-  if (!watch->timeout_source)
-    return;
+  for (iter = g_sequence_get_begin_iter (monitor->idle_watches);
+       !g_sequence_iter_is_end (iter);
+       iter = g_sequence_iter_next (iter))
+    {
+      MetaIdleMonitorWatch *watch = g_sequence_get (iter);
+
+      if (watch->fired_serial != monitor->reset_serial)
+        return watch;
+    }
+
+  return NULL;
+}
+
+static void
+update_timeout (MetaIdleMonitor *monitor)
+{
+  MetaIdleMonitorWatch *watch;
 
   if (monitor->inhibited)
     {
-      g_source_set_ready_time (watch->timeout_source, -1);
+      g_source_set_ready_time (monitor->timeout_source, -1);
+      return;
     }
-  else
+
+  watch = get_next_idle_watch (monitor);
+  if (watch)
     {
-      g_source_set_ready_time (watch->timeout_source,
+      g_source_set_ready_time (monitor->timeout_source,
                                monitor->last_event_time +
                                watch->timeout_msec * 1000);
     }
+  else
+    {
+      g_source_set_ready_time (monitor->timeout_source, -1);
+    }
 }
 
 static void
@@ -213,11 +255,55 @@ update_inhibited (MetaIdleMonitor *monitor,
 
   monitor->inhibited = inhibited;
 
-  g_hash_table_foreach (monitor->watches,
-                        update_inhibited_watch,
-                        monitor);
+  update_timeout (monitor);
 }
 
+static gboolean
+idle_monitor_dispatch_timeout (GSource     *source,
+                               GSourceFunc  callback,
+                               gpointer     user_data)
+{
+  MetaIdleMonitor *monitor = META_IDLE_MONITOR (user_data);
+  int64_t now;
+  int64_t ready_time;
+
+  now = g_source_get_time (source);
+  ready_time = g_source_get_ready_time (source);
+  if (ready_time > now)
+    return G_SOURCE_CONTINUE;
+
+  g_object_ref (monitor);
+
+  /* Fire every watch that is due. The callbacks may add or remove
+   * watches, so look up the next one from the start each time rather
+   * than holding on to an iterator. */
+  while (!monitor->inhibited && monitor->idle_watches)
+    {
+      MetaIdleMonitorWatch *watch;
+
+      watch = get_next_idle_watch (monitor);
+      if (!watch ||
+          monitor->last_event_time + watch->timeout_msec * 1000 > now)
+        break;
+
+      meta_idle_monitor_watch_fire (watch);
+    }
+
+  if (monitor->timeout_source)
+    update_timeout (monitor);
+
+  g_object_unref (monitor);
+
+  return G_SOURCE_CONTINUE;
+}
+
+static GSourceFuncs idle_monitor_source_funcs = {
+  .prepare = NULL,
+  .check = NULL,
+  .dispatch = idle_monitor_dispatch_timeout,
+  .finalize = NULL,
+};
+
 static void
 meta_idle_monitor_inhibited_actions_changed (GDBusProxy  *session,
                                              GVariant    *changed,
@@ -247,7 +333,16 @@ meta_idle_monitor_init (MetaIdleMonitor *monitor)
   GVariant *v;
 
   monitor->watches = g_hash_table_new_full (NULL, NULL, NULL, free_watch);
+  monitor->idle_watches = g_sequence_new (NULL);
+  g_queue_init (&monitor->user_active_watches);
   monitor->last_event_time = g_get_monotonic_time ();
+  monitor->reset_serial = 1;
+
+  monitor->timeout_source = g_source_new (&idle_monitor_source_funcs,
+                                          sizeof (GSource));
+  g_source_set_name (monitor->timeout_source, "[mutter] Idle monitor");
+  g_source_set_callback (monitor->timeout_source, NULL, monitor, NULL);
+  g_source_attach (monitor->timeout_source, NULL);
 
   /* Monitor inhibitors */
   monitor->session_proxy =
@@ -287,34 +382,21 @@ get_next_watch_serial (void)
   return serial;
 }
 
-static gboolean
-idle_monitor_dispatch_timeout (GSource     *source,
-                               GSourceFunc  callback,
-                               gpointer     user_data)
+static int
+compare_idle_watches (gconstpointer a,
+                      gconstpointer b,
+                      gpointer      user_data)
 {
-  MetaIdleMonitorWatch *watch = (MetaIdleMonitorWatch *) user_data;
-  int64_t now;
-  int64_t ready_time;
+  const MetaIdleMonitorWatch *watch_a = a;
+  const MetaIdleMonitorWatch *watch_b = b;
 
-  now = g_source_get_time (source);
-  ready_time = g_source_get_ready_time (source);
-  if (ready_time > now)
-    return G_SOURCE_CONTINUE;
-
-  g_source_set_ready_time (watch->timeout_source, -1);
+  if (watch_a->timeout_msec != watch_b->timeout_msec)
+    return watch_a->timeout_msec < watch_b->timeout_msec ? -1 : 1;
 
-  meta_idle_monitor_watch_fire (watch);
-
-  return G_SOURCE_CONTINUE;
+  /* Watches with the same timeout fire in the order they were added */
+  return watch_a->id < watch_b->id ? -1 : watch_a->id > watch_b->id;
 }
 
-static GSourceFuncs idle_monitor_source_funcs = {
-  .prepare = NULL,
-  .check = NULL,
-  .dispatch = idle_monitor_dispatch_timeout,
-  .finalize = NULL,
-};
-
 static MetaIdleMonitorWatch *
 make_watch (MetaIdleMonitor           *monitor,
             guint64                    timeout_msec,
@@ -335,21 +417,30 @@ make_watch (MetaIdleMonitor           *monitor,
 
   if (timeout_msec != 0)
     {
-      GSource *source = g_source_new (&idle_monitor_source_funcs,
-                                      sizeof (GSource));
-      g_source_set_name (source, "[mutter] Idle monitor");
-
-      g_source_set_callback (source, NULL, watch, NULL);
-      if (!monitor->inhibited)
+      int64_t ready_time;
+
+      watch->idle_iter = g_sequence_insert_sorted (monitor->idle_watches,
+                                                   watch,
+                                                   compare_idle_watches,
+                                                   NULL);
+
+      /* Only move the timeout earlier. If the idle time has already
+       * passed the new timeout, it fires straight away. */
+      ready_time = g_source_get_ready_time (monitor->timeout_source);
+      if (!monitor->inhibited &&
+          (ready_time == -1 ||
+           monitor->last_event_time + timeout_msec * 1000 < ready_time))
         {
-          g_source_set_ready_time (source,
+          g_source_set_ready_time (monitor->timeout_source,
                                    monitor->last_event_time +
                                    timeout_msec * 1000);
         }
-      g_source_attach (source, NULL);
-      g_source_unref (source);
-
-      watch->timeout_source = source;
+    }
+  else
+    {
+      watch->user_active_link.data = watch;
+      g_queue_push_tail_link (&monitor->user_active_watches,
+                              &watch->user_active_link);
     }
 
   g_hash_table_insert (monitor->watches,
@@ -472,42 +563,43 @@ meta_idle_monitor_get_idletime (MetaIdleMonitor *monitor)
 void
 meta_idle_monitor_reset_idletime (MetaIdleMonitor *monitor)
 {
-  GList *node, *watch_ids;
-
   monitor->last_event_time = g_get_monotonic_time ();
 
-  watch_ids = g_hash_table_get_keys (monitor->watches);
+  /* This marks all idle watches as not having fired, and the first one
+   * to fire again is the one with the smallest timeout */
+  monitor->reset_serial++;
+  update_timeout (monitor);
 
-  for (node = watch_ids; node != NULL; node = node->next)
+  if (!g_queue_is_empty (&monitor->user_active_watches))
     {
-      guint watch_id = GPOINTER_TO_UINT (node->data);
-      MetaIdleMonitorWatch *watch;
-
-      watch = g_hash_table_lookup (monitor->watches,
-                                   GUINT_TO_POINTER (watch_id));
-      if (!watch)
-        continue;
+      GList *node, *watch_ids = NULL;
 
-      if (watch->timeout_msec == 0)
+      for (node = monitor->user_active_watches.head; node; node = node->next)
         {
-          meta_idle_monitor_watch_fire (watch);
+          MetaIdleMonitorWatch *watch = node->data;
+
+          watch_ids = g_list_prepend (watch_ids,
+                                      GUINT_TO_POINTER (watch->id));
         }
-      else
+
+      /* The callbacks may remove other watches, so look each one up
+       * again before firing it */
+      watch_ids = g_list_reverse (watch_ids);
+      for (node = watch_ids; node != NULL; node = node->next)
         {
-          if (monitor->inhibited)
-            {
-              g_source_set_ready_time (watch->timeout_source, -1);
-            }
-          else
-            {
-              g_source_set_ready_time (watch->timeout_source,
-                                       monitor->last_event_time +
-                                       watch->timeout_msec * 1000);
-            }
+          guint watch_id = GPOINTER_TO_UINT (node->data);
+          MetaIdleMonitorWatch *watch;
+
+          watch = g_hash_table_lookup (monitor->watches,
+                                       GUINT_TO_POINTER (watch_id));
+          if (!watch)
+            continue;
+
+          meta_idle_monitor_watch_fire (watch);
         }
-    }
 
-  g_list_free (watch_ids);
+      g_list_free (watch_ids);
+    }
 }
 
 MetaIdleManager *
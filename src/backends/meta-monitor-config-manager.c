@@ -29,11 +29,17 @@
 #include "backends/meta-monitor-config-store.h"
 #include "backends/meta-monitor-manager-private.h"
 #include "backends/meta-output.h"
+#include "backends/meta-settings-private.h"
 #include "core/boxes-private.h"
 #include "meta/meta-monitor-manager.h"
 
 #define CONFIG_HISTORY_MAX_SIZE 3
 
+/* Number of monitor setups to remember the working generated
+ * configuration for, e.g. the laptop on its own, docked, and docked
+ * with the lid closed */
+#define CANDIDATE_CONFIGS_MAX_SIZE 8
+
 struct _MetaMonitorConfigManager
 {
   GObject parent;
@@ -44,6 +50,8 @@ struct _MetaMonitorConfigManager
 
   MetaMonitorsConfig *current_config;
   GQueue config_history;
+
+  GHashTable *candidate_configs;
 };
 
 G_DEFINE_TYPE (MetaMonitorConfigManager, meta_monitor_config_manager,
@@ -1505,6 +1513,123 @@ meta_monitor_config_manager_clear_history (MetaMonitorConfigManager *config_mana
   g_queue_clear (&config_manager->config_history);
 }
 
+/*
+ * Generated configurations depend on more than the set of connected
+ * monitors that make up a MetaMonitorsConfigKey, e.g. on the preferred
+ * mode of each monitor and on the scaling settings. Everything that
+ * goes into generating one is included here so that a candidate is
+ * only ever reused for an identical setup.
+ */
+static char *
+create_candidate_key_for_current_state (MetaMonitorConfigManager *config_manager)
+{
+  MetaMonitorManager *monitor_manager = config_manager->monitor_manager;
+  MetaBackend *backend = meta_monitor_manager_get_backend (monitor_manager);
+  MetaSettings *settings = meta_backend_get_settings (backend);
+  GString *key;
+  int global_scale = 0;
+  GList *l;
+
+  if (!monitor_manager->monitors)
+    return NULL;
+
+  meta_settings_get_global_scaling_factor (settings, &global_scale);
+
+  key = g_string_new (NULL);
+  g_string_append_printf (key, "%d:%d:%d;",
+                          meta_monitor_manager_get_default_layout_mode (monitor_manager),
+                          is_lid_closed (monitor_manager),
+                          global_scale);
+
+  for (l = monitor_manager->monitors; l; l = l->next)
+    {
+      MetaMonitor *monitor = l->data;
+      MetaMonitorSpec *monitor_spec = meta_monitor_get_spec (monitor);
+      MetaMonitorMode *preferred_mode = meta_monitor_get_preferred_mode (monitor);
+      MetaMonitorModeSpec *mode_spec = meta_monitor_mode_get_spec (preferred_mode);
+      int width_mm, height_mm;
+      unsigned int max_bpc = 0;
+
+      meta_monitor_get_physical_dimensions (monitor, &width_mm, &height_mm);
+      meta_monitor_get_max_bpc (monitor, &max_bpc);
+
+      g_string_append_printf (key, "%s:%s:%s:%s:%dx%d@%.3f:%x:%dx%d:%d:%d:%u;",
+                              monitor_spec->connector,
+                              monitor_spec->vendor ? monitor_spec->vendor : "",
+                              monitor_spec->product ? monitor_spec->product : "",
+                              monitor_spec->serial ? monitor_spec->serial : "",
+                              mode_spec->width,
+                              mode_spec->height,
+                              mode_spec->refresh_rate,
+                              mode_spec->flags,
+                              width_mm,
+                              height_mm,
+                              meta_monitor_is_laptop_panel (monitor),
+                              meta_monitor_is_underscanning (monitor),
+                              max_bpc);
+    }
+
+  return g_string_free (key, FALSE);
+}
+
+/**
+ * meta_monitor_config_manager_get_candidate:
+ * @config_manager: A #MetaMonitorConfigManager
+ *
+ * Looks up a generated configuration that was successfully applied to
+ * the exact same monitor setup as the current one before.
+ *
+ * Returns: (transfer none) (nullable): The cached configuration
+ */
+MetaMonitorsConfig *
+meta_monitor_config_manager_get_candidate (MetaMonitorConfigManager *config_manager)
+{
+  g_autofree char *key = NULL;
+
+  key = create_candidate_key_for_current_state (config_manager);
+  if (!key)
+    return NULL;
+
+  return g_hash_table_lookup (config_manager->candidate_configs, key);
+}
+
+void
+meta_monitor_config_manager_add_candidate (MetaMonitorConfigManager *config_manager,
+                                           MetaMonitorsConfig       *config)
+{
+  char *key;
+
+  key = create_candidate_key_for_current_state (config_manager);
+  if (!key)
+    return;
+
+  if (g_hash_table_size (config_manager->candidate_configs) >=
+      CANDIDATE_CONFIGS_MAX_SIZE &&
+      !g_hash_table_contains (config_manager->candidate_configs, key))
+    g_hash_table_remove_all (config_manager->candidate_configs);
+
+  g_hash_table_replace (config_manager->candidate_configs,
+                        key, g_object_ref (config));
+}
+
+void
+meta_monitor_config_manager_remove_candidate (MetaMonitorConfigManager *config_manager)
+{
+  g_autofree char *key = NULL;
+
+  key = create_candidate_key_for_current_state (config_manager);
+  if (!key)
+    return;
+
+  g_hash_table_remove (config_manager->candidate_configs, key);
+}
+
+void
+meta_monitor_config_manager_clear_candidates (MetaMonitorConfigManager *config_manager)
+{
+  g_hash_table_remove_all (config_manager->candidate_configs);
+}
+
 static void
 meta_monitor_config_manager_dispose (GObject *object)
 {
@@ -1513,6 +1638,7 @@ meta_monitor_config_manager_dispose (GObject *object)
 
   g_clear_object (&config_manager->current_config);
   meta_monitor_config_manager_clear_history (config_manager);
+  g_clear_pointer (&config_manager->candidate_configs, g_hash_table_unref);
 
   G_OBJECT_CLASS (meta_monitor_config_manager_parent_class)->dispose (object);
 }
@@ -1521,6 +1647,9 @@ static void
 meta_monitor_config_manager_init (MetaMonitorConfigManager *config_manager)
 {
   g_queue_init (&config_manager->config_history);
+  config_manager->candidate_configs =
+    g_hash_table_new_full (g_str_hash, g_str_equal,
+                           g_free, g_object_unref);
 }
 
 static void
@@ -141,6 +141,17 @@ void meta_monitor_config_manager_clear_history (MetaMonitorConfigManager *config
 META_EXPORT_TEST
 void meta_monitor_config_manager_save_current (MetaMonitorConfigManager *config_manager);
 
+META_EXPORT_TEST
+MetaMonitorsConfig * meta_monitor_config_manager_get_candidate (MetaMonitorConfigManager *config_manager);
+
+void meta_monitor_config_manager_add_candidate (MetaMonitorConfigManager *config_manager,
+                                                MetaMonitorsConfig       *config);
+
+void meta_monitor_config_manager_remove_candidate (MetaMonitorConfigManager *config_manager);
+
+META_EXPORT_TEST
+void meta_monitor_config_manager_clear_candidates (MetaMonitorConfigManager *config_manager);
+
 META_EXPORT_TEST
 MetaMonitorsConfig * meta_monitors_config_new_full (GList                        *logical_monitor_configs,
                                                     GList                        *disabled_monitors,
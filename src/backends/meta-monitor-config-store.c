@@ -23,6 +23,7 @@
 
 #include "backends/meta-monitor-config-store.h"
 
+#include <errno.h>
 #include <gio/gio.h>
 #include <string.h>
 
@@ -121,6 +122,10 @@ struct _MetaMonitorConfigStore
   GFile *custom_read_file;
   GFile *custom_write_file;
 
+  /* Whether the user configurations were last loaded from the cache
+   * rather than parsed from the XML file */
+  gboolean user_configs_cached;
+
   gboolean has_stores_policy;
   GList *stores_policy;
 
@@ -139,6 +144,8 @@ enum
 G_DEFINE_QUARK (meta-monitor-config-store-error-quark,
                 meta_monitor_config_store_error)
 
+static GQuark quark_config_xml_fragment = 0;
+
 typedef enum
 {
   STATE_INITIAL,
@@ -1400,20 +1407,18 @@ static const GMarkupParser config_parser = {
 };
 
 static gboolean
-read_config_file (MetaMonitorConfigStore  *config_store,
-                  GFile                   *file,
-                  MetaMonitorsConfigFlag   extra_config_flags,
-                  GHashTable             **out_configs,
-                  GError                 **error)
+parse_config_data (MetaMonitorConfigStore  *config_store,
+                   GFile                   *file,
+                   const char              *buffer,
+                   gsize                    size,
+                   MetaMonitorsConfigFlag   extra_config_flags,
+                   GHashTable             **out_configs,
+                   gboolean                *out_has_policy,
+                   GError                 **error)
 {
-  char *buffer;
-  gsize size;
   ConfigParser parser;
   GMarkupParseContext *parse_context;
 
-  if (!g_file_load_contents (file, NULL, &buffer, &size, NULL, error))
-    return FALSE;
-
   parser = (ConfigParser) {
     .state = STATE_INITIAL,
     .file = file,
@@ -1444,13 +1449,553 @@ read_config_file (MetaMonitorConfigStore  *config_store,
                        meta_logical_monitor_config_free);
       g_list_free (parser.stores);
       g_hash_table_unref (parser.pending_configs);
+      g_markup_parse_context_free (parse_context);
       return FALSE;
     }
 
   *out_configs = g_steal_pointer (&parser.pending_configs);
+  if (out_has_policy)
+    *out_has_policy = parser.seen_policy;
 
   g_markup_parse_context_free (parse_context);
-  g_free (buffer);
+
+  return TRUE;
+}
+
+static gboolean
+read_config_file (MetaMonitorConfigStore  *config_store,
+                  GFile                   *file,
+                  MetaMonitorsConfigFlag   extra_config_flags,
+                  GHashTable             **out_configs,
+                  GError                 **error)
+{
+  g_autofree char *buffer = NULL;
+  gsize size;
+
+  if (!g_file_load_contents (file, NULL, &buffer, &size, NULL, error))
+    return FALSE;
+
+  return parse_config_data (config_store, file, buffer, size,
+                            extra_config_flags,
+                            out_configs, NULL,
+                            error);
+}
+
+/*
+ * The parsed user configurations are cached in a binary form in the user
+ * cache directory, so that the next startup can skip parsing monitors.xml.
+ * There is a cache file per XML file, named after a checksum of its path.
+ * The cache
+ * is a serialized GVariant that is mapped directly from disk, and is only
+ * trusted if the size and modification time of the XML file it was generated
+ * from still match; if only the modification time changed, a checksum of the
+ * XML content is used to decide whether the cache is still valid.
+ *
+ * Files containing a policy are never cached, as the policy is applied to the
+ * store as a side effect of parsing.
+ *
+ * Like the XML file, the cache is rewritten as a whole every time the
+ * configurations are saved.
+ */
+
+#define MONITORS_CONFIG_CACHE_FORMAT_VERSION 1
+
+#define MONITOR_SPEC_FORMAT "(ssss)"
+#define MONITOR_MODE_SPEC_FORMAT "(iidu)"
+#define MONITOR_CONFIG_FORMAT \
+  "(" MONITOR_SPEC_FORMAT MONITOR_MODE_SPEC_FORMAT "bbu)"
+#define LOGICAL_MONITOR_CONFIG_FORMAT \
+  "((iiii)dubba" MONITOR_CONFIG_FORMAT ")"
+#define MONITORS_CONFIG_FORMAT \
+  "(uua" LOGICAL_MONITOR_CONFIG_FORMAT "a" MONITOR_SPEC_FORMAT ")"
+#define MONITORS_CONFIG_CACHE_FORMAT \
+  "(uttusa" MONITORS_CONFIG_FORMAT ")"
+
+GFile *
+meta_monitor_config_store_get_cache_file (GFile *file)
+{
+  g_autofree char *path_checksum = NULL;
+  g_autofree char *cache_name = NULL;
+  g_autofree char *cache_path = NULL;
+
+  path_checksum = g_compute_checksum_for_string (G_CHECKSUM_SHA256,
+                                                 g_file_peek_path (file),
+                                                 -1);
+  cache_name = g_strdup_printf ("monitors-%s.cache", path_checksum);
+  cache_path = g_build_filename (g_get_user_cache_dir (),
+                                 "mutter",
+                                 cache_name,
+                                 NULL);
+  return g_file_new_for_path (cache_path);
+}
+
+static gboolean
+query_file_stamp (GFile    *file,
+                  uint64_t *out_size,
+                  uint64_t *out_mtime_us)
+{
+  g_autoptr (GFileInfo) file_info = NULL;
+
+  file_info = g_file_query_info (file,
+                                 G_FILE_ATTRIBUTE_STANDARD_SIZE ","
+                                 G_FILE_ATTRIBUTE_TIME_MODIFIED ","
+                                 G_FILE_ATTRIBUTE_TIME_MODIFIED_USEC,
+                                 G_FILE_QUERY_INFO_NONE,
+                                 NULL, NULL);
+  if (!file_info)
+    return FALSE;
+
+  *out_size = g_file_info_get_size (file_info);
+  *out_mtime_us =
+    g_file_info_get_attribute_uint64 (file_info,
+                                      G_FILE_ATTRIBUTE_TIME_MODIFIED) *
+    G_USEC_PER_SEC +
+    g_file_info_get_attribute_uint32 (file_info,
+                                      G_FILE_ATTRIBUTE_TIME_MODIFIED_USEC);
+
+  return TRUE;
+}
+
+static GVariant *
+serialize_monitor_spec (MetaMonitorSpec *monitor_spec)
+{
+  return g_variant_new (MONITOR_SPEC_FORMAT,
+                        monitor_spec->connector,
+                        monitor_spec->vendor,
+                        monitor_spec->product,
+                        monitor_spec->serial);
+}
+
+static GVariant *
+serialize_monitors_config (MetaMonitorsConfig *config)
+{
+  GVariantBuilder logical_monitors_builder;
+  GVariantBuilder disabled_builder;
+  GList *l;
+
+  g_variant_builder_init (&logical_monitors_builder,
+                          G_VARIANT_TYPE ("a" LOGICAL_MONITOR_CONFIG_FORMAT));
+  for (l = config->logical_monitor_configs; l; l = l->next)
+    {
+      MetaLogicalMonitorConfig *logical_monitor_config = l->data;
+      MetaRectangle *layout = &logical_monitor_config->layout;
+      GVariantBuilder monitors_builder;
+      GList *k;
+
+      g_variant_builder_init (&monitors_builder,
+                              G_VARIANT_TYPE ("a" MONITOR_CONFIG_FORMAT));
+      for (k = logical_monitor_config->monitor_configs; k; k = k->next)
+        {
+          MetaMonitorConfig *monitor_config = k->data;
+          MetaMonitorModeSpec *mode_spec = monitor_config->mode_spec;
+
+          g_variant_builder_add (&monitors_builder,
+                                 "(@" MONITOR_SPEC_FORMAT
+                                 MONITOR_MODE_SPEC_FORMAT "bbu)",
+                                 serialize_monitor_spec (monitor_config->monitor_spec),
+                                 mode_spec->width,
+                                 mode_spec->height,
+                                 (double) mode_spec->refresh_rate,
+                                 (uint32_t) mode_spec->flags,
+                                 monitor_config->enable_underscanning,
+                                 monitor_config->has_max_bpc,
+                                 monitor_config->max_bpc);
+        }
+
+      g_variant_builder_add (&logical_monitors_builder,
+                             "((iiii)dubb@a" MONITOR_CONFIG_FORMAT ")",
+                             layout->x, layout->y,
+                             layout->width, layout->height,
+                             (double) logical_monitor_config->scale,
+                             (uint32_t) logical_monitor_config->transform,
+                             logical_monitor_config->is_primary,
+                             logical_monitor_config->is_presentation,
+                             g_variant_builder_end (&monitors_builder));
+    }
+
+  g_variant_builder_init (&disabled_builder,
+                          G_VARIANT_TYPE ("a" MONITOR_SPEC_FORMAT));
+  for (l = config->disabled_monitor_specs; l; l = l->next)
+    {
+      MetaMonitorSpec *monitor_spec = l->data;
+
+      g_variant_builder_add_value (&disabled_builder,
+                                   serialize_monitor_spec (monitor_spec));
+    }
+
+  return g_variant_new ("(uu@a" LOGICAL_MONITOR_CONFIG_FORMAT
+                        "@a" MONITOR_SPEC_FORMAT ")",
+                        (uint32_t) config->flags,
+                        (uint32_t) config->layout_mode,
+                        g_variant_builder_end (&logical_monitors_builder),
+                        g_variant_builder_end (&disabled_builder));
+}
+
+static GVariant *
+serialize_configs (GHashTable *configs)
+{
+  GVariantBuilder configs_builder;
+  GHashTableIter iter;
+  MetaMonitorsConfig *config;
+
+  g_variant_builder_init (&configs_builder,
+                          G_VARIANT_TYPE ("a" MONITORS_CONFIG_FORMAT));
+
+  g_hash_table_iter_init (&iter, configs);
+  while (g_hash_table_iter_next (&iter, NULL, (gpointer *) &config))
+    {
+      if (config->flags & META_MONITORS_CONFIG_FLAG_SYSTEM_CONFIG)
+        continue;
+
+      g_variant_builder_add_value (&configs_builder,
+                                   serialize_monitors_config (config));
+    }
+
+  return g_variant_builder_end (&configs_builder);
+}
+
+static GVariant *
+serialize_config_cache (MetaMonitorConfigStore *config_store,
+                        GVariant               *configs_variant,
+                        uint64_t                xml_size,
+                        uint64_t                xml_mtime_us,
+                        const char             *xml_checksum)
+{
+  MetaMonitorManager *monitor_manager = config_store->monitor_manager;
+  MetaLogicalMonitorLayoutMode default_layout_mode;
+
+  default_layout_mode =
+    meta_monitor_manager_get_default_layout_mode (monitor_manager);
+
+  return g_variant_ref_sink (
+    g_variant_new ("(uttus@a" MONITORS_CONFIG_FORMAT ")",
+                   MONITORS_CONFIG_CACHE_FORMAT_VERSION,
+                   xml_size,
+                   xml_mtime_us,
+                   (uint32_t) default_layout_mode,
+                   xml_checksum,
+                   configs_variant));
+}
+
+static void
+write_config_cache (GFile    *cache_file,
+                    GVariant *cache)
+{
+  g_autoptr (GError) error = NULL;
+  g_autofree char *cache_dir = NULL;
+
+  cache_dir = g_path_get_dirname (g_file_peek_path (cache_file));
+  if (g_mkdir_with_parents (cache_dir, 0700) != 0)
+    {
+      g_debug ("Failed to create monitor configuration cache directory '%s': %s",
+               cache_dir, g_strerror (errno));
+      return;
+    }
+
+  if (!g_file_set_contents (g_file_peek_path (cache_file),
+                            g_variant_get_data (cache),
+                            g_variant_get_size (cache),
+                            &error))
+    {
+      g_debug ("Failed to write monitor configuration cache '%s': %s",
+               g_file_peek_path (cache_file), error->message);
+    }
+}
+
+static MetaMonitorSpec *
+deserialize_monitor_spec (GVariant *monitor_spec_variant)
+{
+  MetaMonitorSpec *monitor_spec;
+
+  monitor_spec = g_new0 (MetaMonitorSpec, 1);
+  g_variant_get (monitor_spec_variant, MONITOR_SPEC_FORMAT,
+                 &monitor_spec->connector,
+                 &monitor_spec->vendor,
+                 &monitor_spec->product,
+                 &monitor_spec->serial);
+
+  return monitor_spec;
+}
+
+static MetaMonitorsConfig *
+deserialize_monitors_config (MetaMonitorConfigStore *config_store,
+                             GVariant               *config_variant,
+                             GError                **error)
+{
+  MetaMonitorManager *monitor_manager = config_store->monitor_manager;
+  g_autoptr (MetaMonitorsConfig) config = NULL;
+  g_autoptr (GVariantIter) logical_monitors_iter = NULL;
+  g_autoptr (GVariantIter) disabled_iter = NULL;
+  GList *logical_monitor_configs = NULL;
+  GList *disabled_monitor_specs = NULL;
+  uint32_t flags, layout_mode;
+  GVariant *logical_monitor_variant;
+  GVariant *monitor_spec_variant;
+  GList *l;
+
+  g_variant_get (config_variant, MONITORS_CONFIG_FORMAT,
+                 &flags, &layout_mode,
+                 &logical_monitors_iter,
+                 &disabled_iter);
+
+  while ((logical_monitor_variant =
+          g_variant_iter_next_value (logical_monitors_iter)))
+    {
+      MetaLogicalMonitorConfig *logical_monitor_config;
+      g_autoptr (GVariantIter) monitors_iter = NULL;
+      GVariant *monitor_variant;
+      double scale;
+      uint32_t transform;
+
+      logical_monitor_config = g_new0 (MetaLogicalMonitorConfig, 1);
+      logical_monitor_configs = g_list_append (logical_monitor_configs,
+                                               logical_monitor_config);
+
+      g_variant_get (logical_monitor_variant, LOGICAL_MONITOR_CONFIG_FORMAT,
+                     &logical_monitor_config->layout.x,
+                     &logical_monitor_config->layout.y,
+                     &logical_monitor_config->layout.width,
+                     &logical_monitor_config->layout.height,
+                     &scale,
+                     &transform,
+                     &logical_monitor_config->is_primary,
+                     &logical_monitor_config->is_presentation,
+                     &monitors_iter);
+      logical_monitor_config->scale = (float) scale;
+      logical_monitor_config->transform = transform;
+
+      while ((monitor_variant = g_variant_iter_next_value (monitors_iter)))
+        {
+          MetaMonitorConfig *monitor_config;
+          MetaMonitorModeSpec *mode_spec;
+          double refresh_rate;
+          uint32_t mode_flags;
+
+          monitor_config = g_new0 (MetaMonitorConfig, 1);
+          mode_spec = g_new0 (MetaMonitorModeSpec, 1);
+
+          monitor_spec_variant = g_variant_get_child_value (monitor_variant, 0);
+          monitor_config->monitor_spec =
+            deserialize_monitor_spec (monitor_spec_variant);
+          g_variant_unref (monitor_spec_variant);
+
+          g_variant_get_child (monitor_variant, 1, MONITOR_MODE_SPEC_FORMAT,
+                               &mode_spec->width,
+                               &mode_spec->height,
+                               &refresh_rate,
+                               &mode_flags);
+          mode_spec->refresh_rate = (float) refresh_rate;
+          mode_spec->flags = mode_flags;
+          monitor_config->mode_spec = mode_spec;
+
+          g_variant_get_child (monitor_variant, 2, "b",
+                               &monitor_config->enable_underscanning);
+          g_variant_get_child (monitor_variant, 3, "b",
+                               &monitor_config->has_max_bpc);
+          g_variant_get_child (monitor_variant, 4, "u",
+                               &monitor_config->max_bpc);
+          g_variant_unref (monitor_variant);
+
+          logical_monitor_config->monitor_configs =
+            g_list_append (logical_monitor_config->monitor_configs,
+                           monitor_config);
+
+          if (!meta_verify_monitor_mode_spec (mode_spec, error))
+            {
+              g_variant_unref (logical_monitor_variant);
+              g_list_free_full (logical_monitor_configs,
+                                (GDestroyNotify) meta_logical_monitor_config_free);
+              return NULL;
+            }
+        }
+
+      g_variant_unref (logical_monitor_variant);
+
+      if (!logical_monitor_config->monitor_configs ||
+          transform > META_MONITOR_TRANSFORM_FLIPPED_270)
+        {
+          g_set_error (error, G_IO_ERROR, G_IO_ERROR_INVALID_DATA,
+                       "Invalid logical monitor");
+          g_list_free_full (logical_monitor_configs,
+                            (GDestroyNotify) meta_logical_monitor_config_free);
+          return NULL;
+        }
+
+      if (!meta_verify_logical_monitor_config (logical_monitor_config,
+                                               layout_mode,
+                                               monitor_manager,
+                                               error))
+        {
+          g_list_free_full (logical_monitor_configs,
+                            (GDestroyNotify) meta_logical_monitor_config_free);
+          return NULL;
+        }
+    }
+
+  while ((monitor_spec_variant = g_variant_iter_next_value (disabled_iter)))
+    {
+      disabled_monitor_specs =
+        g_list_append (disabled_monitor_specs,
+                       deserialize_monitor_spec (monitor_spec_variant));
+      g_variant_unref (monitor_spec_variant);
+    }
+
+  config = meta_monitors_config_new_full (logical_monitor_configs,
+                                          disabled_monitor_specs,
+                                          layout_mode,
+                                          flags & META_MONITORS_CONFIG_FLAG_MIGRATED);
+
+  for (l = config->disabled_monitor_specs; l; l = l->next)
+    {
+      if (!meta_verify_monitor_spec (l->data, error))
+        return NULL;
+    }
+
+  if (!meta_verify_monitors_config (config, monitor_manager, error))
+    return NULL;
+
+  return g_steal_pointer (&config);
+}
+
+static gboolean
+load_config_cache (MetaMonitorConfigStore  *config_store,
+                   GFile                   *cache_file,
+                   uint64_t                 xml_size,
+                   uint64_t                 xml_mtime_us,
+                   const char              *xml_checksum,
+                   GHashTable             **out_configs)
+{
+  MetaMonitorManager *monitor_manager = config_store->monitor_manager;
+  g_autoptr (GMappedFile) mapped_file = NULL;
+  g_autoptr (GBytes) bytes = NULL;
+  g_autoptr (GVariant) cache = NULL;
+  g_autoptr (GVariantIter) configs_iter = NULL;
+  g_autoptr (GHashTable) configs = NULL;
+  g_autoptr (GError) error = NULL;
+  uint32_t version;
+  uint64_t cached_size, cached_mtime_us;
+  uint32_t cached_layout_mode;
+  const char *cached_checksum;
+  GVariant *config_variant;
+
+  mapped_file = g_mapped_file_new (g_file_peek_path (cache_file), FALSE, NULL);
+  if (!mapped_file)
+    return FALSE;
+
+  bytes = g_mapped_file_get_bytes (mapped_file);
+  cache = g_variant_ref_sink (
+    g_variant_new_from_bytes (G_VARIANT_TYPE (MONITORS_CONFIG_CACHE_FORMAT),
+                              bytes, FALSE));
+
+  g_variant_get (cache, "(uttu&s@a" MONITORS_CONFIG_FORMAT ")",
+                 &version,
+                 &cached_size,
+                 &cached_mtime_us,
+                 &cached_layout_mode,
+                 &cached_checksum,
+                 NULL);
+  if (version != MONITORS_CONFIG_CACHE_FORMAT_VERSION)
+    return FALSE;
+
+  if (cached_layout_mode !=
+      meta_monitor_manager_get_default_layout_mode (monitor_manager))
+    return FALSE;
+
+  if (cached_size != xml_size)
+    return FALSE;
+
+  if (cached_mtime_us != xml_mtime_us &&
+      (!xml_checksum || g_strcmp0 (cached_checksum, xml_checksum) != 0))
+    return FALSE;
+
+  configs = g_hash_table_new_full (meta_monitors_config_key_hash,
+                                   meta_monitors_config_key_equal,
+                                   NULL,
+                                   g_object_unref);
+
+  g_variant_get_child (cache, 5, "a" MONITORS_CONFIG_FORMAT, &configs_iter);
+  while ((config_variant = g_variant_iter_next_value (configs_iter)))
+    {
+      MetaMonitorsConfig *config;
+
+      config = deserialize_monitors_config (config_store, config_variant,
+                                            &error);
+      g_variant_unref (config_variant);
+
+      if (!config)
+        {
+          g_debug ("Discarding monitor configuration cache '%s': %s",
+                   g_file_peek_path (cache_file), error->message);
+          return FALSE;
+        }
+
+      g_hash_table_replace (configs, config->key, config);
+    }
+
+  *out_configs = g_steal_pointer (&configs);
+  return TRUE;
+}
+
+static gboolean
+read_user_config_file (MetaMonitorConfigStore  *config_store,
+                       GFile                   *file,
+                       GHashTable             **out_configs,
+                       GError                 **error)
+{
+  g_autoptr (GFile) cache_file = NULL;
+  g_autofree char *buffer = NULL;
+  g_autofree char *checksum = NULL;
+  g_autoptr (GVariant) cache = NULL;
+  uint64_t xml_size, xml_mtime_us;
+  gboolean has_policy;
+  gsize size;
+
+  config_store->user_configs_cached = FALSE;
+
+  cache_file = meta_monitor_config_store_get_cache_file (file);
+
+  if (!query_file_stamp (file, &xml_size, &xml_mtime_us))
+    return read_config_file (config_store, file,
+                             META_MONITORS_CONFIG_FLAG_NONE,
+                             out_configs,
+                             error);
+
+  if (load_config_cache (config_store, cache_file,
+                         xml_size, xml_mtime_us, NULL,
+                         out_configs))
+    {
+      config_store->user_configs_cached = TRUE;
+      return TRUE;
+    }
+
+  if (!g_file_load_contents (file, NULL, &buffer, &size, NULL, error))
+    return FALSE;
+
+  checksum = g_compute_checksum_for_data (G_CHECKSUM_SHA256,
+                                          (const guchar *) buffer, size);
+
+  if (size == xml_size &&
+      load_config_cache (config_store, cache_file,
+                         xml_size, xml_mtime_us, checksum,
+                         out_configs))
+    {
+      config_store->user_configs_cached = TRUE;
+      return TRUE;
+    }
+
+  if (!parse_config_data (config_store, file, buffer, size,
+                          META_MONITORS_CONFIG_FLAG_NONE,
+                          out_configs, &has_policy,
+                          error))
+    return FALSE;
+
+  if (has_policy)
+    return TRUE;
+
+  cache = serialize_config_cache (config_store,
+                                  serialize_configs (*out_configs),
+                                  size, xml_mtime_us, checksum);
+  write_config_cache (cache_file, cache);
 
   return TRUE;
 }
@@ -1615,6 +2160,41 @@ append_logical_monitor_xml (GString                  *buffer,
   g_string_append (buffer, "    </logicalmonitor>\n");
 }
 
+static char *
+generate_monitors_config_xml (MetaMonitorsConfig *config)
+{
+  GString *buffer;
+  GList *l;
+
+  buffer = g_string_new ("  <configuration>\n");
+
+  if (config->flags & META_MONITORS_CONFIG_FLAG_MIGRATED)
+    g_string_append (buffer, "    <migrated/>\n");
+
+  for (l = config->logical_monitor_configs; l; l = l->next)
+    {
+      MetaLogicalMonitorConfig *logical_monitor_config = l->data;
+
+      append_logical_monitor_xml (buffer, config, logical_monitor_config);
+    }
+
+  if (config->disabled_monitor_specs)
+    {
+      g_string_append (buffer, "    <disabled>\n");
+      for (l = config->disabled_monitor_specs; l; l = l->next)
+        {
+          MetaMonitorSpec *monitor_spec = l->data;
+
+          append_monitor_spec (buffer, monitor_spec, "      ");
+        }
+      g_string_append (buffer, "    </disabled>\n");
+    }
+
+  g_string_append (buffer, "  </configuration>\n");
+
+  return g_string_free (buffer, FALSE);
+}
+
 static GString *
 generate_config_xml (MetaMonitorConfigStore *config_store)
 {
@@ -1629,36 +2209,27 @@ generate_config_xml (MetaMonitorConfigStore *config_store)
   g_hash_table_iter_init (&iter, config_store->configs);
   while (g_hash_table_iter_next (&iter, NULL, (gpointer *) &config))
     {
-      GList *l;
+      const char *config_xml;
 
       if (config->flags & META_MONITORS_CONFIG_FLAG_SYSTEM_CONFIG)
         continue;
 
-      g_string_append (buffer, "  <configuration>\n");
-
-      if (config->flags & META_MONITORS_CONFIG_FLAG_MIGRATED)
-        g_string_append (buffer, "    <migrated/>\n");
-
-      for (l = config->logical_monitor_configs; l; l = l->next)
-        {
-          MetaLogicalMonitorConfig *logical_monitor_config = l->data;
-
-          append_logical_monitor_xml (buffer, config, logical_monitor_config);
-        }
-
-      if (config->disabled_monitor_specs)
+      /*
+       * Configurations are not modified once added to the store, so the XML
+       * of each one is generated once and reused for every following save.
+       */
+      config_xml = g_object_get_qdata (G_OBJECT (config),
+                                       quark_config_xml_fragment);
+      if (!config_xml)
         {
-          g_string_append (buffer, "    <disabled>\n");
-          for (l = config->disabled_monitor_specs; l; l = l->next)
-            {
-              MetaMonitorSpec *monitor_spec = l->data;
-
-              append_monitor_spec (buffer, monitor_spec, "      ");
-            }
-          g_string_append (buffer, "    </disabled>\n");
+          config_xml = generate_monitors_config_xml (config);
+          g_object_set_qdata_full (G_OBJECT (config),
+                                   quark_config_xml_fragment,
+                                   (gpointer) config_xml,
+                                   g_free);
         }
 
-      g_string_append (buffer, "  </configuration>\n");
+      g_string_append (buffer, config_xml);
     }
 
   g_string_append (buffer, "</monitors>\n");
@@ -1670,8 +2241,33 @@ typedef struct _SaveData
 {
   MetaMonitorConfigStore *config_store;
   GString *buffer;
+  GVariant *configs_variant;
 } SaveData;
 
+static void
+update_config_cache (MetaMonitorConfigStore *config_store,
+                     GFile                  *file,
+                     GString                *buffer,
+                     GVariant               *configs_variant)
+{
+  g_autoptr (GFile) cache_file = NULL;
+  g_autoptr (GVariant) cache = NULL;
+  g_autofree char *checksum = NULL;
+  uint64_t xml_size, xml_mtime_us;
+
+  if (!query_file_stamp (file, &xml_size, &xml_mtime_us))
+    return;
+
+  checksum = g_compute_checksum_for_data (G_CHECKSUM_SHA256,
+                                          (const guchar *) buffer->str,
+                                          buffer->len);
+
+  cache_file = meta_monitor_config_store_get_cache_file (file);
+  cache = serialize_config_cache (config_store, configs_variant,
+                                  buffer->len, xml_mtime_us, checksum);
+  write_config_cache (cache_file, cache);
+}
+
 static void
 saved_cb (GObject      *object,
           GAsyncResult *result,
@@ -1693,10 +2289,14 @@ saved_cb (GObject      *object,
   else
     {
       g_clear_object (&data->config_store->save_cancellable);
+
+      update_config_cache (data->config_store, G_FILE (object),
+                           data->buffer, data->configs_variant);
     }
 
   g_clear_object (&data->config_store);
   g_string_free (data->buffer, TRUE);
+  g_variant_unref (data->configs_variant);
   g_free (data);
 }
 
@@ -1766,7 +2366,9 @@ meta_monitor_config_store_save (MetaMonitorConfigStore *config_store)
   data = g_new0 (SaveData, 1);
   *data = (SaveData) {
     .config_store = g_object_ref (config_store),
-    .buffer = buffer
+    .buffer = buffer,
+    .configs_variant =
+      g_variant_ref_sink (serialize_configs (config_store->configs)),
   };
 
   g_file_replace_contents_async (config_store->user_file,
@@ -1850,6 +2452,36 @@ meta_monitor_config_store_set_custom (MetaMonitorConfigStore  *config_store,
   return TRUE;
 }
 
+gboolean
+meta_monitor_config_store_set_custom_user (MetaMonitorConfigStore  *config_store,
+                                           const char              *path,
+                                           GError                 **error)
+{
+  GHashTable *new_configs = NULL;
+
+  g_clear_object (&config_store->user_file);
+  g_clear_object (&config_store->custom_read_file);
+  g_clear_object (&config_store->custom_write_file);
+
+  config_store->user_file = g_file_new_for_path (path);
+
+  if (!read_user_config_file (config_store,
+                              config_store->user_file,
+                              &new_configs,
+                              error))
+    return FALSE;
+
+  g_clear_pointer (&config_store->configs, g_hash_table_unref);
+  config_store->configs = g_steal_pointer (&new_configs);
+  return TRUE;
+}
+
+gboolean
+meta_monitor_config_store_is_user_config_cached (MetaMonitorConfigStore *config_store)
+{
+  return config_store->user_configs_cached;
+}
+
 int
 meta_monitor_config_store_get_config_count (MetaMonitorConfigStore *config_store)
 {
@@ -1965,6 +2597,9 @@ meta_monitor_config_store_class_init (MetaMonitorConfigStoreClass *klass)
   object_class->get_property = meta_monitor_config_store_get_property;
   object_class->set_property = meta_monitor_config_store_set_property;
 
+  quark_config_xml_fragment =
+    g_quark_from_static_string ("meta-monitors-config-xml-fragment");
+
   obj_props[PROP_MONITOR_MANAGER] =
     g_param_spec_object ("monitor-manager",
                          "MetaMonitorManager",
@@ -2049,11 +2684,10 @@ meta_monitor_config_store_reset (MetaMonitorConfigStore *config_store)
 
   if (g_file_test (user_file_path, G_FILE_TEST_EXISTS))
     {
-      if (!read_config_file (config_store,
-                             config_store->user_file,
-                             META_MONITORS_CONFIG_FLAG_NONE,
-                             &user_configs,
-                             &error))
+      if (!read_user_config_file (config_store,
+                                  config_store->user_file,
+                                  &user_configs,
+                                  &error))
         {
           if (error->domain == META_MONITOR_CONFIG_STORE_ERROR &&
               error->code == META_MONITOR_CONFIG_STORE_ERROR_NEEDS_MIGRATION)
@@ -63,6 +63,17 @@ gboolean meta_monitor_config_store_set_custom (MetaMonitorConfigStore  *config_s
                                                MetaMonitorsConfigFlag   flags,
                                                GError                 **error);
 
+META_EXPORT_TEST
+gboolean meta_monitor_config_store_set_custom_user (MetaMonitorConfigStore  *config_store,
+                                                    const char              *path,
+                                                    GError                 **error);
+
+META_EXPORT_TEST
+gboolean meta_monitor_config_store_is_user_config_cached (MetaMonitorConfigStore *config_store);
+
+META_EXPORT_TEST
+GFile * meta_monitor_config_store_get_cache_file (GFile *file);
+
 META_EXPORT_TEST
 GList * meta_monitor_config_store_get_stores_policy (MetaMonitorConfigStore *config_store);
 
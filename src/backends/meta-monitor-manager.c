@@ -689,6 +689,8 @@ meta_monitor_manager_ensure_configured (MetaMonitorManager *manager)
   MetaMonitorsConfigMethod method;
   MetaMonitorsConfigMethod fallback_method =
     META_MONITORS_CONFIG_METHOD_TEMPORARY;
+  gboolean use_candidate_config;
+  gboolean cache_config = FALSE;
 
   use_stored_config = should_use_stored_config (manager);
   if (use_stored_config)
@@ -819,6 +821,41 @@ meta_monitor_manager_ensure_configured (MetaMonitorManager *manager)
       g_clear_object (&config);
     }
 
+  /* Linear configurations are cached per monitor setup once they have
+   * been applied successfully, so that going back to a setup seen before
+   * (e.g. docking and undocking) doesn't have to generate and try them
+   * again. Only generated configurations are cached; the suggested and
+   * previous ones above depend on more than the monitor setup, and are
+   * always preferred. The orientation is handled separately too, so the
+   * cache isn't used when it is managed. */
+  use_candidate_config =
+    !manager->panel_orientation_managed &&
+    !meta_monitor_manager_has_hotplug_mode_update (manager);
+
+  if (use_candidate_config)
+    {
+      config =
+        meta_monitor_config_manager_get_candidate (manager->config_manager);
+      if (config)
+        {
+          config = g_object_ref (config);
+
+          if (meta_monitor_manager_is_config_complete (manager, config) &&
+              meta_monitor_manager_apply_monitors_config (manager,
+                                                          config,
+                                                          method,
+                                                          &error))
+            goto done;
+
+          meta_topic (META_DEBUG_BACKEND,
+                      "Cached monitor configuration no longer applies: %s",
+                      error ? error->message : "incomplete");
+          g_clear_error (&error);
+          g_clear_object (&config);
+          meta_monitor_config_manager_remove_candidate (manager->config_manager);
+        }
+    }
+
   config = meta_monitor_config_manager_create_linear (manager->config_manager);
   if (config)
     {
@@ -834,6 +871,7 @@ meta_monitor_manager_ensure_configured (MetaMonitorManager *manager)
         }
       else
         {
+          cache_config = use_candidate_config;
           goto done;
         }
     }
@@ -867,6 +905,9 @@ done:
       return NULL;
     }
 
+  if (cache_config)
+    meta_monitor_config_manager_add_candidate (manager->config_manager, config);
+
   g_object_unref (config);
 
   return config;
@@ -359,7 +359,7 @@ meta_output_info_parse_edid (MetaOutputInfo *output_info,
   g_return_if_fail (edid);
 
   data = g_bytes_get_data (edid, &len);
-  edid_info = meta_edid_info_new_parse (data);
+  edid_info = meta_edid_info_new_from_bytes (edid);
 
   output_info->edid_checksum_md5 = g_compute_checksum_for_data (G_CHECKSUM_MD5,
                                                                 data, len);
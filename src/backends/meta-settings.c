@@ -75,6 +75,8 @@ struct _MetaSettings
 
   /* A bitmask of MetaXwaylandExtension enum */
   int xwayland_disable_extensions;
+
+  unsigned int xwayland_autoclose_delay;
 };
 
 G_DEFINE_TYPE (MetaSettings, meta_settings, G_TYPE_OBJECT)
@@ -296,6 +298,10 @@ experimental_features_handler (GVariant *features_variant,
         feature = META_EXPERIMENTAL_FEATURE_RT_SCHEDULER;
       else if (g_str_equal (feature_str, "autoclose-xwayland"))
         feature = META_EXPERIMENTAL_FEATURE_AUTOCLOSE_XWAYLAND;
+      else if (g_str_equal (feature_str, "prelaunch-xwayland"))
+        feature = META_EXPERIMENTAL_FEATURE_PRELAUNCH_XWAYLAND;
+      else if (g_str_equal (feature_str, "kms-synchronized-flips"))
+        feature = META_EXPERIMENTAL_FEATURE_KMS_SYNCHRONIZED_FLIPS;
 
       if (feature)
         g_message ("Enabling experimental feature '%s'", feature_str);
@@ -421,6 +427,14 @@ update_xwayland_disable_extensions (MetaSettings *settings)
                           "xwayland-disable-extension");
 }
 
+static void
+update_xwayland_autoclose_delay (MetaSettings *settings)
+{
+  settings->xwayland_autoclose_delay =
+    g_settings_get_uint (settings->wayland_settings,
+                         "xwayland-autoclose-delay");
+}
+
 static void
 update_privacy_settings (MetaSettings *settings)
 {
@@ -447,6 +461,10 @@ wayland_settings_changed (GSettings    *wayland_settings,
     {
       update_xwayland_disable_extensions (settings);
     }
+  else if (g_str_equal (key, "xwayland-autoclose-delay"))
+    {
+      update_xwayland_autoclose_delay (settings);
+    }
 }
 
 void
@@ -470,6 +488,12 @@ meta_settings_get_xwayland_disable_extensions (MetaSettings *settings)
   return (settings->xwayland_disable_extensions);
 }
 
+unsigned int
+meta_settings_get_xwayland_autoclose_delay (MetaSettings *settings)
+{
+  return settings->xwayland_autoclose_delay;
+}
+
 gboolean
 meta_settings_is_privacy_screen_enabled (MetaSettings *settings)
 {
@@ -547,6 +571,7 @@ meta_settings_init (MetaSettings *settings)
   update_xwayland_grab_access_rules (settings);
   update_xwayland_allow_grabs (settings);
   update_xwayland_disable_extensions (settings);
+  update_xwayland_autoclose_delay (settings);
   update_privacy_settings (settings);
 }
 
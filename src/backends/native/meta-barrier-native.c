@@ -42,7 +42,16 @@
 
 struct _MetaBarrierManagerNative
 {
-  GHashTable *barriers;
+  /* Horizontal barriers sorted by their y coordinate, vertical barriers
+   * sorted by their x coordinate, so that motion only needs to be checked
+   * against the barriers it may cross. */
+  GPtrArray *horizontal_barriers;
+  GPtrArray *vertical_barriers;
+
+  /* Barriers not in the active state, i.e. currently interacting with the
+   * pointer. */
+  GPtrArray *engaged_barriers;
+
   GMutex mutex;
 };
 
@@ -118,6 +127,122 @@ is_barrier_blocking_directions (MetaBarrier         *barrier,
   return meta_border_is_blocking_directions (border, border_motion_directions);
 }
 
+static float
+get_barrier_position (MetaBarrierImplNative *self)
+{
+  MetaBorder *border = meta_barrier_get_border (self->barrier);
+
+  if (is_barrier_horizontal (self->barrier))
+    return border->line.a.y;
+  else
+    return border->line.a.x;
+}
+
+static GPtrArray *
+get_barriers_for_axis (MetaBarrierManagerNative *manager,
+                       MetaBarrierImplNative    *self)
+{
+  if (is_barrier_horizontal (self->barrier))
+    return manager->horizontal_barriers;
+  else
+    return manager->vertical_barriers;
+}
+
+/* Returns the index of the first barrier positioned at or after @position. */
+static unsigned int
+find_first_barrier_at (GPtrArray *barriers,
+                       float      position)
+{
+  unsigned int low = 0;
+  unsigned int high = barriers->len;
+
+  while (low < high)
+    {
+      unsigned int mid = low + (high - low) / 2;
+
+      if (get_barrier_position (barriers->pdata[mid]) < position)
+        low = mid + 1;
+      else
+        high = mid;
+    }
+
+  return low;
+}
+
+static void
+add_barrier (MetaBarrierManagerNative *manager,
+             MetaBarrierImplNative    *self)
+{
+  GPtrArray *barriers = get_barriers_for_axis (manager, self);
+  unsigned int index;
+
+  index = find_first_barrier_at (barriers, get_barrier_position (self));
+  g_ptr_array_insert (barriers, index, self);
+}
+
+static void
+remove_barrier (MetaBarrierManagerNative *manager,
+                MetaBarrierImplNative    *self)
+{
+  GPtrArray *barriers = get_barriers_for_axis (manager, self);
+  unsigned int i;
+
+  for (i = find_first_barrier_at (barriers, get_barrier_position (self));
+       i < barriers->len;
+       i++)
+    {
+      if (barriers->pdata[i] == self)
+        {
+          g_ptr_array_remove_index (barriers, i);
+          break;
+        }
+    }
+
+  g_ptr_array_remove_fast (manager->engaged_barriers, self);
+}
+
+typedef void (* MetaBarrierFunc) (MetaBarrierImplNative *self,
+                                  gpointer               user_data);
+
+static void
+foreach_barrier_in_range (GPtrArray       *barriers,
+                          float            position1,
+                          float            position2,
+                          MetaBarrierFunc  func,
+                          gpointer         user_data)
+{
+  float min_position = MIN (position1, position2);
+  float max_position = MAX (position1, position2);
+  unsigned int i;
+
+  for (i = find_first_barrier_at (barriers, min_position);
+       i < barriers->len;
+       i++)
+    {
+      MetaBarrierImplNative *self = barriers->pdata[i];
+
+      if (get_barrier_position (self) > max_position)
+        break;
+
+      func (self, user_data);
+    }
+}
+
+/* Calls @func for every barrier the @motion line could intersect with. */
+static void
+foreach_barrier_crossed_by (MetaBarrierManagerNative *manager,
+                            MetaLine2                *motion,
+                            MetaBarrierFunc           func,
+                            gpointer                  user_data)
+{
+  foreach_barrier_in_range (manager->horizontal_barriers,
+                            motion->a.y, motion->b.y,
+                            func, user_data);
+  foreach_barrier_in_range (manager->vertical_barriers,
+                            motion->a.x, motion->b.x,
+                            func, user_data);
+}
+
 static void
 dismiss_pointer (MetaBarrierImplNative *self)
 {
@@ -167,14 +292,11 @@ is_within_box (MetaLine2   box,
 }
 
 static void
-maybe_release_barrier (gpointer key,
-                       gpointer value,
-                       gpointer user_data)
+maybe_release_barrier (MetaBarrierImplNative *self,
+                       MetaLine2             *motion)
 {
-  MetaBarrierImplNative *self = key;
   MetaBarrier *barrier = self->barrier;
   MetaBorder *border = meta_barrier_get_border (barrier);
-  MetaLine2 *motion = user_data;
   MetaLine2 hit_box;
 
   if (self->state != META_BARRIER_STATE_HELD)
@@ -227,9 +349,10 @@ maybe_release_barriers (MetaBarrierManagerNative *manager,
     },
   };
 
-  g_hash_table_foreach (manager->barriers,
-                        maybe_release_barrier,
-                        &motion);
+  unsigned int i;
+
+  for (i = 0; i < manager->engaged_barriers->len; i++)
+    maybe_release_barrier (manager->engaged_barriers->pdata[i], &motion);
 }
 
 typedef struct _MetaClosestBarrierData
@@ -248,11 +371,9 @@ typedef struct _MetaClosestBarrierData
 } MetaClosestBarrierData;
 
 static void
-update_closest_barrier (gpointer key,
-                        gpointer value,
-                        gpointer user_data)
+update_closest_barrier (MetaBarrierImplNative *self,
+                        gpointer               user_data)
 {
-  MetaBarrierImplNative *self = key;
   MetaBarrier *barrier = self->barrier;
   MetaBorder *border = meta_barrier_get_border (barrier);
   MetaClosestBarrierData *data = user_data;
@@ -320,9 +441,10 @@ get_closest_barrier (MetaBarrierManagerNative *manager,
     },
   };
 
-  g_hash_table_foreach (manager->barriers,
-                        update_closest_barrier,
-                        &closest_barrier_data);
+  foreach_barrier_crossed_by (manager,
+                              &closest_barrier_data.in.motion,
+                              update_closest_barrier,
+                              &closest_barrier_data);
 
   if (closest_barrier_data.out.barrier_impl != NULL)
     {
@@ -441,11 +563,9 @@ emit_barrier_event (MetaBarrierImplNative *self,
 }
 
 static void
-maybe_emit_barrier_event (gpointer key, gpointer value, gpointer user_data)
+maybe_emit_barrier_event (MetaBarrierImplNative *self,
+                          MetaBarrierEventData  *data)
 {
-  MetaBarrierImplNative *self = key;
-  MetaBarrierEventData *data = user_data;
-
   switch (self->state)
     {
     case META_BARRIER_STATE_ACTIVE:
@@ -476,6 +596,9 @@ clamp_to_barrier (MetaBarrierImplNative *self,
   MetaBarrier *barrier = self->barrier;
   MetaBorder *border = meta_barrier_get_border (barrier);
 
+  if (self->state == META_BARRIER_STATE_ACTIVE)
+    g_ptr_array_add (self->manager->engaged_barriers, self);
+
   if (is_barrier_horizontal (barrier))
     {
       if (*motion_dir & META_BARRIER_DIRECTION_POSITIVE_Y)
@@ -505,30 +628,22 @@ clamp_to_barrier (MetaBarrierImplNative *self,
 }
 
 void
-meta_barrier_manager_native_process_in_impl (MetaBarrierManagerNative *manager,
-                                             ClutterInputDevice       *device,
-                                             guint32                   time,
-                                             float                    *x,
-                                             float                    *y)
+meta_barrier_manager_native_process_motion_in_impl (MetaBarrierManagerNative *manager,
+                                                    guint32                   time,
+                                                    float                     prev_x,
+                                                    float                     prev_y,
+                                                    float                    *x,
+                                                    float                    *y)
 {
-  graphene_point_t prev_pos;
-  float prev_x;
-  float prev_y;
   float orig_x = *x;
   float orig_y = *y;
   MetaBarrierDirection motion_dir = 0;
   MetaBarrierEventData barrier_event_data;
   MetaBarrierImplNative *barrier_impl;
-
-  if (!clutter_seat_query_state (clutter_input_device_get_seat (device),
-                                 device, NULL, &prev_pos, NULL))
-    return;
+  unsigned int i;
 
   g_mutex_lock (&manager->mutex);
 
-  prev_x = prev_pos.x;
-  prev_y = prev_pos.y;
-
   /* Get the direction of the motion vector. */
   if (prev_x < *x)
     motion_dir |= META_BARRIER_DIRECTION_POSITIVE_X;
@@ -567,13 +682,37 @@ meta_barrier_manager_native_process_in_impl (MetaBarrierManagerNative *manager,
     .dy = orig_y - prev_y,
   };
 
-  g_hash_table_foreach (manager->barriers,
-                        maybe_emit_barrier_event,
-                        &barrier_event_data);
+  i = manager->engaged_barriers->len;
+  while (i--)
+    {
+      MetaBarrierImplNative *self = manager->engaged_barriers->pdata[i];
+
+      maybe_emit_barrier_event (self, &barrier_event_data);
+      if (self->state == META_BARRIER_STATE_ACTIVE)
+        g_ptr_array_remove_index_fast (manager->engaged_barriers, i);
+    }
 
   g_mutex_unlock (&manager->mutex);
 }
 
+void
+meta_barrier_manager_native_process_in_impl (MetaBarrierManagerNative *manager,
+                                             ClutterInputDevice       *device,
+                                             guint32                   time,
+                                             float                    *x,
+                                             float                    *y)
+{
+  graphene_point_t prev_pos;
+
+  if (!clutter_seat_query_state (clutter_input_device_get_seat (device),
+                                 device, NULL, &prev_pos, NULL))
+    return;
+
+  meta_barrier_manager_native_process_motion_in_impl (manager, time,
+                                                      prev_pos.x, prev_pos.y,
+                                                      x, y);
+}
+
 static gboolean
 meta_barrier_impl_native_is_active (MetaBarrierImpl *impl)
 {
@@ -599,7 +738,7 @@ meta_barrier_impl_native_destroy (MetaBarrierImpl *impl)
   MetaBarrierImplNative *self = META_BARRIER_IMPL_NATIVE (impl);
 
   g_mutex_lock (&self->manager->mutex);
-  g_hash_table_remove (self->manager->barriers, self);
+  remove_barrier (self->manager, self);
   g_mutex_unlock (&self->manager->mutex);
   g_main_context_unref (self->main_context);
   self->is_active = FALSE;
@@ -622,7 +761,7 @@ meta_barrier_impl_native_new (MetaBarrier *barrier)
   manager = meta_seat_native_get_barrier_manager (META_SEAT_NATIVE (seat));
   self->manager = manager;
   g_mutex_lock (&manager->mutex);
-  g_hash_table_add (manager->barriers, self);
+  add_barrier (manager, self);
   g_mutex_unlock (&manager->mutex);
 
   return META_BARRIER_IMPL (self);
@@ -650,7 +789,9 @@ meta_barrier_manager_native_new (void)
 
   manager = g_new0 (MetaBarrierManagerNative, 1);
 
-  manager->barriers = g_hash_table_new (NULL, NULL);
+  manager->horizontal_barriers = g_ptr_array_new ();
+  manager->vertical_barriers = g_ptr_array_new ();
+  manager->engaged_barriers = g_ptr_array_new ();
   g_mutex_init (&manager->mutex);
 
   return manager;
@@ -26,6 +26,7 @@
 #define META_BARRIER_NATIVE_H
 
 #include "backends/meta-barrier-private.h"
+#include "core/util-private.h"
 
 G_BEGIN_DECLS
 
@@ -47,6 +48,14 @@ void meta_barrier_manager_native_process_in_impl (MetaBarrierManagerNative *mana
                                                   float                    *x,
                                                   float                    *y);
 
+META_EXPORT_TEST
+void meta_barrier_manager_native_process_motion_in_impl (MetaBarrierManagerNative *manager,
+                                                         guint32                   time,
+                                                         float                     prev_x,
+                                                         float                     prev_y,
+                                                         float                    *x,
+                                                         float                    *y);
+
 G_END_DECLS
 
 #endif /* META_BARRIER_NATIVE_H */
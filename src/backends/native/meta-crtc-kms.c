@@ -38,6 +38,24 @@
 
 #define ALL_TRANSFORMS_MASK ((1 << META_MONITOR_N_TRANSFORMS) - 1)
 
+typedef struct _MetaPrimaryPlaneConfig
+{
+  uint32_t format;
+  uint64_t modifier;
+  int width;
+  int height;
+  int stride;
+  int mode_width;
+  int mode_height;
+  MetaMonitorTransform transform;
+} MetaPrimaryPlaneConfig;
+
+typedef struct _MetaScanoutTestResult
+{
+  gboolean passed;
+  int n_lookups_left;
+} MetaScanoutTestResult;
+
 struct _MetaCrtcKms
 {
   MetaCrtcNative parent;
@@ -50,6 +68,9 @@ struct _MetaCrtcKms
   GDestroyNotify cursor_renderer_private_destroy_notify;
 
   gboolean is_gamma_valid;
+
+  /* MetaPrimaryPlaneConfig -> MetaScanoutTestResult */
+  GHashTable *scanout_test_results;
 };
 
 static GQuark kms_crtc_crtc_kms_quark;
@@ -272,9 +293,9 @@ meta_crtc_kms_is_hw_cursor_supported (MetaCrtcNative *crtc_native)
   return !!meta_kms_device_get_cursor_plane_for (kms_device, kms_crtc);
 }
 
-void
-meta_crtc_kms_apply_transform (MetaCrtcKms            *crtc_kms,
-                               MetaKmsPlaneAssignment *kms_plane_assignment)
+static gboolean
+get_hw_transform (MetaCrtcKms          *crtc_kms,
+                  MetaMonitorTransform *out_hw_transform)
 {
   MetaCrtc *crtc = META_CRTC (crtc_kms);
   const MetaCrtcConfig *crtc_config;
@@ -286,6 +307,19 @@ meta_crtc_kms_apply_transform (MetaCrtcKms            *crtc_kms,
   if (!is_transform_handled (crtc_kms, hw_transform))
     hw_transform = META_MONITOR_TRANSFORM_NORMAL;
   if (!is_transform_handled (crtc_kms, hw_transform))
+    return FALSE;
+
+  *out_hw_transform = hw_transform;
+  return TRUE;
+}
+
+void
+meta_crtc_kms_apply_transform (MetaCrtcKms            *crtc_kms,
+                               MetaKmsPlaneAssignment *kms_plane_assignment)
+{
+  MetaMonitorTransform hw_transform;
+
+  if (!get_hw_transform (crtc_kms, &hw_transform))
     return;
 
   meta_kms_plane_update_set_rotation (crtc_kms->primary_plane,
@@ -343,6 +377,143 @@ meta_crtc_kms_assign_primary_plane (MetaCrtcKms   *crtc_kms,
   return plane_assignment;
 }
 
+static guint
+primary_plane_config_hash (gconstpointer key)
+{
+  const MetaPrimaryPlaneConfig *config = key;
+  guint hash;
+
+  hash = g_int64_hash (&config->modifier);
+  hash = 31 * hash + config->format;
+  hash = 31 * hash + config->width;
+  hash = 31 * hash + config->height;
+  hash = 31 * hash + config->stride;
+  hash = 31 * hash + config->mode_width;
+  hash = 31 * hash + config->mode_height;
+  hash = 31 * hash + config->transform;
+
+  return hash;
+}
+
+static gboolean
+primary_plane_config_equal (gconstpointer a,
+                            gconstpointer b)
+{
+  const MetaPrimaryPlaneConfig *config_a = a;
+  const MetaPrimaryPlaneConfig *config_b = b;
+
+  return (config_a->format == config_b->format &&
+          config_a->modifier == config_b->modifier &&
+          config_a->width == config_b->width &&
+          config_a->height == config_b->height &&
+          config_a->stride == config_b->stride &&
+          config_a->mode_width == config_b->mode_width &&
+          config_a->mode_height == config_b->mode_height &&
+          config_a->transform == config_b->transform);
+}
+
+static gboolean
+init_primary_plane_config (MetaCrtcKms            *crtc_kms,
+                           MetaDrmBuffer          *buffer,
+                           MetaPrimaryPlaneConfig *config)
+{
+  MetaCrtc *crtc = META_CRTC (crtc_kms);
+  const MetaCrtcConfig *crtc_config;
+  const MetaCrtcModeInfo *crtc_mode_info;
+
+  crtc_config = meta_crtc_get_config (crtc);
+  if (!crtc_config)
+    return FALSE;
+
+  crtc_mode_info = meta_crtc_mode_get_info (crtc_config->mode);
+
+  *config = (MetaPrimaryPlaneConfig) {
+    .format = meta_drm_buffer_get_format (buffer),
+    .modifier = meta_drm_buffer_get_modifier (buffer),
+    .width = meta_drm_buffer_get_width (buffer),
+    .height = meta_drm_buffer_get_height (buffer),
+    .stride = meta_drm_buffer_get_stride (buffer),
+    .mode_width = crtc_mode_info->width,
+    .mode_height = crtc_mode_info->height,
+    .transform = META_MONITOR_TRANSFORM_NORMAL,
+  };
+  get_hw_transform (crtc_kms, &config->transform);
+
+  return TRUE;
+}
+
+/**
+ * meta_crtc_kms_lookup_scanout_test:
+ * @crtc_kms: a #MetaCrtcKms
+ * @buffer: a buffer to be put on the primary plane
+ * @out_passed: (out): whether a test commit passed
+ *
+ * Looks up the result of an earlier test commit of a buffer with the same
+ * format, modifier, size and stride on the primary plane of the CRTC, in its
+ * current mode and transform.
+ *
+ * A failure may be down to something that doesn't last, like the CRTC being
+ * busy or the bandwidth taken by other planes, so failed results are only
+ * returned for %META_CRTC_KMS_SCANOUT_TEST_FAILED_MAX_LOOKUPS lookups, after
+ * which the configuration has to be tested again.
+ *
+ * Returns TRUE if there was a result.
+ */
+gboolean
+meta_crtc_kms_lookup_scanout_test (MetaCrtcKms   *crtc_kms,
+                                   MetaDrmBuffer *buffer,
+                                   gboolean      *out_passed)
+{
+  MetaPrimaryPlaneConfig config;
+  MetaScanoutTestResult *result;
+
+  if (!init_primary_plane_config (crtc_kms, buffer, &config))
+    return FALSE;
+
+  result = g_hash_table_lookup (crtc_kms->scanout_test_results, &config);
+  if (!result)
+    return FALSE;
+
+  if (!result->passed && result->n_lookups_left-- == 0)
+    {
+      g_hash_table_remove (crtc_kms->scanout_test_results, &config);
+      return FALSE;
+    }
+
+  *out_passed = result->passed;
+  return TRUE;
+}
+
+void
+meta_crtc_kms_cache_scanout_test (MetaCrtcKms   *crtc_kms,
+                                  MetaDrmBuffer *buffer,
+                                  gboolean       passed)
+{
+  MetaPrimaryPlaneConfig config;
+  MetaScanoutTestResult *result;
+
+  if (!init_primary_plane_config (crtc_kms, buffer, &config))
+    return;
+
+  result = g_new0 (MetaScanoutTestResult, 1);
+  result->passed = passed;
+  result->n_lookups_left = META_CRTC_KMS_SCANOUT_TEST_FAILED_MAX_LOOKUPS;
+
+  g_hash_table_replace (crtc_kms->scanout_test_results,
+                        g_memdup2 (&config, sizeof (config)),
+                        result);
+}
+
+/*
+ * Results only hold for the mode they were tested with. Hotplugs recreate
+ * the MetaCrtcKms objects, which drops them too.
+ */
+void
+meta_crtc_kms_invalidate_scanout_tests (MetaCrtcKms *crtc_kms)
+{
+  g_hash_table_remove_all (crtc_kms->scanout_test_results);
+}
+
 static GList *
 generate_crtc_connector_list (MetaGpu  *gpu,
                               MetaCrtc *crtc)
@@ -414,6 +585,8 @@ meta_crtc_kms_set_mode (MetaCrtcKms   *crtc_kms,
   GList *connectors;
   MetaKmsMode *kms_mode;
 
+  meta_crtc_kms_invalidate_scanout_tests (crtc_kms);
+
   connectors = generate_crtc_connector_list (gpu, crtc);
 
   if (connectors)
@@ -549,6 +722,7 @@ meta_crtc_kms_dispose (GObject *object)
 
   g_clear_pointer (&crtc_kms->cursor_renderer_private,
                    crtc_kms->cursor_renderer_private_destroy_notify);
+  g_clear_pointer (&crtc_kms->scanout_test_results, g_hash_table_unref);
 
   G_OBJECT_CLASS (meta_crtc_kms_parent_class)->dispose (object);
 }
@@ -556,6 +730,10 @@ meta_crtc_kms_dispose (GObject *object)
 static void
 meta_crtc_kms_init (MetaCrtcKms *crtc_kms)
 {
+  crtc_kms->scanout_test_results =
+    g_hash_table_new_full (primary_plane_config_hash,
+                           primary_plane_config_equal,
+                           g_free, g_free);
 }
 
 static void
@@ -34,6 +34,9 @@
 #include "backends/native/meta-kms-crtc.h"
 #include "backends/native/meta-kms-update.h"
 
+/* About a second at 60 Hz */
+#define META_CRTC_KMS_SCANOUT_TEST_FAILED_MAX_LOOKUPS 60
+
 #define META_TYPE_CRTC_KMS (meta_crtc_kms_get_type ())
 META_EXPORT_TEST
 G_DECLARE_FINAL_TYPE (MetaCrtcKms, meta_crtc_kms,
@@ -53,9 +56,23 @@ MetaKmsPlaneAssignment * meta_crtc_kms_assign_primary_plane (MetaCrtcKms   *crtc
                                                              MetaDrmBuffer *buffer,
                                                              MetaKmsUpdate *kms_update);
 
+META_EXPORT_TEST
 void meta_crtc_kms_set_mode (MetaCrtcKms   *crtc_kms,
                              MetaKmsUpdate *kms_update);
 
+META_EXPORT_TEST
+gboolean meta_crtc_kms_lookup_scanout_test (MetaCrtcKms   *crtc_kms,
+                                            MetaDrmBuffer *buffer,
+                                            gboolean      *out_passed);
+
+META_EXPORT_TEST
+void meta_crtc_kms_cache_scanout_test (MetaCrtcKms   *crtc_kms,
+                                       MetaDrmBuffer *buffer,
+                                       gboolean       passed);
+
+META_EXPORT_TEST
+void meta_crtc_kms_invalidate_scanout_tests (MetaCrtcKms *crtc_kms);
+
 void meta_crtc_kms_set_is_underscanning (MetaCrtcKms *crtc_kms,
                                          gboolean     is_underscanning);
 
@@ -77,6 +94,7 @@ void meta_crtc_kms_invalidate_gamma (MetaCrtcKms *crtc_kms);
 void meta_crtc_kms_maybe_set_gamma (MetaCrtcKms   *crtc_kms,
                                     MetaKmsDevice *kms_device);
 
+META_EXPORT_TEST
 MetaCrtcKms * meta_crtc_kms_from_kms_crtc (MetaKmsCrtc *kms_crtc);
 
 MetaCrtcKms * meta_crtc_kms_new (MetaGpuKms  *gpu_kms,
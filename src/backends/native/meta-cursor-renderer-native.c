@@ -58,6 +58,11 @@
 #include "wayland/meta-wayland-buffer.h"
 #endif
 
+/* Number of prepared cursor buffers kept around per GPU. Enough to cover the
+ * usual set of theme cursors (pointer, text, hand, resize edges, busy
+ * animation frames) at a couple of scales and transforms. */
+#define MAX_CACHED_CURSOR_BUFFERS 32
+
 static GQuark quark_cursor_sprite = 0;
 
 typedef struct _CrtcCursorData
@@ -83,12 +88,26 @@ struct _MetaCursorRendererNativePrivate
 };
 typedef struct _MetaCursorRendererNativePrivate MetaCursorRendererNativePrivate;
 
+typedef struct _MetaCursorBufferKey
+{
+  GBytes *pixels;
+  int width;
+  int height;
+  float scale;
+  MetaMonitorTransform transform;
+  uint32_t format;
+} MetaCursorBufferKey;
+
 typedef struct _MetaCursorRendererNativeGpuData
 {
   gboolean hw_cursor_broken;
 
   uint64_t cursor_width;
   uint64_t cursor_height;
+
+  /* MetaCursorBufferKey -> MetaDrmBuffer, most recently used first in lru */
+  GHashTable *buffer_cache;
+  GQueue buffer_cache_lru;
 } MetaCursorRendererNativeGpuData;
 
 typedef struct _MetaCursorNativeGpuState
@@ -149,16 +168,136 @@ meta_cursor_renderer_native_gpu_data_from_gpu (MetaGpuKms *gpu_kms)
                              quark_cursor_renderer_native_gpu_data);
 }
 
+static MetaCursorBufferKey *
+cursor_buffer_key_new (uint8_t              *pixels,
+                       int                   width,
+                       int                   height,
+                       int                   rowstride,
+                       float                 scale,
+                       MetaMonitorTransform  transform,
+                       uint32_t              format)
+{
+  MetaCursorBufferKey *key;
+  uint8_t *packed_pixels;
+  int i;
+
+  packed_pixels = g_malloc (width * height * 4);
+  for (i = 0; i < height; i++)
+    memcpy (packed_pixels + i * width * 4, pixels + i * rowstride, width * 4);
+
+  key = g_new0 (MetaCursorBufferKey, 1);
+  key->pixels = g_bytes_new_take (packed_pixels, width * height * 4);
+  key->width = width;
+  key->height = height;
+  key->scale = scale;
+  key->transform = transform;
+  key->format = format;
+
+  return key;
+}
+
+static void
+cursor_buffer_key_free (MetaCursorBufferKey *key)
+{
+  g_bytes_unref (key->pixels);
+  g_free (key);
+}
+
+static unsigned int
+cursor_buffer_key_hash (gconstpointer data)
+{
+  const MetaCursorBufferKey *key = data;
+
+  return (g_bytes_hash (key->pixels) ^
+          (key->width << 16 | key->height) ^
+          (key->transform << 24) ^
+          key->format);
+}
+
+static gboolean
+cursor_buffer_key_equal (gconstpointer a,
+                         gconstpointer b)
+{
+  const MetaCursorBufferKey *key_a = a;
+  const MetaCursorBufferKey *key_b = b;
+
+  return (key_a->width == key_b->width &&
+          key_a->height == key_b->height &&
+          key_a->scale == key_b->scale &&
+          key_a->transform == key_b->transform &&
+          key_a->format == key_b->format &&
+          g_bytes_equal (key_a->pixels, key_b->pixels));
+}
+
+static void
+clear_cursor_buffer_cache (MetaCursorRendererNativeGpuData *cursor_renderer_gpu_data)
+{
+  g_queue_clear (&cursor_renderer_gpu_data->buffer_cache_lru);
+  g_hash_table_remove_all (cursor_renderer_gpu_data->buffer_cache);
+}
+
+static MetaDrmBuffer *
+lookup_cached_cursor_buffer (MetaCursorRendererNativeGpuData *cursor_renderer_gpu_data,
+                             MetaCursorBufferKey             *key)
+{
+  MetaCursorBufferKey *cached_key;
+  MetaDrmBuffer *buffer;
+
+  if (!g_hash_table_lookup_extended (cursor_renderer_gpu_data->buffer_cache,
+                                     key,
+                                     (gpointer *) &cached_key,
+                                     (gpointer *) &buffer))
+    return NULL;
+
+  g_queue_remove (&cursor_renderer_gpu_data->buffer_cache_lru, cached_key);
+  g_queue_push_head (&cursor_renderer_gpu_data->buffer_cache_lru, cached_key);
+
+  return buffer;
+}
+
+static void
+cache_cursor_buffer (MetaCursorRendererNativeGpuData *cursor_renderer_gpu_data,
+                     MetaCursorBufferKey             *key,
+                     MetaDrmBuffer                   *buffer)
+{
+  while (g_queue_get_length (&cursor_renderer_gpu_data->buffer_cache_lru) >=
+         MAX_CACHED_CURSOR_BUFFERS)
+    {
+      MetaCursorBufferKey *oldest_key;
+
+      oldest_key = g_queue_pop_tail (&cursor_renderer_gpu_data->buffer_cache_lru);
+      g_hash_table_remove (cursor_renderer_gpu_data->buffer_cache, oldest_key);
+    }
+
+  g_hash_table_insert (cursor_renderer_gpu_data->buffer_cache,
+                       key, g_object_ref (buffer));
+  g_queue_push_head (&cursor_renderer_gpu_data->buffer_cache_lru, key);
+}
+
+static void
+cursor_renderer_gpu_data_free (MetaCursorRendererNativeGpuData *cursor_renderer_gpu_data)
+{
+  g_queue_clear (&cursor_renderer_gpu_data->buffer_cache_lru);
+  g_hash_table_destroy (cursor_renderer_gpu_data->buffer_cache);
+  g_free (cursor_renderer_gpu_data);
+}
+
 static MetaCursorRendererNativeGpuData *
 meta_create_cursor_renderer_native_gpu_data (MetaGpuKms *gpu_kms)
 {
   MetaCursorRendererNativeGpuData *cursor_renderer_gpu_data;
 
   cursor_renderer_gpu_data = g_new0 (MetaCursorRendererNativeGpuData, 1);
+  cursor_renderer_gpu_data->buffer_cache =
+    g_hash_table_new_full (cursor_buffer_key_hash,
+                           cursor_buffer_key_equal,
+                           (GDestroyNotify) cursor_buffer_key_free,
+                           g_object_unref);
+  g_queue_init (&cursor_renderer_gpu_data->buffer_cache_lru);
   g_object_set_qdata_full (G_OBJECT (gpu_kms),
                            quark_cursor_renderer_native_gpu_data,
                            cursor_renderer_gpu_data,
-                           g_free);
+                           (GDestroyNotify) cursor_renderer_gpu_data_free);
 
   return cursor_renderer_gpu_data;
 }
@@ -453,6 +592,7 @@ disable_hw_cursor_for_gpu (MetaGpuKms   *gpu_kms,
              "using OpenGL from now on",
              error->message);
   cursor_renderer_gpu_data->hw_cursor_broken = TRUE;
+  clear_cursor_buffer_cache (cursor_renderer_gpu_data);
 }
 
 static void
@@ -1267,10 +1407,9 @@ create_cursor_drm_buffer (MetaGpuKms      *gpu_kms,
     }
 }
 
-static void
+static MetaDrmBuffer *
 load_cursor_sprite_gbm_buffer_for_gpu (MetaCursorRendererNative *native,
                                        MetaGpuKms               *gpu_kms,
-                                       MetaCursorSprite         *cursor_sprite,
                                        uint8_t                  *pixels,
                                        uint                      width,
                                        uint                      height,
@@ -1291,7 +1430,7 @@ load_cursor_sprite_gbm_buffer_for_gpu (MetaCursorRendererNative *native,
   cursor_renderer_gpu_data =
     meta_cursor_renderer_native_gpu_data_from_gpu (gpu_kms);
   if (!cursor_renderer_gpu_data)
-    return;
+    return NULL;
 
   cursor_width = (uint64_t) cursor_renderer_gpu_data->cursor_width;
   cursor_height = (uint64_t) cursor_renderer_gpu_data->cursor_height;
@@ -1300,7 +1439,7 @@ load_cursor_sprite_gbm_buffer_for_gpu (MetaCursorRendererNative *native,
     {
       meta_warning ("Invalid theme cursor size (must be at most %ux%u)",
                     (unsigned int)cursor_width, (unsigned int)cursor_height);
-      return;
+      return NULL;
     }
 
   device_file = meta_device_pool_open (device_pool,
@@ -1313,7 +1452,7 @@ load_cursor_sprite_gbm_buffer_for_gpu (MetaCursorRendererNative *native,
                  meta_gpu_kms_get_file_path (gpu_kms),
                  error->message);
       disable_hw_cursor_for_gpu (gpu_kms, error);
-      return;
+      return NULL;
     }
 
   buffer = create_cursor_drm_buffer (gpu_kms, device_file,
@@ -1327,10 +1466,10 @@ load_cursor_sprite_gbm_buffer_for_gpu (MetaCursorRendererNative *native,
     {
       g_warning ("Realizing HW cursor failed: %s", error->message);
       disable_hw_cursor_for_gpu (gpu_kms, error);
-      return;
+      return NULL;
     }
 
-  set_cursor_sprite_buffer (cursor_sprite, gpu_kms, buffer);
+  return buffer;
 }
 
 static gboolean
@@ -1438,6 +1577,31 @@ load_scaled_and_transformed_cursor_sprite (MetaCursorRendererNative *native,
                                            int                       rowstride,
                                            uint32_t                  gbm_format)
 {
+  MetaCursorRendererNativeGpuData *cursor_renderer_gpu_data;
+  MetaCursorBufferKey *key;
+  MetaDrmBuffer *buffer;
+
+  cursor_renderer_gpu_data =
+    meta_cursor_renderer_native_gpu_data_from_gpu (gpu_kms);
+  if (!cursor_renderer_gpu_data)
+    return;
+
+  /* Cursor sprites are recreated whenever the pointer changes shape, e.g.
+   * when hovering a link, so key the prepared buffers on the source pixels
+   * rather than on the sprite; that way switching back and forth between
+   * theme cursors doesn't scale, allocate and upload the same image again. */
+  key = cursor_buffer_key_new (data, width, height, rowstride,
+                               relative_scale, relative_transform,
+                               gbm_format);
+  buffer = lookup_cached_cursor_buffer (cursor_renderer_gpu_data, key);
+  if (buffer)
+    {
+      cursor_buffer_key_free (key);
+      set_cursor_sprite_buffer (cursor_sprite, gpu_kms,
+                                g_object_ref (buffer));
+      return;
+    }
+
   if (!G_APPROX_VALUE (relative_scale, 1.f, FLT_EPSILON) ||
       relative_transform != META_MONITOR_TRANSFORM_NORMAL)
     {
@@ -1450,28 +1614,36 @@ load_scaled_and_transformed_cursor_sprite (MetaCursorRendererNative *native,
                                                        relative_scale,
                                                        relative_transform);
 
-      load_cursor_sprite_gbm_buffer_for_gpu (native,
-                                             gpu_kms,
-                                             cursor_sprite,
-                                             cairo_image_surface_get_data (surface),
-                                             cairo_image_surface_get_width (surface),
-                                             cairo_image_surface_get_width (surface),
-                                             cairo_image_surface_get_stride (surface),
-                                             gbm_format);
+      buffer =
+        load_cursor_sprite_gbm_buffer_for_gpu (native,
+                                               gpu_kms,
+                                               cairo_image_surface_get_data (surface),
+                                               cairo_image_surface_get_width (surface),
+                                               cairo_image_surface_get_width (surface),
+                                               cairo_image_surface_get_stride (surface),
+                                               gbm_format);
 
       cairo_surface_destroy (surface);
     }
   else
     {
-      load_cursor_sprite_gbm_buffer_for_gpu (native,
-                                             gpu_kms,
-                                             cursor_sprite,
-                                             data,
-                                             width,
-                                             height,
-                                             rowstride,
-                                             gbm_format);
+      buffer = load_cursor_sprite_gbm_buffer_for_gpu (native,
+                                                      gpu_kms,
+                                                      data,
+                                                      width,
+                                                      height,
+                                                      rowstride,
+                                                      gbm_format);
+    }
+
+  if (!buffer)
+    {
+      cursor_buffer_key_free (key);
+      return;
     }
+
+  cache_cursor_buffer (cursor_renderer_gpu_data, key, buffer);
+  set_cursor_sprite_buffer (cursor_sprite, gpu_kms, buffer);
 }
 
 #ifdef HAVE_WAYLAND
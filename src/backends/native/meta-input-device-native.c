@@ -249,7 +249,8 @@ trigger_slow_keys (gpointer data)
 
   /* Alter timestamp and emit the event */
   key_event->time = us2ms (g_get_monotonic_time ());
-  _clutter_event_push (slow_keys_event->event, TRUE);
+  meta_seat_impl_queue_event_in_impl (device->seat_impl,
+                                      clutter_event_copy (slow_keys_event->event));
 
   /* Then remote the pending event */
   device->slow_keys_list = g_list_remove (device->slow_keys_list, slow_keys_event);
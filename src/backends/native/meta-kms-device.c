@@ -555,6 +555,9 @@ meta_kms_device_new (MetaKms            *kms,
   if (device->caps.addfb2_modifiers)
     device->flags |= META_KMS_DEVICE_FLAG_HAS_ADDFB2;
 
+  if (META_IS_KMS_IMPL_DEVICE_ATOMIC (device->impl_device))
+    device->flags |= META_KMS_DEVICE_FLAG_ATOMIC;
+
   return device;
 }
 
@@ -137,12 +137,22 @@ uint64_t meta_kms_update_get_sequence_number (MetaKmsUpdate *update);
 META_EXPORT_TEST
 MetaKmsDevice * meta_kms_update_get_device (MetaKmsUpdate *update);
 
+META_EXPORT_TEST
 gboolean meta_kms_update_includes_crtc (MetaKmsUpdate *update,
                                         MetaKmsCrtc   *crtc);
 
+META_EXPORT_TEST
 void meta_kms_update_include_crtc (MetaKmsUpdate *update,
                                    MetaKmsCrtc   *crtc);
 
+META_EXPORT_TEST
+void meta_kms_update_merge_from (MetaKmsUpdate *update,
+                                 MetaKmsUpdate *other_update);
+
+META_EXPORT_TEST
+MetaKmsUpdate * meta_kms_update_split_crtc (MetaKmsUpdate *update,
+                                            MetaKmsCrtc   *crtc);
+
 void meta_kms_plane_assignment_set_rotation (MetaKmsPlaneAssignment *plane_assignment,
                                              MetaKmsPlaneRotation    rotation);
 
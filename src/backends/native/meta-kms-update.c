@@ -725,6 +725,151 @@ meta_kms_update_include_crtc (MetaKmsUpdate *update,
   g_hash_table_add (update->crtcs, crtc);
 }
 
+/*
+ * Moves everything from @other_update into @update and frees @other_update.
+ * The two updates must be for the same device and touch different CRTCs.
+ */
+void
+meta_kms_update_merge_from (MetaKmsUpdate *update,
+                            MetaKmsUpdate *other_update)
+{
+  GHashTableIter iter;
+  gpointer crtc;
+  GList *l;
+
+  g_assert (update != other_update);
+  g_assert (update->device == other_update->device);
+  g_assert (!update->is_locked);
+  g_assert (!other_update->is_locked);
+  g_assert (!update->custom_page_flip);
+  g_assert (!other_update->custom_page_flip);
+
+  g_hash_table_iter_init (&iter, other_update->crtcs);
+  while (g_hash_table_iter_next (&iter, &crtc, NULL))
+    g_hash_table_add (update->crtcs, crtc);
+
+  for (l = other_update->plane_assignments; l; l = l->next)
+    {
+      MetaKmsPlaneAssignment *plane_assignment = l->data;
+
+      plane_assignment->update = update;
+    }
+
+  update->plane_assignments =
+    g_list_concat (update->plane_assignments,
+                   g_steal_pointer (&other_update->plane_assignments));
+  update->mode_sets =
+    g_list_concat (update->mode_sets,
+                   g_steal_pointer (&other_update->mode_sets));
+  update->connector_updates =
+    g_list_concat (update->connector_updates,
+                   g_steal_pointer (&other_update->connector_updates));
+  update->crtc_gammas =
+    g_list_concat (update->crtc_gammas,
+                   g_steal_pointer (&other_update->crtc_gammas));
+  update->page_flip_listeners =
+    g_list_concat (update->page_flip_listeners,
+                   g_steal_pointer (&other_update->page_flip_listeners));
+  update->result_listeners =
+    g_list_concat (update->result_listeners,
+                   g_steal_pointer (&other_update->result_listeners));
+
+  meta_kms_update_free (other_update);
+}
+
+static MetaKmsCrtc *
+get_plane_assignment_crtc (gpointer entry)
+{
+  return ((MetaKmsPlaneAssignment *) entry)->crtc;
+}
+
+static MetaKmsCrtc *
+get_mode_set_crtc (gpointer entry)
+{
+  return ((MetaKmsModeSet *) entry)->crtc;
+}
+
+static MetaKmsCrtc *
+get_crtc_gamma_crtc (gpointer entry)
+{
+  return ((MetaKmsCrtcGamma *) entry)->crtc;
+}
+
+static MetaKmsCrtc *
+get_page_flip_listener_crtc (gpointer entry)
+{
+  return ((MetaKmsPageFlipListener *) entry)->crtc;
+}
+
+static GList *
+steal_entries_for_crtc (GList         **entries,
+                        MetaKmsCrtc    *crtc,
+                        MetaKmsCrtc * (* get_crtc) (gpointer entry))
+{
+  GList *stolen_entries = NULL;
+  GList *l;
+
+  l = *entries;
+  while (l)
+    {
+      GList *l_next = l->next;
+
+      if (get_crtc (l->data) == crtc)
+        {
+          *entries = g_list_remove_link (*entries, l);
+          stolen_entries = g_list_concat (stolen_entries, l);
+        }
+
+      l = l_next;
+    }
+
+  return stolen_entries;
+}
+
+/*
+ * The reverse of meta_kms_update_merge_from(); moves everything of @update
+ * that is for @crtc into a new update. Connector updates and result
+ * listeners are not tied to a CRTC and stay in @update.
+ */
+MetaKmsUpdate *
+meta_kms_update_split_crtc (MetaKmsUpdate *update,
+                            MetaKmsCrtc   *crtc)
+{
+  MetaKmsUpdate *crtc_update;
+  GList *l;
+
+  g_assert (!update->is_locked);
+  g_assert (!update->custom_page_flip);
+  g_assert (meta_kms_crtc_get_device (crtc) == update->device);
+
+  crtc_update = meta_kms_update_new (update->device);
+
+  if (g_hash_table_remove (update->crtcs, crtc))
+    g_hash_table_add (crtc_update->crtcs, crtc);
+
+  crtc_update->plane_assignments =
+    steal_entries_for_crtc (&update->plane_assignments, crtc,
+                            get_plane_assignment_crtc);
+  for (l = crtc_update->plane_assignments; l; l = l->next)
+    {
+      MetaKmsPlaneAssignment *plane_assignment = l->data;
+
+      plane_assignment->update = crtc_update;
+    }
+
+  crtc_update->mode_sets =
+    steal_entries_for_crtc (&update->mode_sets, crtc,
+                            get_mode_set_crtc);
+  crtc_update->crtc_gammas =
+    steal_entries_for_crtc (&update->crtc_gammas, crtc,
+                            get_crtc_gamma_crtc);
+  crtc_update->page_flip_listeners =
+    steal_entries_for_crtc (&update->page_flip_listeners, crtc,
+                            get_page_flip_listener_crtc);
+
+  return crtc_update;
+}
+
 MetaKmsCustomPageFlip *
 meta_kms_update_take_custom_page_flip_func (MetaKmsUpdate *update)
 {
@@ -81,12 +81,14 @@ typedef struct _MetaKmsPlaneFeedback
 typedef void (* MetaKmsResultListenerFunc) (const MetaKmsFeedback *feedback,
                                             gpointer               user_data);
 
+META_EXPORT_TEST
 void meta_kms_feedback_free (MetaKmsFeedback *feedback);
 
 MetaKmsFeedbackResult meta_kms_feedback_get_result (const MetaKmsFeedback *feedback);
 
 GList * meta_kms_feedback_get_failed_planes (const MetaKmsFeedback *feedback);
 
+META_EXPORT_TEST
 const GError * meta_kms_feedback_get_error (const MetaKmsFeedback *feedback);
 
 META_EXPORT_TEST
@@ -348,6 +348,123 @@ meta_kms_post_pending_update_for_crtc_sync (MetaKms           *kms,
   return meta_kms_post_update_sync (kms, update, flags);
 }
 
+static void
+notify_result_listeners (GList                 *result_listeners,
+                         const MetaKmsFeedback *feedback)
+{
+  GList *l;
+
+  for (l = result_listeners; l; l = l->next)
+    {
+      MetaKmsResultListener *listener = l->data;
+
+      meta_kms_result_listener_notify (listener, feedback);
+      meta_kms_result_listener_free (listener);
+    }
+  g_list_free (result_listeners);
+}
+
+MetaKmsFeedback *
+meta_kms_post_pending_updates_for_crtcs_sync (MetaKms           *kms,
+                                              GList             *crtcs,
+                                              MetaKmsUpdateFlag  flags)
+{
+  MetaKmsUpdate *update = NULL;
+  g_autoptr (GList) update_crtcs = NULL;
+  g_autoptr (GList) crtc_updates = NULL;
+  MetaKmsDevice *device;
+  MetaKmsFeedback *feedback;
+  GList *l;
+
+  for (l = crtcs; l; l = l->next)
+    {
+      MetaKmsCrtc *crtc = l->data;
+      MetaKmsUpdate *crtc_update;
+
+      crtc_update = meta_kms_take_pending_update_for_crtc (kms, crtc);
+      if (!crtc_update)
+        continue;
+
+      update_crtcs = g_list_append (update_crtcs, crtc);
+
+      if (!update)
+        update = crtc_update;
+      else
+        meta_kms_update_merge_from (update, crtc_update);
+    }
+
+  if (!update)
+    return NULL;
+
+  if (!update_crtcs->next)
+    return meta_kms_post_update_sync (kms, update, flags);
+
+  device = meta_kms_update_get_device (update);
+
+  meta_topic (META_DEBUG_KMS,
+              "Posting update %" G_GUINT64_FORMAT " for %u CRTCs on %s",
+              meta_kms_update_get_sequence_number (update),
+              g_list_length (update_crtcs),
+              meta_kms_device_get_path (device));
+
+  /* Keep the merged update if committing it fails, e.g. because one of the
+   * CRTCs is still busy, so that it can be split up again and only the CRTCs
+   * at fault lose their frame. */
+  meta_kms_update_lock (update);
+  feedback =
+    meta_kms_device_process_update_sync (device, update,
+                                         flags |
+                                         META_KMS_UPDATE_FLAG_PRESERVE_ON_ERROR);
+  meta_kms_update_unlock (update);
+
+  if (!feedback->error)
+    {
+      notify_result_listeners (meta_kms_update_take_result_listeners (update),
+                               feedback);
+      meta_kms_update_free (update);
+      return feedback;
+    }
+
+  meta_topic (META_DEBUG_KMS,
+              "Update %" G_GUINT64_FORMAT " failed (%s), posting it per CRTC",
+              meta_kms_update_get_sequence_number (update),
+              feedback->error->message);
+
+  g_clear_pointer (&feedback, meta_kms_feedback_free);
+
+  for (l = update_crtcs->next; l; l = l->next)
+    {
+      MetaKmsCrtc *crtc = l->data;
+
+      crtc_updates = g_list_prepend (crtc_updates,
+                                     meta_kms_update_split_crtc (update, crtc));
+    }
+
+  /* What isn't tied to a CRTC stays with the first one */
+  crtc_updates = g_list_prepend (crtc_updates, update);
+
+  for (l = crtc_updates; l; l = l->next)
+    {
+      MetaKmsUpdate *crtc_update = l->data;
+      MetaKmsFeedback *crtc_feedback;
+
+      crtc_feedback = meta_kms_post_update_sync (kms, crtc_update, flags);
+
+      /* Report the first failure, if any */
+      if (!feedback || (!feedback->error && crtc_feedback->error))
+        {
+          g_clear_pointer (&feedback, meta_kms_feedback_free);
+          feedback = crtc_feedback;
+        }
+      else
+        {
+          meta_kms_feedback_free (crtc_feedback);
+        }
+    }
+
+  return feedback;
+}
+
 static MetaKmsFeedback *
 meta_kms_post_update_sync (MetaKms           *kms,
                            MetaKmsUpdate     *update,
@@ -356,7 +473,6 @@ meta_kms_post_update_sync (MetaKms           *kms,
   MetaKmsDevice *device = meta_kms_update_get_device (update);
   MetaKmsFeedback *feedback;
   GList *result_listeners;
-  GList *l;
 
   COGL_TRACE_BEGIN_SCOPED (MetaKmsPostUpdateSync,
                            "KMS (post update)");
@@ -390,14 +506,7 @@ meta_kms_post_update_sync (MetaKms           *kms,
       meta_kms_update_free (update);
     }
 
-  for (l = result_listeners; l; l = l->next)
-    {
-      MetaKmsResultListener *listener = l->data;
-
-      meta_kms_result_listener_notify (listener, feedback);
-      meta_kms_result_listener_free (listener);
-    }
-  g_list_free (result_listeners);
+  notify_result_listeners (result_listeners, feedback);
 
   return feedback;
 }
@@ -39,12 +39,14 @@ void meta_kms_discard_pending_updates (MetaKms *kms);
 MetaKmsUpdate * meta_kms_ensure_pending_update (MetaKms       *kms,
                                                 MetaKmsDevice *device);
 
+META_EXPORT_TEST
 MetaKmsUpdate * meta_kms_ensure_pending_update_for_crtc (MetaKms     *kms,
                                                          MetaKmsCrtc *crtc);
 
 MetaKmsUpdate * meta_kms_get_pending_update (MetaKms       *kms,
                                              MetaKmsDevice *device);
 
+META_EXPORT_TEST
 MetaKmsUpdate * meta_kms_get_pending_update_for_crtc (MetaKms     *kms,
                                                       MetaKmsCrtc *crtc);
 
@@ -59,6 +61,11 @@ MetaKmsFeedback * meta_kms_post_pending_update_for_crtc_sync (MetaKms
                                                               MetaKmsCrtc       *device,
                                                               MetaKmsUpdateFlag  flags);
 
+META_EXPORT_TEST
+MetaKmsFeedback * meta_kms_post_pending_updates_for_crtcs_sync (MetaKms           *kms,
+                                                                GList             *crtcs,
+                                                                MetaKmsUpdateFlag  flags);
+
 void meta_kms_discard_pending_page_flips (MetaKms *kms);
 
 void meta_kms_notify_modes_set (MetaKms *kms);
@@ -48,6 +48,9 @@
 #include "backends/native/meta-renderer-native-gles3.h"
 #include "backends/native/meta-renderer-native-private.h"
 
+/* Limit the number of individual copies to a secondary GPU buffer */
+#define MAX_COPY_RECTS 16
+
 typedef enum _MetaSharedFramebufferImportStatus
 {
   /* Not tried importing yet. */
@@ -73,6 +76,17 @@ typedef struct _MetaOnscreenNativeSecondaryGpuState
     MetaDrmBufferDumb *current_dumb_fb;
     MetaDrmBufferDumb *dumb_fbs[3];
     MetaDrmBuffer *source_fbs[3];
+    /* Damage accumulated since each dumb buffer was last copied to; NULL
+     * means the whole buffer must be copied. */
+    cairo_region_t *damage[3];
+
+    /* Read back pixels are written into a dumb buffer off the main
+     * thread. Each copy in flight owns its staging buffer, and finished
+     * ones are kept here for reuse. */
+    GList *free_staging_data;
+    size_t staging_size;
+    GCancellable *copy_cancellable;
+    unsigned int n_copies_in_flight;
   } cpu;
 
   gboolean noted_primary_gpu_copy_ok;
@@ -80,6 +94,22 @@ typedef struct _MetaOnscreenNativeSecondaryGpuState
   MetaSharedFramebufferImportStatus import_status;
 } MetaOnscreenNativeSecondaryGpuState;
 
+/* Double buffered, which is as many copies as can be in flight with the
+ * frames the frame clock lets be pending at once. */
+#define SECONDARY_GPU_MAX_FREE_STAGING_DATA 2
+
+typedef struct _SecondaryGpuCpuCopy
+{
+  CoglOnscreen *onscreen;
+  MetaOnscreenNativeSecondaryGpuState *secondary_gpu_state;
+  MetaDrmBufferDumb *buffer_dumb;
+  uint8_t *staging_data;
+  size_t staging_size;
+  cairo_region_t *region;
+  int stride;
+  int bpp;
+} SecondaryGpuCpuCopy;
+
 struct _MetaOnscreenNative
 {
   CoglOnscreenEgl parent;
@@ -541,10 +571,18 @@ secondary_gpu_release_dumb (MetaOnscreenNativeSecondaryGpuState *secondary_gpu_s
 {
   unsigned i;
 
+  /* Copies still in flight hold on to their own dumb buffer and staging
+   * data, and post their swap once done. */
+  g_list_free_full (secondary_gpu_state->cpu.free_staging_data, g_free);
+  secondary_gpu_state->cpu.free_staging_data = NULL;
+  secondary_gpu_state->cpu.staging_size = 0;
+
   for (i = 0; i < G_N_ELEMENTS (secondary_gpu_state->cpu.dumb_fbs); i++)
     {
       g_clear_object (&secondary_gpu_state->cpu.dumb_fbs[i]);
       g_clear_object (&secondary_gpu_state->cpu.source_fbs[i]);
+      g_clear_pointer (&secondary_gpu_state->cpu.damage[i],
+                       cairo_region_destroy);
     }
 }
 
@@ -572,6 +610,11 @@ secondary_gpu_state_free (MetaOnscreenNativeSecondaryGpuState *secondary_gpu_sta
 
   g_clear_pointer (&secondary_gpu_state->gbm.surface, gbm_surface_destroy);
 
+  /* Copies still in flight must neither post their swap nor touch this
+   * state once they are done. */
+  g_cancellable_cancel (secondary_gpu_state->cpu.copy_cancellable);
+  g_clear_object (&secondary_gpu_state->cpu.copy_cancellable);
+
   secondary_gpu_release_dumb (secondary_gpu_state);
 
   g_free (secondary_gpu_state);
@@ -714,7 +757,8 @@ copy_shared_framebuffer_gpu (CoglOnscreen                        *onscreen,
 }
 
 static MetaDrmBufferDumb *
-secondary_gpu_get_next_dumb_buffer (MetaOnscreenNativeSecondaryGpuState *secondary_gpu_state)
+secondary_gpu_get_next_dumb_buffer (MetaOnscreenNativeSecondaryGpuState *secondary_gpu_state,
+                                    int                                 *out_index)
 {
   MetaDrmBufferDumb *current_dumb_fb;
   const int n_dumb_fbs = G_N_ELEMENTS (secondary_gpu_state->cpu.dumb_fbs);
@@ -724,17 +768,91 @@ secondary_gpu_get_next_dumb_buffer (MetaOnscreenNativeSecondaryGpuState *seconda
   for (i = 0; i < n_dumb_fbs; i++)
     {
       if (current_dumb_fb == secondary_gpu_state->cpu.dumb_fbs[i])
-        return secondary_gpu_state->cpu.dumb_fbs[(i + 1) % n_dumb_fbs];
+        {
+          *out_index = (i + 1) % n_dumb_fbs;
+          return secondary_gpu_state->cpu.dumb_fbs[*out_index];
+        }
     }
 
+  *out_index = 0;
   return secondary_gpu_state->cpu.dumb_fbs[0];
 }
 
+static void
+secondary_gpu_accumulate_damage (MetaOnscreenNativeSecondaryGpuState *secondary_gpu_state,
+                                 const int                           *rectangles,
+                                 int                                  n_rectangles)
+{
+  unsigned int i;
+
+  for (i = 0; i < G_N_ELEMENTS (secondary_gpu_state->cpu.damage); i++)
+    {
+      cairo_region_t *damage = secondary_gpu_state->cpu.damage[i];
+      cairo_rectangle_int_t extents;
+      int j;
+
+      if (!damage)
+        continue;
+
+      if (!rectangles || n_rectangles == 0)
+        {
+          g_clear_pointer (&secondary_gpu_state->cpu.damage[i],
+                           cairo_region_destroy);
+          continue;
+        }
+
+      for (j = 0; j < n_rectangles; j++)
+        {
+          cairo_rectangle_int_t rect = {
+            .x = rectangles[j * 4],
+            .y = rectangles[j * 4 + 1],
+            .width = rectangles[j * 4 + 2],
+            .height = rectangles[j * 4 + 3],
+          };
+
+          cairo_region_union_rectangle (damage, &rect);
+        }
+
+      if (cairo_region_num_rectangles (damage) <= MAX_COPY_RECTS)
+        continue;
+
+      cairo_region_get_extents (damage, &extents);
+      cairo_region_destroy (damage);
+      secondary_gpu_state->cpu.damage[i] =
+        cairo_region_create_rectangle (&extents);
+    }
+}
+
+static cairo_region_t *
+secondary_gpu_get_copy_region (MetaOnscreenNativeSecondaryGpuState *secondary_gpu_state,
+                               int                                  dumb_fb_index,
+                               int                                  width,
+                               int                                  height)
+{
+  cairo_region_t *damage = secondary_gpu_state->cpu.damage[dumb_fb_index];
+  cairo_rectangle_int_t fb_rect = { 0, 0, width, height };
+  cairo_region_t *copy_region;
+
+  if (!damage)
+    return cairo_region_create_rectangle (&fb_rect);
+
+  copy_region = cairo_region_copy (damage);
+  cairo_region_intersect_rectangle (copy_region, &fb_rect);
+  return copy_region;
+}
+
+static void
+secondary_gpu_mark_dumb_buffer_copied (MetaOnscreenNativeSecondaryGpuState *secondary_gpu_state,
+                                       int                                  dumb_fb_index)
+{
+  g_clear_pointer (&secondary_gpu_state->cpu.damage[dumb_fb_index],
+                   cairo_region_destroy);
+  secondary_gpu_state->cpu.damage[dumb_fb_index] = cairo_region_create ();
+}
+
 static MetaDrmBuffer *
 copy_shared_framebuffer_primary_gpu (CoglOnscreen                        *onscreen,
-                                     MetaOnscreenNativeSecondaryGpuState *secondary_gpu_state,
-                                     const int                           *rectangles,
-                                     int                                  n_rectangles)
+                                     MetaOnscreenNativeSecondaryGpuState *secondary_gpu_state)
 {
   CoglFramebuffer *framebuffer = COGL_FRAMEBUFFER (onscreen);
   MetaOnscreenNative *onscreen_native = META_ONSCREEN_NATIVE (onscreen);
@@ -743,12 +861,15 @@ copy_shared_framebuffer_primary_gpu (CoglOnscreen                        *onscre
   MetaRendererNativeGpuData *primary_gpu_data;
   MetaDrmBufferDumb *buffer_dumb;
   MetaDrmBuffer *buffer;
+  int dumb_fb_index;
   int width, height, stride;
   uint32_t drm_format;
   CoglFramebuffer *dmabuf_fb;
   int dmabuf_fd;
   g_autoptr (GError) error = NULL;
   CoglPixelFormat cogl_format;
+  cairo_region_t *copy_region;
+  int n_rects, i;
   int ret;
 
   COGL_TRACE_BEGIN_SCOPED (CopySharedFramebufferPrimaryGpu,
@@ -764,7 +885,8 @@ copy_shared_framebuffer_primary_gpu (CoglOnscreen                        *onscre
   if (!primary_gpu_data->secondary.has_EGL_EXT_image_dma_buf_import_modifiers)
     return NULL;
 
-  buffer_dumb = secondary_gpu_get_next_dumb_buffer (secondary_gpu_state);
+  buffer_dumb = secondary_gpu_get_next_dumb_buffer (secondary_gpu_state,
+                                                    &dumb_fb_index);
   buffer = META_DRM_BUFFER (buffer_dumb);
 
   width = meta_drm_buffer_get_width (buffer);
@@ -805,44 +927,134 @@ copy_shared_framebuffer_primary_gpu (CoglOnscreen                        *onscre
                   error->message);
       return NULL;
     }
-  /* Limit the number of individual copies to 16 */
-#define MAX_RECTS 16
 
-  if (n_rectangles == 0 || n_rectangles > MAX_RECTS)
+  /* The dumb buffer still holds the frame it was last copied to, so only the
+   * damage accumulated since then needs to be blitted. */
+  copy_region = secondary_gpu_get_copy_region (secondary_gpu_state,
+                                               dumb_fb_index,
+                                               width, height);
+  n_rects = cairo_region_num_rectangles (copy_region);
+  for (i = 0; i < n_rects; i++)
     {
+      cairo_rectangle_int_t rect;
+
+      cairo_region_get_rectangle (copy_region, i, &rect);
       if (!cogl_blit_framebuffer (framebuffer, COGL_FRAMEBUFFER (dmabuf_fb),
-                                  0, 0, 0, 0,
-                                  width, height,
+                                  rect.x, rect.y,
+                                  rect.x, rect.y,
+                                  rect.width, rect.height,
                                   &error))
         {
+          cairo_region_destroy (copy_region);
           g_object_unref (dmabuf_fb);
           return NULL;
         }
     }
-  else
+
+  cairo_region_destroy (copy_region);
+  g_object_unref (dmabuf_fb);
+
+  secondary_gpu_mark_dumb_buffer_copied (secondary_gpu_state, dumb_fb_index);
+  secondary_gpu_state->cpu.current_dumb_fb = buffer_dumb;
+
+  return g_object_ref (buffer);
+}
+
+static void
+secondary_gpu_cpu_copy_free (SecondaryGpuCpuCopy *copy)
+{
+  g_object_unref (copy->buffer_dumb);
+  g_free (copy->staging_data);
+  cairo_region_destroy (copy->region);
+  g_free (copy);
+}
+
+static void
+secondary_gpu_cpu_copy_thread_func (GTask        *task,
+                                    gpointer      source_object,
+                                    gpointer      task_data,
+                                    GCancellable *cancellable)
+{
+  SecondaryGpuCpuCopy *copy = task_data;
+  uint8_t *src_data = copy->staging_data;
+  uint8_t *dst_data = meta_drm_buffer_dumb_get_data (copy->buffer_dumb);
+  int n_rects, i;
+
+  COGL_TRACE_BEGIN_SCOPED (CopySharedFramebufferCpuThread,
+                           "FB Copy (CPU, worker thread)");
+
+  n_rects = cairo_region_num_rectangles (copy->region);
+  for (i = 0; i < n_rects; i++)
     {
-      int i;
+      cairo_rectangle_int_t rect;
+      int offset, y;
+
+      if (g_task_return_error_if_cancelled (task))
+        return;
 
-      for (i = 0; i < n_rectangles; ++i)
+      cairo_region_get_rectangle (copy->region, i, &rect);
+
+      offset = rect.y * copy->stride + rect.x * copy->bpp;
+      for (y = 0; y < rect.height; y++)
         {
-          if (!cogl_blit_framebuffer (framebuffer, COGL_FRAMEBUFFER (dmabuf_fb),
-                                      rectangles[i * 4], rectangles[i * 4 + 1],
-                                      rectangles[i * 4], rectangles[i * 4 + 1],
-                                      rectangles[i * 4 + 2],
-                                      rectangles[i * 4 + 3],
-                                      &error))
-            {
-              g_object_unref (dmabuf_fb);
-              return NULL;
-            }
+          memcpy (dst_data + offset, src_data + offset,
+                  rect.width * copy->bpp);
+          offset += copy->stride;
         }
     }
 
-  g_object_unref (dmabuf_fb);
+  g_task_return_boolean (task, TRUE);
+}
 
-  secondary_gpu_state->cpu.current_dumb_fb = buffer_dumb;
+static void
+on_secondary_gpu_cpu_copy_done (GObject      *source_object,
+                                GAsyncResult *result,
+                                gpointer      user_data)
+{
+  SecondaryGpuCpuCopy *copy = g_task_get_task_data (G_TASK (result));
+  MetaOnscreenNativeSecondaryGpuState *secondary_gpu_state;
+  g_autoptr (GError) error = NULL;
 
-  return g_object_ref (buffer);
+  /* Cancelled when the onscreen was torn down; neither it nor its CRTC
+   * can be used anymore. */
+  if (!g_task_propagate_boolean (G_TASK (result), &error))
+    return;
+
+  secondary_gpu_state = copy->secondary_gpu_state;
+  secondary_gpu_state->cpu.n_copies_in_flight--;
+
+  if (copy->staging_size == secondary_gpu_state->cpu.staging_size &&
+      g_list_length (secondary_gpu_state->cpu.free_staging_data) <
+      SECONDARY_GPU_MAX_FREE_STAGING_DATA)
+    {
+      secondary_gpu_state->cpu.free_staging_data =
+        g_list_prepend (secondary_gpu_state->cpu.free_staging_data,
+                        g_steal_pointer (&copy->staging_data));
+    }
+
+  /* The swap was held back while the dumb buffer was being written. */
+  try_post_latest_swap (copy->onscreen);
+}
+
+static uint8_t *
+secondary_gpu_get_staging_data (MetaOnscreenNativeSecondaryGpuState *secondary_gpu_state,
+                                size_t                               size)
+{
+  GList *l = secondary_gpu_state->cpu.free_staging_data;
+  uint8_t *staging_data;
+
+  secondary_gpu_state->cpu.staging_size = size;
+
+  /* Rather than waiting for a copy in flight to be done with its staging
+   * data, use another one. */
+  if (!l)
+    return g_malloc (size);
+
+  staging_data = l->data;
+  secondary_gpu_state->cpu.free_staging_data =
+    g_list_delete_link (secondary_gpu_state->cpu.free_staging_data, l);
+
+  return staging_data;
 }
 
 static MetaDrmBuffer *
@@ -854,24 +1066,29 @@ copy_shared_framebuffer_cpu (CoglOnscreen                        *onscreen,
   CoglContext *cogl_context = cogl_framebuffer_get_context (framebuffer);
   MetaDrmBufferDumb *buffer_dumb;
   MetaDrmBuffer *buffer;
-  int width, height, stride;
+  int dumb_fb_index;
+  int width, height, stride, bpp;
   uint32_t drm_format;
-  void *buffer_data;
-  CoglBitmap *dumb_bitmap;
   CoglPixelFormat cogl_format;
+  cairo_region_t *copy_region;
+  cairo_region_t *read_region;
+  uint8_t *staging_data;
+  SecondaryGpuCpuCopy *copy;
+  g_autoptr (GTask) task = NULL;
+  int n_rects, i;
   gboolean ret;
 
   COGL_TRACE_BEGIN_SCOPED (CopySharedFramebufferCpu,
                            "FB Copy (CPU)");
 
-  buffer_dumb = secondary_gpu_get_next_dumb_buffer (secondary_gpu_state);
+  buffer_dumb = secondary_gpu_get_next_dumb_buffer (secondary_gpu_state,
+                                                    &dumb_fb_index);
   buffer = META_DRM_BUFFER (buffer_dumb);
 
   width = meta_drm_buffer_get_width (buffer);
   height = meta_drm_buffer_get_height (buffer);
   stride = meta_drm_buffer_get_stride (buffer);
   drm_format = meta_drm_buffer_get_format (buffer);
-  buffer_data = meta_drm_buffer_dumb_get_data (buffer_dumb);
 
   g_assert (cogl_framebuffer_get_width (framebuffer) == width);
   g_assert (cogl_framebuffer_get_height (framebuffer) == height);
@@ -881,24 +1098,83 @@ copy_shared_framebuffer_cpu (CoglOnscreen                        *onscreen,
                                                 NULL);
   g_assert (ret);
 
-  dumb_bitmap = cogl_bitmap_new_for_data (cogl_context,
-                                          width,
-                                          height,
-                                          cogl_format,
-                                          stride,
-                                          buffer_data);
+  bpp = cogl_pixel_format_get_bytes_per_pixel (cogl_format, 0);
 
-  if (!cogl_framebuffer_read_pixels_into_bitmap (framebuffer,
-                                                 0 /* x */,
-                                                 0 /* y */,
-                                                 COGL_READ_PIXELS_COLOR_BUFFER,
-                                                 dumb_bitmap))
-    g_warning ("Failed to CPU-copy to a secondary GPU output");
+  staging_data = secondary_gpu_get_staging_data (secondary_gpu_state,
+                                                 stride * height);
 
-  cogl_object_unref (dumb_bitmap);
+  /* Read back only what changed since this dumb buffer was last written.
+   * Reading has to happen here where the GL context is current, but it
+   * lands in cached memory; the slow write into the mapped dumb buffer is
+   * left to a worker thread, and the page flip is posted once it is done.
+   */
+  copy_region = secondary_gpu_get_copy_region (secondary_gpu_state,
+                                               dumb_fb_index,
+                                               width, height);
+  read_region = cairo_region_create ();
+  n_rects = cairo_region_num_rectangles (copy_region);
+  for (i = 0; i < n_rects; i++)
+    {
+      cairo_rectangle_int_t rect;
+      CoglBitmap *staging_bitmap;
+      gboolean read_ok;
+
+      cairo_region_get_rectangle (copy_region, i, &rect);
+
+      staging_bitmap =
+        cogl_bitmap_new_for_data (cogl_context,
+                                  rect.width,
+                                  rect.height,
+                                  cogl_format,
+                                  stride,
+                                  staging_data +
+                                  rect.y * stride + rect.x * bpp);
+
+      read_ok =
+        cogl_framebuffer_read_pixels_into_bitmap (framebuffer,
+                                                  rect.x,
+                                                  rect.y,
+                                                  COGL_READ_PIXELS_COLOR_BUFFER,
+                                                  staging_bitmap);
+      cogl_object_unref (staging_bitmap);
+
+      if (!read_ok)
+        {
+          g_warning ("Failed to CPU-copy to a secondary GPU output");
+          break;
+        }
+
+      /* Only what was actually read back may be written out */
+      cairo_region_union_rectangle (read_region, &rect);
+    }
 
+  if (i == n_rects)
+    secondary_gpu_mark_dumb_buffer_copied (secondary_gpu_state, dumb_fb_index);
   secondary_gpu_state->cpu.current_dumb_fb = buffer_dumb;
 
+  cairo_region_destroy (copy_region);
+
+  copy = g_new0 (SecondaryGpuCpuCopy, 1);
+  copy->onscreen = onscreen;
+  copy->secondary_gpu_state = secondary_gpu_state;
+  copy->buffer_dumb = g_object_ref (buffer_dumb);
+  copy->staging_data = staging_data;
+  copy->staging_size = stride * height;
+  copy->region = read_region;
+  copy->stride = stride;
+  copy->bpp = bpp;
+
+  secondary_gpu_state->cpu.n_copies_in_flight++;
+
+  /* The task doesn't keep the onscreen alive; tearing it down cancels
+   * the copy instead. */
+  task = g_task_new (NULL, secondary_gpu_state->cpu.copy_cancellable,
+                     on_secondary_gpu_cpu_copy_done, NULL);
+  g_task_set_source_tag (task, copy_shared_framebuffer_cpu);
+  g_task_set_task_data (task, copy,
+                        (GDestroyNotify) secondary_gpu_cpu_copy_free);
+  g_task_run_in_thread (task, secondary_gpu_cpu_copy_thread_func);
+
   return g_object_ref (buffer);
 }
 
@@ -922,6 +1198,10 @@ update_secondary_gpu_state_pre_swap_buffers (CoglOnscreen *onscreen,
 
       renderer_gpu_data = secondary_gpu_state->renderer_gpu_data;
       render_device = renderer_gpu_data->render_device;
+
+      secondary_gpu_accumulate_damage (secondary_gpu_state,
+                                       rectangles, n_rectangles);
+
       switch (renderer_gpu_data->secondary.copy_mode)
         {
         case META_SHARED_FRAMEBUFFER_COPY_MODE_SECONDARY_GPU:
@@ -936,9 +1216,7 @@ update_secondary_gpu_state_pre_swap_buffers (CoglOnscreen *onscreen,
           G_GNUC_FALLTHROUGH;
         case META_SHARED_FRAMEBUFFER_COPY_MODE_PRIMARY:
           copy = copy_shared_framebuffer_primary_gpu (onscreen,
-                                                      secondary_gpu_state,
-                                                      rectangles,
-                                                      n_rectangles);
+                                                      secondary_gpu_state);
           if (!copy)
             {
               if (!secondary_gpu_state->noted_primary_gpu_copy_failed)
@@ -1219,6 +1497,10 @@ try_post_latest_swap (CoglOnscreen *onscreen)
   if (onscreen_native->swaps_pending == 0)
     return;
 
+  if (onscreen_native->secondary_gpu_state &&
+      onscreen_native->secondary_gpu_state->cpu.n_copies_in_flight > 0)
+    return;  /* posted again when the copy has finished */
+
   g_assert (frames_pending >= onscreen_native->swaps_pending);
 
   power_save_mode = meta_monitor_manager_get_power_save_mode (monitor_manager);
@@ -1290,6 +1572,18 @@ try_post_latest_swap (CoglOnscreen *onscreen)
 #endif
     }
 
+  if (renderer_gpu_data->mode == META_RENDERER_NATIVE_MODE_GBM &&
+      meta_renderer_native_queue_synchronized_flip (renderer_native,
+                                                    onscreen))
+    {
+      meta_topic (META_DEBUG_KMS,
+                  "Queued synchronized primary plane composite update for "
+                  "CRTC %u (%s)",
+                  meta_kms_crtc_get_id (kms_crtc),
+                  meta_kms_device_get_path (kms_device));
+      return;
+    }
+
   meta_topic (META_DEBUG_KMS,
               "Posting primary plane composite update for CRTC %u (%s)",
               meta_kms_crtc_get_id (kms_crtc),
@@ -1328,6 +1622,10 @@ meta_onscreen_native_is_buffer_scanout_compatible (CoglOnscreen  *onscreen,
   MetaKmsUpdate *test_update;
   g_autoptr (MetaKmsFeedback) kms_feedback = NULL;
   MetaKmsFeedbackResult result;
+  gboolean passed;
+
+  if (meta_crtc_kms_lookup_scanout_test (crtc_kms, fb, &passed))
+    return passed;
 
   gpu_kms = META_GPU_KMS (meta_crtc_get_gpu (crtc));
   kms_device = meta_gpu_kms_get_kms_device (gpu_kms);
@@ -1339,7 +1637,10 @@ meta_onscreen_native_is_buffer_scanout_compatible (CoglOnscreen  *onscreen,
   meta_kms_update_free (test_update);
 
   result = meta_kms_feedback_get_result (kms_feedback);
-  return result == META_KMS_FEEDBACK_PASSED;
+  passed = result == META_KMS_FEEDBACK_PASSED;
+  meta_crtc_kms_cache_scanout_test (crtc_kms, fb, passed);
+
+  return passed;
 }
 
 static gboolean
@@ -1472,6 +1773,15 @@ meta_onscreen_native_direct_scanout (CoglOnscreen   *onscreen,
                            G_IO_ERROR, G_IO_ERROR_PERMISSION_DENIED))
         break;
 
+      /* Don't let a passed test commit keep sending us down this path;
+       * the failure may not last, so it is tested again later. */
+      if (META_IS_DRM_BUFFER (scanout))
+        {
+          meta_crtc_kms_cache_scanout_test (META_CRTC_KMS (onscreen_native->crtc),
+                                            META_DRM_BUFFER (scanout),
+                                            FALSE);
+        }
+
       g_propagate_error (error, g_error_copy (feedback_error));
       return FALSE;
     }
@@ -2035,6 +2345,7 @@ init_secondary_gpu_state_gpu_copy_mode (MetaRendererNative         *renderer_nat
     }
 
   secondary_gpu_state = g_new0 (MetaOnscreenNativeSecondaryGpuState, 1);
+  secondary_gpu_state->cpu.copy_cancellable = g_cancellable_new ();
 
   gpu_kms = META_GPU_KMS (meta_crtc_get_gpu (onscreen_native->crtc));
   secondary_gpu_state->gpu_kms = gpu_kms;
@@ -2160,6 +2471,7 @@ init_secondary_gpu_state_cpu_copy_mode (MetaRendererNative         *renderer_nat
               width, height);
 
   secondary_gpu_state = g_new0 (MetaOnscreenNativeSecondaryGpuState, 1);
+  secondary_gpu_state->cpu.copy_cancellable = g_cancellable_new ();
   secondary_gpu_state->renderer_gpu_data = renderer_gpu_data;
   secondary_gpu_state->gpu_kms = gpu_kms;
   secondary_gpu_state->egl_surface = EGL_NO_SURFACE;
@@ -2320,6 +2632,12 @@ meta_onscreen_native_dispose (GObject *object)
 #endif /* HAVE_EGL_DEVICE */
     }
 
+  /* Swaps held back for CPU copies still in flight are never posted, as
+   * the copies get cancelled along with the secondary GPU state. */
+  if (onscreen_native->secondary_gpu_state &&
+      onscreen_native->secondary_gpu_state->cpu.n_copies_in_flight > 0)
+    meta_onscreen_native_discard_pending_swaps (onscreen);
+
   G_OBJECT_CLASS (meta_onscreen_native_parent_class)->dispose (object);
 
   g_clear_object (&onscreen_native->crtc);
@@ -86,6 +86,9 @@ void meta_renderer_native_post_mode_set_updates (MetaRendererNative *renderer_na
 void meta_renderer_native_queue_power_save_page_flip (MetaRendererNative *renderer_native,
                                                       CoglOnscreen       *onscreen);
 
+gboolean meta_renderer_native_queue_synchronized_flip (MetaRendererNative *renderer_native,
+                                                       CoglOnscreen       *onscreen);
+
 CoglFramebuffer * meta_renderer_native_create_dma_buf_framebuffer (MetaRendererNative  *renderer_native,
                                                                    int                  dmabuf_fd,
                                                                    uint32_t             width,
@@ -100,6 +100,11 @@ struct _MetaRendererNative
 
   GList *power_save_page_flip_onscreens;
   guint power_save_page_flip_source_id;
+
+  GList *synchronized_flip_onscreens;
+  GList *synchronized_flip_awaited_views;
+  guint synchronized_flips_source_id;
+  gulong synchronized_flips_after_update_handler_id;
 };
 
 static void
@@ -723,6 +728,274 @@ meta_renderer_native_queue_power_save_page_flip (MetaRendererNative *renderer_na
                     g_object_ref (onscreen));
 }
 
+/* How long flips that are ready may be held back for the other views on the
+ * same device to be painted. */
+#define SYNCHRONIZED_FLIPS_MAX_WAIT_MS 2
+
+static void
+post_synchronized_flips (MetaKms *kms,
+                         GList   *kms_crtcs)
+{
+  g_autoptr (MetaKmsFeedback) kms_feedback = NULL;
+  const GError *feedback_error;
+
+  kms_feedback =
+    meta_kms_post_pending_updates_for_crtcs_sync (kms,
+                                                  kms_crtcs,
+                                                  META_KMS_UPDATE_FLAG_NONE);
+  if (!kms_feedback)
+    return;
+
+  switch (meta_kms_feedback_get_result (kms_feedback))
+    {
+    case META_KMS_FEEDBACK_PASSED:
+      break;
+    case META_KMS_FEEDBACK_FAILED:
+      feedback_error = meta_kms_feedback_get_error (kms_feedback);
+      if (!g_error_matches (feedback_error,
+                            G_IO_ERROR,
+                            G_IO_ERROR_PERMISSION_DENIED))
+        g_warning ("Failed to post KMS update: %s", feedback_error->message);
+      break;
+    }
+}
+
+static gboolean
+post_synchronized_flips_cb (gpointer user_data)
+{
+  MetaRendererNative *renderer_native = user_data;
+  MetaRenderer *renderer = META_RENDERER (renderer_native);
+  MetaBackend *backend = meta_renderer_get_backend (renderer);
+  MetaKms *kms = meta_backend_native_get_kms (META_BACKEND_NATIVE (backend));
+  GList *onscreens =
+    g_steal_pointer (&renderer_native->synchronized_flip_onscreens);
+
+  renderer_native->synchronized_flips_source_id = 0;
+  g_clear_pointer (&renderer_native->synchronized_flip_awaited_views,
+                   g_list_free);
+
+  if (meta_kms_is_shutting_down (kms))
+    {
+      g_list_free_full (onscreens, g_object_unref);
+      return G_SOURCE_REMOVE;
+    }
+
+  /* Post one update per device, covering all CRTCs on it that flip. */
+  while (onscreens)
+    {
+      MetaKmsDevice *kms_device = NULL;
+      g_autoptr (GList) kms_crtcs = NULL;
+      GList *l;
+
+      l = onscreens;
+      while (l)
+        {
+          GList *next = l->next;
+          MetaOnscreenNative *onscreen_native = l->data;
+          MetaCrtc *crtc = meta_onscreen_native_get_crtc (onscreen_native);
+          MetaKmsCrtc *kms_crtc;
+
+          /* The CRTC was turned off or taken away in the meantime */
+          if (!crtc || !meta_crtc_get_config (crtc))
+            {
+              onscreens = g_list_delete_link (onscreens, l);
+              g_object_unref (onscreen_native);
+              l = next;
+              continue;
+            }
+
+          kms_crtc = meta_crtc_kms_get_kms_crtc (META_CRTC_KMS (crtc));
+
+          if (!kms_device)
+            kms_device = meta_kms_crtc_get_device (kms_crtc);
+
+          if (meta_kms_crtc_get_device (kms_crtc) == kms_device)
+            {
+              kms_crtcs = g_list_prepend (kms_crtcs, kms_crtc);
+              onscreens = g_list_delete_link (onscreens, l);
+              g_object_unref (onscreen_native);
+            }
+
+          l = next;
+        }
+
+      if (kms_crtcs)
+        post_synchronized_flips (kms, kms_crtcs);
+    }
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+schedule_synchronized_flips (MetaRendererNative *renderer_native)
+{
+  g_clear_handle_id (&renderer_native->synchronized_flips_source_id,
+                     g_source_remove);
+
+  if (!renderer_native->synchronized_flip_onscreens)
+    return;
+
+  if (renderer_native->synchronized_flip_awaited_views)
+    {
+      /* Don't hold back the flips that are ready for long if the views
+       * still being waited for take their time, or end up not painting. */
+      renderer_native->synchronized_flips_source_id =
+        g_timeout_add_full (G_PRIORITY_HIGH,
+                            SYNCHRONIZED_FLIPS_MAX_WAIT_MS,
+                            post_synchronized_flips_cb,
+                            renderer_native,
+                            NULL);
+    }
+  else
+    {
+      renderer_native->synchronized_flips_source_id =
+        g_idle_add_full (G_PRIORITY_HIGH,
+                         post_synchronized_flips_cb,
+                         renderer_native,
+                         NULL);
+    }
+  g_source_set_name_by_id (renderer_native->synchronized_flips_source_id,
+                           "[mutter] Synchronized page flips");
+}
+
+static void
+discard_synchronized_flips (MetaRendererNative *renderer_native)
+{
+  g_clear_list (&renderer_native->synchronized_flip_onscreens,
+                g_object_unref);
+  g_clear_pointer (&renderer_native->synchronized_flip_awaited_views,
+                   g_list_free);
+  g_clear_handle_id (&renderer_native->synchronized_flips_source_id,
+                     g_source_remove);
+}
+
+static void
+on_synchronized_flip_view_updated (ClutterStage       *stage,
+                                   ClutterStageView   *stage_view,
+                                   MetaRendererNative *renderer_native)
+{
+  GList *link;
+
+  link = g_list_find (renderer_native->synchronized_flip_awaited_views,
+                      stage_view);
+  if (!link)
+    return;
+
+  /* The view was dispatched without a flip to wait for */
+  renderer_native->synchronized_flip_awaited_views =
+    g_list_delete_link (renderer_native->synchronized_flip_awaited_views,
+                        link);
+  if (!renderer_native->synchronized_flip_awaited_views)
+    schedule_synchronized_flips (renderer_native);
+}
+
+static MetaKmsDevice *
+get_view_kms_device (ClutterStageView *stage_view)
+{
+  MetaRendererView *view = META_RENDERER_VIEW (stage_view);
+  MetaCrtc *crtc = meta_renderer_view_get_crtc (view);
+  MetaKmsCrtc *kms_crtc;
+
+  if (!META_IS_CRTC_KMS (crtc))
+    return NULL;
+
+  kms_crtc = meta_crtc_kms_get_kms_crtc (META_CRTC_KMS (crtc));
+  return meta_kms_crtc_get_device (kms_crtc);
+}
+
+/*
+ * Holds back posting the page flip of @onscreen so that it is committed
+ * together with the flips of the other views on the same device, in one
+ * KMS update, and hits the same vertical blank. Views have frame clocks of
+ * their own, so the updates already scheduled for the other views on the
+ * device are dispatched right away, and the flips are posted once these
+ * have been painted. Returns FALSE if flips are not synchronized, in which
+ * case the caller should post the update itself.
+ */
+gboolean
+meta_renderer_native_queue_synchronized_flip (MetaRendererNative *renderer_native,
+                                              CoglOnscreen       *onscreen)
+{
+  MetaRenderer *renderer = META_RENDERER (renderer_native);
+  MetaBackend *backend = meta_renderer_get_backend (renderer);
+  MetaSettings *settings = meta_backend_get_settings (backend);
+  MetaOnscreenNative *onscreen_native = META_ONSCREEN_NATIVE (onscreen);
+  MetaCrtc *crtc = meta_onscreen_native_get_crtc (onscreen_native);
+  MetaKmsCrtc *kms_crtc;
+  MetaKmsDevice *kms_device;
+  GList *l;
+
+  if (!meta_settings_is_experimental_feature_enabled (
+        settings, META_EXPERIMENTAL_FEATURE_KMS_SYNCHRONIZED_FLIPS))
+    return FALSE;
+
+  kms_crtc = meta_crtc_kms_get_kms_crtc (META_CRTC_KMS (crtc));
+  kms_device = meta_kms_crtc_get_device (kms_crtc);
+
+  /* Only atomic mode setting commits the flips of several CRTCs at once */
+  if (!(meta_kms_device_get_flags (kms_device) & META_KMS_DEVICE_FLAG_ATOMIC))
+    return FALSE;
+
+  if (!renderer_native->synchronized_flips_after_update_handler_id)
+    {
+      renderer_native->synchronized_flips_after_update_handler_id =
+        g_signal_connect_object (meta_backend_get_stage (backend),
+                                 "after-update",
+                                 G_CALLBACK (on_synchronized_flip_view_updated),
+                                 renderer_native, 0);
+    }
+
+  if (!g_list_find (renderer_native->synchronized_flip_onscreens, onscreen))
+    {
+      renderer_native->synchronized_flip_onscreens =
+        g_list_prepend (renderer_native->synchronized_flip_onscreens,
+                        g_object_ref (onscreen));
+    }
+
+  for (l = meta_renderer_get_views (renderer); l; l = l->next)
+    {
+      ClutterStageView *stage_view = l->data;
+      CoglFramebuffer *framebuffer =
+        clutter_stage_view_get_onscreen (stage_view);
+      ClutterFrameClock *frame_clock;
+
+      if (framebuffer == COGL_FRAMEBUFFER (onscreen))
+        {
+          renderer_native->synchronized_flip_awaited_views =
+            g_list_remove (renderer_native->synchronized_flip_awaited_views,
+                           stage_view);
+          continue;
+        }
+
+      if (g_list_find (renderer_native->synchronized_flip_onscreens,
+                       framebuffer) ||
+          g_list_find (renderer_native->synchronized_flip_awaited_views,
+                       stage_view))
+        continue;
+
+      if (get_view_kms_device (stage_view) != kms_device)
+        continue;
+
+      frame_clock = clutter_stage_view_get_frame_clock (stage_view);
+      if (clutter_frame_clock_advance_scheduled_update (frame_clock))
+        {
+          renderer_native->synchronized_flip_awaited_views =
+            g_list_prepend (renderer_native->synchronized_flip_awaited_views,
+                            stage_view);
+        }
+    }
+
+  schedule_synchronized_flips (renderer_native);
+
+  return TRUE;
+}
+
+gboolean
+meta_renderer_native_has_synchronized_flips (MetaRendererNative *renderer_native)
+{
+  return !!renderer_native->synchronized_flip_onscreens;
+}
+
 static gboolean
 is_gpu_unused (gpointer key,
                gpointer value,
@@ -1467,6 +1740,7 @@ meta_renderer_native_rebuild_views (MetaRenderer *renderer)
     META_RENDERER_CLASS (meta_renderer_native_parent_class);
 
   discard_pending_swaps (renderer);
+  discard_synchronized_flips (META_RENDERER_NATIVE (renderer));
   meta_kms_discard_pending_page_flips (kms);
   meta_kms_discard_pending_updates (kms);
 
@@ -2147,6 +2421,8 @@ meta_renderer_native_finalize (GObject *object)
   g_clear_handle_id (&renderer_native->power_save_page_flip_source_id,
                      g_source_remove);
 
+  discard_synchronized_flips (renderer_native);
+
   g_list_free (renderer_native->pending_mode_set_views);
 
   g_clear_handle_id (&renderer_native->release_unused_gpus_idle_id,
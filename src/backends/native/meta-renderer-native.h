@@ -32,6 +32,7 @@
 #include "backends/meta-renderer.h"
 #include "backends/native/meta-gpu-kms.h"
 #include "backends/native/meta-monitor-manager-native.h"
+#include "core/util-private.h"
 
 #define META_TYPE_RENDERER_NATIVE (meta_renderer_native_get_type ())
 G_DECLARE_FINAL_TYPE (MetaRendererNative, meta_renderer_native,
@@ -56,6 +57,9 @@ MetaGpuKms * meta_renderer_native_get_primary_gpu (MetaRendererNative *renderer_
 
 MetaDeviceFile * meta_renderer_native_get_primary_device_file (MetaRendererNative *renderer_native);
 
+META_EXPORT_TEST
+gboolean meta_renderer_native_has_synchronized_flips (MetaRendererNative *renderer_native);
+
 void meta_renderer_native_prepare_frame (MetaRendererNative *renderer_native,
                                          MetaRendererView   *view,
                                          ClutterFrame       *frame);
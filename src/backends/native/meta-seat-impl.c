@@ -32,6 +32,9 @@
 #include <libinput.h>
 #include <linux/input.h>
 #include <math.h>
+#include <string.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
 
 #include "backends/meta-cursor-tracker-private.h"
 #include "backends/native/meta-backend-native-private.h"
@@ -67,6 +70,13 @@
 #define BTN_STYLUS3 0x149 /* Linux 4.15 */
 #endif
 
+/* Must be a power of two */
+#define EVENT_RING_SIZE 1024
+#define EVENT_RING_MASK (EVENT_RING_SIZE - 1)
+
+#define N_EVENT_LATENCY_BUCKETS 16
+#define EVENT_LATENCY_REPORT_INTERVAL 4096
+
 struct _MetaEventSource
 {
   GSource source;
@@ -75,6 +85,39 @@ struct _MetaEventSource
   GPollFD event_poll_fd;
 };
 
+typedef struct _MetaEventRingSlot
+{
+  ClutterEvent *event;
+  int64_t queue_time_us;
+} MetaEventRingSlot;
+
+/*
+ * Bounded single producer (input thread), single consumer (main thread)
+ * queue handing over events without taking any lock. The producer only
+ * writes 'tail', the consumer only writes 'head'; both are accessed using
+ * atomic operations, which act as full memory barriers.
+ */
+struct _MetaEventRing
+{
+  GSource source;
+
+  MetaSeatImpl *seat_impl;
+  GPollFD eventfd_poll_fd;
+
+  MetaEventRingSlot slots[EVENT_RING_SIZE];
+  unsigned int head;
+  unsigned int tail;
+
+  /* Events that didn't fit in the ring, only accessed by the producer */
+  GQueue overflow;
+  int overflowed;
+
+  /* Only accessed by the consumer */
+  GPtrArray *dispatch_batch;
+  unsigned int latency_histogram[N_EVENT_LATENCY_BUCKETS];
+  unsigned int n_latency_samples;
+};
+
 enum
 {
   PROP_0,
@@ -271,11 +314,395 @@ keyboard_repeat (gpointer data)
   return G_SOURCE_CONTINUE;
 }
 
+static gboolean
+is_compressible_motion (const ClutterEvent *event,
+                        const ClutterEvent *next_event)
+{
+  if (event->type != CLUTTER_MOTION || next_event->type != CLUTTER_MOTION)
+    return FALSE;
+
+  if (clutter_event_get_source_device (event) !=
+      clutter_event_get_source_device (next_event))
+    return FALSE;
+
+  /* Keep every sample of tablet motion, clients use the full axis history
+   * for e.g. pressure sensitive strokes. */
+  if (event->motion.axes || next_event->motion.axes)
+    return FALSE;
+
+  return event->motion.modifier_state == next_event->motion.modifier_state;
+}
+
+static gboolean
+is_compressible_scroll (const ClutterEvent *event,
+                        const ClutterEvent *next_event)
+{
+  if (event->type != CLUTTER_SCROLL || next_event->type != CLUTTER_SCROLL)
+    return FALSE;
+
+  if (event->scroll.direction != CLUTTER_SCROLL_SMOOTH ||
+      next_event->scroll.direction != CLUTTER_SCROLL_SMOOTH)
+    return FALSE;
+
+  if (clutter_event_get_source_device (event) !=
+      clutter_event_get_source_device (next_event))
+    return FALSE;
+
+  if (clutter_event_is_pointer_emulated (event) ||
+      clutter_event_is_pointer_emulated (next_event))
+    return FALSE;
+
+  /* Wheel deltas are derived from v120 values, interleaved with the discrete
+   * steps they accumulate into; clients get them as axis_value120, so every
+   * event is kept to stay in step with those. */
+  if (event->scroll.scroll_source == CLUTTER_SCROLL_SOURCE_WHEEL ||
+      next_event->scroll.scroll_source == CLUTTER_SCROLL_SOURCE_WHEEL)
+    return FALSE;
+
+  return (event->scroll.scroll_source == next_event->scroll.scroll_source &&
+          event->scroll.finish_flags == CLUTTER_SCROLL_FINISHED_NONE &&
+          event->scroll.modifier_state == next_event->scroll.modifier_state);
+}
+
+gboolean
+meta_seat_impl_is_compressible_event (const ClutterEvent *event,
+                                      const ClutterEvent *next_event)
+{
+  return (is_compressible_motion (event, next_event) ||
+          is_compressible_scroll (event, next_event));
+}
+
+/* Folds @event into the more recent @next_event, so that no motion or scroll
+ * distance is lost; relative motion samples are kept in the motion history
+ * of @next_event, so relative pointer clients still get every one of them
+ * with its own timestamp and unaccelerated deltas. */
+void
+meta_seat_impl_compress_event (const ClutterEvent *event,
+                               ClutterEvent       *next_event)
+{
+  if (event->type == CLUTTER_MOTION)
+    _clutter_event_merge_relative_motion (next_event, event);
+  else if (event->type == CLUTTER_SCROLL)
+    {
+      double dx, dy, next_dx, next_dy;
+
+      clutter_event_get_scroll_delta (event, &dx, &dy);
+      clutter_event_get_scroll_delta (next_event, &next_dx, &next_dy);
+      clutter_event_set_scroll_delta (next_event, dx + next_dx, dy + next_dy);
+    }
+}
+
+static void
+append_event_to_batch (GPtrArray    *event_batch,
+                       ClutterEvent *event)
+{
+  if (event_batch->len > 0)
+    {
+      ClutterEvent *last_event = event_batch->pdata[event_batch->len - 1];
+
+      if (meta_seat_impl_is_compressible_event (last_event, event))
+        {
+          meta_seat_impl_compress_event (last_event, event);
+          clutter_event_free (last_event);
+          event_batch->pdata[event_batch->len - 1] = event;
+          return;
+        }
+    }
+
+  g_ptr_array_add (event_batch, event);
+}
+
+static void
+record_event_latency (MetaEventRing *event_ring,
+                      int64_t        latency_us)
+{
+  int bucket = 0;
+
+  /* Bucket n holds latencies in [2^n, 2^(n+1)) µs, bucket 0 also holds 0 */
+  while (latency_us > 1 && bucket < N_EVENT_LATENCY_BUCKETS - 1)
+    {
+      latency_us >>= 1;
+      bucket++;
+    }
+  event_ring->latency_histogram[bucket]++;
+
+  if (++event_ring->n_latency_samples < EVENT_LATENCY_REPORT_INTERVAL)
+    return;
+
+  if (meta_is_topic_enabled (META_DEBUG_INPUT))
+    {
+      g_autoptr (GString) report = NULL;
+      int i;
+
+      report = g_string_new (NULL);
+      for (i = 0; i < N_EVENT_LATENCY_BUCKETS; i++)
+        {
+          g_string_append_printf (report, " <%dus:%u",
+                                  1 << (i + 1),
+                                  event_ring->latency_histogram[i]);
+        }
+
+      meta_topic (META_DEBUG_INPUT,
+                  "Input thread to main thread event latency over %u events:%s",
+                  event_ring->n_latency_samples, report->str);
+    }
+
+  memset (event_ring->latency_histogram, 0,
+          sizeof (event_ring->latency_histogram));
+  event_ring->n_latency_samples = 0;
+}
+
+static void
+signal_event_ring (MetaEventRing *event_ring)
+{
+  uint64_t value = 1;
+
+  if (write (event_ring->eventfd_poll_fd.fd, &value, sizeof (value)) < 0 &&
+      errno != EAGAIN)
+    g_warning ("Failed to signal event ring: %s", g_strerror (errno));
+}
+
+static void
+flush_event_ring_overflow (MetaEventRing *event_ring)
+{
+  while (!g_queue_is_empty (&event_ring->overflow))
+    {
+      unsigned int head, tail, old_tail;
+      int64_t now_us;
+
+      head = g_atomic_int_get (&event_ring->head);
+      old_tail = tail = g_atomic_int_get (&event_ring->tail);
+      now_us = g_get_monotonic_time ();
+
+      while (tail - head < EVENT_RING_SIZE &&
+             !g_queue_is_empty (&event_ring->overflow))
+        {
+          MetaEventRingSlot *slot = &event_ring->slots[tail & EVENT_RING_MASK];
+
+          slot->event = g_queue_pop_head (&event_ring->overflow);
+          slot->queue_time_us = now_us;
+          tail++;
+        }
+
+      if (tail != old_tail)
+        {
+          g_atomic_int_set (&event_ring->tail, tail);
+
+          /* If the consumer had caught up with the old tail it may have gone
+           * to sleep before seeing the new one, so wake it up. The atomic
+           * store above and load below pair with the ones in the consumer,
+           * so either it sees the new tail, or we see it reached the old
+           * one. */
+          if (g_atomic_int_get (&event_ring->head) == old_tail)
+            signal_event_ring (event_ring);
+        }
+
+      if (g_queue_is_empty (&event_ring->overflow))
+        break;
+
+      /* The ring is full; ask the consumer to call us back once it drained
+       * it, unless it already made room meanwhile. */
+      g_atomic_int_set (&event_ring->overflowed, TRUE);
+      if (g_atomic_int_get (&event_ring->head) == head)
+        break;
+    }
+}
+
+static void
+push_events_to_ring (MetaEventRing  *event_ring,
+                     ClutterEvent  **events,
+                     unsigned int    n_events)
+{
+  unsigned int i;
+
+  /* Preserve ordering: anything that previously overflowed goes first, and
+   * if it still doesn't fit, new events are appended after it. */
+  for (i = 0; i < n_events; i++)
+    g_queue_push_tail (&event_ring->overflow, events[i]);
+
+  flush_event_ring_overflow (event_ring);
+}
+
+static gboolean
+flush_event_ring_overflow_in_impl (gpointer user_data)
+{
+  MetaEventRing *event_ring = user_data;
+
+  flush_event_ring_overflow (event_ring);
+
+  return G_SOURCE_REMOVE;
+}
+
+static gboolean
+meta_event_ring_prepare (GSource *g_source,
+                         int     *timeout_ms)
+{
+  MetaEventRing *event_ring = (MetaEventRing *) g_source;
+
+  *timeout_ms = -1;
+
+  return (g_atomic_int_get (&event_ring->head) !=
+          g_atomic_int_get (&event_ring->tail));
+}
+
+static gboolean
+meta_event_ring_check (GSource *g_source)
+{
+  MetaEventRing *event_ring = (MetaEventRing *) g_source;
+
+  return !!(event_ring->eventfd_poll_fd.revents & G_IO_IN);
+}
+
+/* The ring holds everything the input thread published since the main
+ * thread last got to run, which may span many libinput dispatches when it is
+ * busy, e.g. painting a frame; compress across those as well, as a 1000 Hz
+ * mouse typically produces a single event per dispatch. */
+static void
+drain_event_ring (MetaEventRing *event_ring)
+{
+  unsigned int head, tail;
+  int64_t now_us;
+
+  now_us = g_get_monotonic_time ();
+  head = g_atomic_int_get (&event_ring->head);
+
+  while (head != (tail = g_atomic_int_get (&event_ring->tail)))
+    {
+      while (head != tail)
+        {
+          MetaEventRingSlot *slot = &event_ring->slots[head & EVENT_RING_MASK];
+
+          record_event_latency (event_ring, now_us - slot->queue_time_us);
+          append_event_to_batch (event_ring->dispatch_batch, slot->event);
+          slot->event = NULL;
+          head++;
+        }
+
+      g_atomic_int_set (&event_ring->head, head);
+    }
+}
+
+static gboolean
+meta_event_ring_dispatch (GSource     *g_source,
+                          GSourceFunc  callback,
+                          gpointer     user_data)
+{
+  MetaEventRing *event_ring = (MetaEventRing *) g_source;
+  MetaSeatImpl *seat_impl = event_ring->seat_impl;
+  MetaBackend *backend;
+  uint64_t value;
+
+  if (event_ring->eventfd_poll_fd.revents & G_IO_IN)
+    {
+      if (read (event_ring->eventfd_poll_fd.fd, &value, sizeof (value)) < 0 &&
+          errno != EAGAIN)
+        g_warning ("Failed to read event ring eventfd: %s", g_strerror (errno));
+    }
+
+  drain_event_ring (event_ring);
+  _clutter_event_push_batch (event_ring->dispatch_batch);
+
+  if (g_atomic_int_compare_and_exchange (&event_ring->overflowed, TRUE, FALSE))
+    {
+      g_main_context_invoke_full (seat_impl->input_context,
+                                  G_PRIORITY_HIGH,
+                                  flush_event_ring_overflow_in_impl,
+                                  event_ring,
+                                  NULL);
+    }
+
+  /* This already runs on the main context, dispatch the events right away
+   * rather than waiting for the backend event source to pick them up in
+   * the next main loop iteration. */
+  backend = meta_seat_native_get_backend (seat_impl->seat_native);
+  meta_backend_dispatch_pending_events (backend);
+
+  return G_SOURCE_CONTINUE;
+}
+
+static GSourceFuncs event_ring_funcs = {
+  meta_event_ring_prepare,
+  meta_event_ring_check,
+  meta_event_ring_dispatch,
+  NULL
+};
+
+static MetaEventRing *
+meta_event_ring_new (MetaSeatImpl  *seat_impl,
+                     GError       **error)
+{
+  GSource *source;
+  MetaEventRing *event_ring;
+  int fd;
+
+  fd = eventfd (0, EFD_CLOEXEC | EFD_NONBLOCK);
+  if (fd < 0)
+    {
+      g_set_error (error, G_IO_ERROR, g_io_error_from_errno (errno),
+                   "Failed to create event ring eventfd: %s",
+                   g_strerror (errno));
+      return NULL;
+    }
+
+  source = g_source_new (&event_ring_funcs, sizeof (MetaEventRing));
+  g_source_set_name (source, "[mutter] Input events");
+  event_ring = (MetaEventRing *) source;
+
+  event_ring->seat_impl = seat_impl;
+  g_queue_init (&event_ring->overflow);
+  event_ring->dispatch_batch = g_ptr_array_new ();
+
+  event_ring->eventfd_poll_fd.fd = fd;
+  event_ring->eventfd_poll_fd.events = G_IO_IN;
+
+  g_source_set_priority (source, CLUTTER_PRIORITY_EVENTS);
+  g_source_add_poll (source, &event_ring->eventfd_poll_fd);
+  g_source_attach (source, seat_impl->main_context);
+
+  return event_ring;
+}
+
+static void
+meta_event_ring_free (MetaEventRing *event_ring)
+{
+  GSource *source = (GSource *) event_ring;
+  unsigned int head, tail;
+
+  g_source_destroy (source);
+
+  head = g_atomic_int_get (&event_ring->head);
+  tail = g_atomic_int_get (&event_ring->tail);
+  for (; head != tail; head++)
+    clutter_event_free (event_ring->slots[head & EVENT_RING_MASK].event);
+
+  g_queue_clear_full (&event_ring->overflow,
+                      (GDestroyNotify) clutter_event_free);
+  g_ptr_array_unref (event_ring->dispatch_batch);
+  close (event_ring->eventfd_poll_fd.fd);
+
+  g_source_unref (source);
+}
+
 static void
 queue_event (MetaSeatImpl *seat_impl,
              ClutterEvent *event)
 {
-  _clutter_event_push (event, FALSE);
+  GPtrArray *event_batch = seat_impl->event_batch;
+
+  if (!seat_impl->batching_events)
+    {
+      push_events_to_ring (seat_impl->event_ring, &event, 1);
+      return;
+    }
+
+  append_event_to_batch (event_batch, event);
+}
+
+void
+meta_seat_impl_queue_event_in_impl (MetaSeatImpl *seat_impl,
+                                    ClutterEvent *event)
+{
+  queue_event (seat_impl, event);
 }
 
 static int
@@ -2681,11 +3108,26 @@ process_events (MetaSeatImpl *seat_impl)
 {
   struct libinput_event *event;
 
+  /* Batch up the events of a dispatch, compressing consecutive motion and
+   * smooth scroll, and hand them to the main context in one go rather than
+   * waking it up once per event. This only helps devices reporting several
+   * events per dispatch (e.g. touchpads, tablets, or a backlogged input
+   * thread); compression across dispatches happens when draining the event
+   * ring. */
+  g_assert (!seat_impl->batching_events);
+  seat_impl->batching_events = TRUE;
+
   while ((event = libinput_get_event (seat_impl->libinput)))
     {
       process_event(seat_impl, event);
       libinput_event_destroy(event);
     }
+
+  seat_impl->batching_events = FALSE;
+  push_events_to_ring (seat_impl->event_ring,
+                       (ClutterEvent **) seat_impl->event_batch->pdata,
+                       seat_impl->event_batch->len);
+  g_ptr_array_set_size (seat_impl->event_batch, 0);
 }
 
 static int
@@ -2912,6 +3354,10 @@ meta_seat_impl_initable_init (GInitable     *initable,
   seat_impl->main_context = g_main_context_ref_thread_default ();
   g_assert (seat_impl->main_context == g_main_context_default ());
 
+  seat_impl->event_ring = meta_event_ring_new (seat_impl, error);
+  if (!seat_impl->event_ring)
+    return FALSE;
+
   seat_impl->input_thread =
     g_thread_try_new ("Mutter Input Thread",
                       (GThreadFunc) input_thread,
@@ -3065,6 +3511,9 @@ meta_seat_impl_finalize (GObject *object)
   g_assert (!seat_impl->event_source);
 
   g_free (seat_impl->seat_id);
+  g_assert (seat_impl->event_batch->len == 0);
+  g_ptr_array_unref (seat_impl->event_batch);
+  g_clear_pointer (&seat_impl->event_ring, meta_event_ring_free);
 
   g_rw_lock_clear (&seat_impl->state_lock);
 
@@ -3273,6 +3722,8 @@ meta_seat_impl_init (MetaSeatImpl *seat_impl)
 {
   g_rw_lock_init (&seat_impl->state_lock);
 
+  seat_impl->event_batch = g_ptr_array_new ();
+
   seat_impl->repeat = TRUE;
   seat_impl->repeat_delay = 250;     /* ms */
   seat_impl->repeat_interval = 33;   /* ms */
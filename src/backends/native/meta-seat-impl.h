@@ -40,10 +40,12 @@
 #include "backends/native/meta-pointer-constraint-native.h"
 #include "backends/native/meta-xkb-utils.h"
 #include "clutter/clutter.h"
+#include "core/util-private.h"
 
 typedef struct _MetaTouchState MetaTouchState;
 typedef struct _MetaSeatImpl MetaSeatImpl;
 typedef struct _MetaEventSource  MetaEventSource;
+typedef struct _MetaEventRing MetaEventRing;
 
 struct _MetaTouchState
 {
@@ -69,6 +71,7 @@ struct _MetaSeatImpl
   char *seat_id;
   MetaSeatNativeFlag flags;
   MetaEventSource *event_source;
+  MetaEventRing *event_ring;
   struct libinput *libinput;
   GRWLock state_lock;
 
@@ -120,6 +123,10 @@ struct _MetaSeatImpl
   float accum_scroll_dx;
   float accum_scroll_dy;
 
+  /* Events queued while processing a libinput dispatch */
+  GPtrArray *event_batch;
+  gboolean batching_events;
+
   gboolean released;
 };
 
@@ -137,6 +144,9 @@ void meta_seat_impl_run_input_task (MetaSeatImpl *seat_impl,
                                     GTask        *task,
                                     GSourceFunc   dispatch_func);
 
+void meta_seat_impl_queue_event_in_impl (MetaSeatImpl *seat_impl,
+                                         ClutterEvent *event);
+
 void meta_seat_impl_notify_key_in_impl (MetaSeatImpl       *seat_impl,
                                         ClutterInputDevice *device,
                                         uint64_t            time_us,
@@ -251,4 +261,12 @@ void meta_seat_impl_queue_main_thread_idle (MetaSeatImpl   *seat_impl,
                                             gpointer        user_data,
                                             GDestroyNotify  destroy_notify);
 
+META_EXPORT_TEST
+gboolean meta_seat_impl_is_compressible_event (const ClutterEvent *event,
+                                               const ClutterEvent *next_event);
+
+META_EXPORT_TEST
+void meta_seat_impl_compress_event (const ClutterEvent *event,
+                                    ClutterEvent       *next_event);
+
 #endif /* META_SEAT_IMPL_H */
@@ -66,6 +66,7 @@ struct _MetaSeatNative
 };
 
 #define META_TYPE_SEAT_NATIVE meta_seat_native_get_type ()
+META_EXPORT_TEST
 G_DECLARE_FINAL_TYPE (MetaSeatNative, meta_seat_native,
                       META, SEAT_NATIVE, ClutterSeat)
 
@@ -117,6 +118,7 @@ void meta_seat_native_set_keyboard_repeat (MetaSeatNative *seat,
 void meta_seat_native_release_touch_slots (MetaSeatNative *seat,
                                            guint           base_slot);
 
+META_EXPORT_TEST
 MetaBarrierManagerNative * meta_seat_native_get_barrier_manager (MetaSeatNative *seat);
 
 MetaBackend * meta_seat_native_get_backend (MetaSeatNative *seat);
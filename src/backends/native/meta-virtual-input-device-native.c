@@ -201,7 +201,7 @@ release_device_in_impl (GTask *task)
 
   device_event = clutter_event_new (CLUTTER_DEVICE_REMOVED);
   clutter_event_set_device (device_event, impl_state->device);
-  _clutter_event_push (device_event, FALSE);
+  meta_seat_impl_queue_event_in_impl (seat_impl, device_event);
 
   g_clear_object (&impl_state->device);
   g_task_return_boolean (task, TRUE);
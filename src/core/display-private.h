@@ -228,6 +228,7 @@ struct _MetaDisplay
   MetaSelectionSource *selection_source;
   GBytes *saved_clipboard;
   gchar *saved_clipboard_mimetype;
+  GList *clipboard_history;
   MetaSelection *selection;
 };
 
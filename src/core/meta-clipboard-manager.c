@@ -21,12 +21,19 @@
 
 #include "config.h"
 
+#include <errno.h>
+
 #include "core/meta-clipboard-manager.h"
+
+#include "core/meta-anonymous-file.h"
 #include "meta/meta-selection-source-memory.h"
 
 #define MAX_TEXT_SIZE (4 * 1024 * 1024) /* 4MB */
 #define MAX_IMAGE_SIZE (200 * 1024 * 1024) /* 200MB */
 
+#define MAX_HISTORY_ENTRIES 8
+#define MAX_HISTORY_SIZE (64 * 1024 * 1024) /* 64MB */
+
 /* Supported mimetype globs, from least to most preferred */
 static struct {
   const char *mimetype_glob;
@@ -63,13 +70,149 @@ mimetype_match (const char *mimetype,
   return FALSE;
 }
 
+static GBytes *
+map_anonymous_copy (GBytes  *bytes,
+                    GError **error)
+{
+  MetaAnonymousFile *file;
+  GMappedFile *mapped_file;
+  GBytes *content;
+  int fd;
+
+  if (g_bytes_get_size (bytes) == 0)
+    return g_bytes_ref (bytes);
+
+  file = meta_anonymous_file_new (g_bytes_get_size (bytes),
+                                  g_bytes_get_data (bytes, NULL));
+  if (!file)
+    {
+      g_set_error (error, G_IO_ERROR, g_io_error_from_errno (errno),
+                   "Failed to create anonymous file: %s",
+                   g_strerror (errno));
+      return NULL;
+    }
+
+  fd = meta_anonymous_file_open_fd (file, META_ANONYMOUS_FILE_MAPMODE_PRIVATE);
+  if (fd == -1)
+    {
+      g_set_error (error, G_IO_ERROR, g_io_error_from_errno (errno),
+                   "Failed to open anonymous file: %s",
+                   g_strerror (errno));
+      meta_anonymous_file_free (file);
+      return NULL;
+    }
+
+  /* The read-only mapping keeps the memfd pages alive on its own */
+  mapped_file = g_mapped_file_new_from_fd (fd, FALSE, error);
+  meta_anonymous_file_close_fd (fd);
+  meta_anonymous_file_free (file);
+
+  if (!mapped_file)
+    return NULL;
+
+  content = g_mapped_file_get_bytes (mapped_file);
+  g_mapped_file_unref (mapped_file);
+
+  return content;
+}
+
+static void
+clipboard_entry_free (MetaClipboardEntry *entry)
+{
+  g_free (entry->mimetype);
+  g_free (entry->checksum);
+  g_bytes_unref (entry->content);
+  g_free (entry);
+}
+
+static void
+trim_clipboard_history (MetaDisplay *display)
+{
+  size_t total_size = 0;
+  int n_entries = 0;
+  GList *l;
+
+  l = display->clipboard_history;
+  while (l)
+    {
+      MetaClipboardEntry *entry = l->data;
+      GList *next = l->next;
+
+      n_entries++;
+      total_size += g_bytes_get_size (entry->content);
+
+      /* Always keep the most recent entry, it backs the saved clipboard */
+      if (l != display->clipboard_history &&
+          (n_entries > MAX_HISTORY_ENTRIES || total_size > MAX_HISTORY_SIZE))
+        {
+          display->clipboard_history =
+            g_list_delete_link (display->clipboard_history, l);
+          clipboard_entry_free (entry);
+        }
+
+      l = next;
+    }
+}
+
+/* Saved clipboard contents are kept in sealed memfds rather than on the
+ * heap. The most recent ones are kept in a history bounded by count and
+ * size, so copying any of them again reuses the existing mapping instead
+ * of creating a new one.
+ */
+static MetaClipboardEntry *
+store_clipboard_entry (MetaDisplay  *display,
+                       const char   *mimetype,
+                       GBytes       *bytes,
+                       GError      **error)
+{
+  MetaClipboardEntry *entry;
+  g_autofree char *checksum = NULL;
+  GBytes *content;
+  GList *l;
+
+  checksum = g_compute_checksum_for_bytes (G_CHECKSUM_SHA256, bytes);
+
+  for (l = display->clipboard_history; l; l = l->next)
+    {
+      entry = l->data;
+
+      if (g_str_equal (entry->checksum, checksum) &&
+          g_str_equal (entry->mimetype, mimetype) &&
+          g_bytes_get_size (entry->content) == g_bytes_get_size (bytes))
+        {
+          display->clipboard_history =
+            g_list_remove_link (display->clipboard_history, l);
+          display->clipboard_history =
+            g_list_concat (l, display->clipboard_history);
+          return entry;
+        }
+    }
+
+  content = map_anonymous_copy (bytes, error);
+  if (!content)
+    return NULL;
+
+  entry = g_new0 (MetaClipboardEntry, 1);
+  entry->mimetype = g_strdup (mimetype);
+  entry->checksum = g_steal_pointer (&checksum);
+  entry->content = content;
+
+  display->clipboard_history =
+    g_list_prepend (display->clipboard_history, entry);
+  trim_clipboard_history (display);
+
+  return entry;
+}
+
 static void
 transfer_cb (MetaSelection *selection,
              GAsyncResult  *result,
              GOutputStream *output)
 {
   MetaDisplay *display = meta_get_display ();
+  MetaClipboardEntry *entry;
   GError *error = NULL;
+  g_autoptr (GBytes) bytes = NULL;
 
   if (!meta_selection_transfer_finish (selection, result, &error))
     {
@@ -80,9 +223,27 @@ transfer_cb (MetaSelection *selection,
     }
 
   g_output_stream_close (output, NULL, NULL);
-  display->saved_clipboard =
+  bytes =
     g_memory_output_stream_steal_as_bytes (G_MEMORY_OUTPUT_STREAM (output));
   g_object_unref (output);
+
+  if (!display->saved_clipboard_mimetype)
+    return;
+
+  entry = store_clipboard_entry (display,
+                                 display->saved_clipboard_mimetype,
+                                 bytes,
+                                 &error);
+  if (!entry)
+    {
+      g_warning ("Failed to store clipboard in anonymous file: %s",
+                 error->message);
+      g_error_free (error);
+      display->saved_clipboard = g_steal_pointer (&bytes);
+      return;
+    }
+
+  display->saved_clipboard = g_bytes_ref (entry->content);
 }
 
 static void
@@ -174,6 +335,8 @@ meta_clipboard_manager_shutdown (MetaDisplay *display)
   g_clear_object (&display->selection_source);
   g_clear_pointer (&display->saved_clipboard, g_bytes_unref);
   g_clear_pointer (&display->saved_clipboard_mimetype, g_free);
+  g_list_free_full (g_steal_pointer (&display->clipboard_history),
+                    (GDestroyNotify) clipboard_entry_free);
   selection = meta_display_get_selection (display);
   g_signal_handlers_disconnect_by_func (selection, owner_changed_cb, display);
 }
@@ -24,6 +24,13 @@
 
 #include "core/display-private.h"
 
+typedef struct _MetaClipboardEntry
+{
+  char *mimetype;
+  char *checksum;
+  GBytes *content;
+} MetaClipboardEntry;
+
 void meta_clipboard_manager_init     (MetaDisplay *display);
 void meta_clipboard_manager_shutdown (MetaDisplay *display);
 
@@ -21,9 +21,23 @@
 
 #include "config.h"
 
+#ifdef HAVE_SPLICE
+#include <errno.h>
+#include <fcntl.h>
+#include <gio/gunixinputstream.h>
+#include <gio/gunixoutputstream.h>
+#include <glib-unix.h>
+#endif
+
 #include "core/meta-selection-private.h"
 #include "meta/meta-selection.h"
 
+/* Upper bound of a single splice(2) call, and the number of calls done
+ * per main loop dispatch before yielding to other sources.
+ */
+#define SPLICE_CHUNK_SIZE (64 * 1024)
+#define MAX_SPLICES_PER_DISPATCH 16
+
 typedef struct TransferRequest TransferRequest;
 
 struct _MetaSelection
@@ -43,6 +57,8 @@ struct TransferRequest
   GCancellable *cancellable;
   GCancellable *external_cancellable;
   gulong cancellable_signal_handler;
+  GSource *splice_source;
+  gboolean spliced;
 };
 
 enum
@@ -255,6 +271,12 @@ transfer_request_free (TransferRequest *request)
       g_clear_pointer (&request->timeout_source, g_source_unref);
     }
 
+  if (request->splice_source)
+    {
+      g_source_destroy (request->splice_source);
+      g_clear_pointer (&request->splice_source, g_source_unref);
+    }
+
   g_clear_object (&request->cancellable);
   g_clear_object (&request->istream);
   g_clear_object (&request->ostream);
@@ -366,6 +388,206 @@ read_selection_source_async (GTask           *task,
                                    task);
 }
 
+#ifdef HAVE_SPLICE
+static gboolean splice_fds_cb (GObject *pollable_stream,
+                               GTask   *task);
+
+static void
+watch_splice_stream (GTask   *task,
+                     GObject *stream)
+{
+  TransferRequest *request = g_task_get_task_data (task);
+  GCancellable *cancellable = request->cancellable;
+  GSource *source;
+
+  if (request->splice_source)
+    {
+      g_source_destroy (request->splice_source);
+      g_clear_pointer (&request->splice_source, g_source_unref);
+    }
+
+  if (G_IS_POLLABLE_INPUT_STREAM (stream))
+    {
+      source =
+        g_pollable_input_stream_create_source (G_POLLABLE_INPUT_STREAM (stream),
+                                               cancellable);
+    }
+  else
+    {
+      source =
+        g_pollable_output_stream_create_source (G_POLLABLE_OUTPUT_STREAM (stream),
+                                                cancellable);
+    }
+
+  g_source_set_callback (source, (GSourceFunc) splice_fds_cb, task, NULL);
+  g_source_attach (source, NULL);
+  request->splice_source = source;
+}
+
+static void
+finish_splice_fds (GTask  *task,
+                   GError *error)
+{
+  TransferRequest *request = g_task_get_task_data (task);
+
+  if (request->splice_source)
+    {
+      g_source_destroy (request->splice_source);
+      g_clear_pointer (&request->splice_source, g_source_unref);
+    }
+
+  if (request->len < 0)
+    {
+      g_input_stream_close (request->istream, NULL, NULL);
+      g_output_stream_close (request->ostream, NULL, NULL);
+    }
+
+  if (error)
+    g_task_return_error (task, error);
+  else
+    g_task_return_boolean (task, TRUE);
+
+  g_object_unref (task);
+}
+
+static void
+fallback_to_stream_copy (GTask *task)
+{
+  TransferRequest *request = g_task_get_task_data (task);
+
+  if (request->splice_source)
+    {
+      g_source_destroy (request->splice_source);
+      g_clear_pointer (&request->splice_source, g_source_unref);
+    }
+
+  if (request->len < 0)
+    {
+      g_output_stream_splice_async (request->ostream,
+                                    request->istream,
+                                    G_OUTPUT_STREAM_SPLICE_CLOSE_SOURCE |
+                                    G_OUTPUT_STREAM_SPLICE_CLOSE_TARGET,
+                                    G_PRIORITY_DEFAULT,
+                                    g_task_get_cancellable (task),
+                                    (GAsyncReadyCallback) splice_cb,
+                                    task);
+    }
+  else
+    {
+      read_selection_source_async (task, request);
+    }
+}
+
+static gboolean
+splice_fds_cb (GObject *pollable_stream,
+               GTask   *task)
+{
+  TransferRequest *request = g_task_get_task_data (task);
+  GError *error = NULL;
+  int in_fd, out_fd;
+  int i;
+
+  /* The request cancellable also fires on the transfer timeout, so a
+   * peer that stops reading or writing can't stall the transfer forever.
+   */
+  if (g_cancellable_set_error_if_cancelled (request->cancellable, &error))
+    {
+      finish_splice_fds (task, error);
+      return G_SOURCE_REMOVE;
+    }
+
+  in_fd = g_unix_input_stream_get_fd (G_UNIX_INPUT_STREAM (request->istream));
+  out_fd =
+    g_unix_output_stream_get_fd (G_UNIX_OUTPUT_STREAM (request->ostream));
+
+  for (i = 0; i < MAX_SPLICES_PER_DISPATCH; i++)
+    {
+      size_t chunk_size = SPLICE_CHUNK_SIZE;
+      ssize_t n_spliced;
+
+      if (request->len == 0)
+        {
+          finish_splice_fds (task, NULL);
+          return G_SOURCE_REMOVE;
+        }
+
+      if (request->len > 0)
+        chunk_size = MIN (chunk_size, (size_t) request->len);
+
+      n_spliced = splice (in_fd, NULL, out_fd, NULL, chunk_size,
+                          SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+      if (n_spliced > 0)
+        {
+          request->spliced = TRUE;
+          if (request->len > 0)
+            request->len -= n_spliced;
+          continue;
+        }
+      else if (n_spliced == 0)
+        {
+          finish_splice_fds (task, NULL);
+          return G_SOURCE_REMOVE;
+        }
+
+      if (errno == EINTR)
+        continue;
+
+      if (errno == EAGAIN)
+        {
+          GPollableInputStream *istream =
+            G_POLLABLE_INPUT_STREAM (request->istream);
+
+          /* splice(2) does not tell which end would block, so find out
+           * ourselves and sleep on that one.
+           */
+          if (g_pollable_input_stream_is_readable (istream))
+            watch_splice_stream (task, G_OBJECT (request->ostream));
+          else
+            watch_splice_stream (task, G_OBJECT (request->istream));
+
+          return G_SOURCE_REMOVE;
+        }
+
+      if (errno == EINVAL && !request->spliced)
+        {
+          /* Neither end is a pipe, use the regular copy path */
+          fallback_to_stream_copy (task);
+          return G_SOURCE_REMOVE;
+        }
+
+      error = g_error_new (G_IO_ERROR, g_io_error_from_errno (errno),
+                           "Failed to splice selection contents: %s",
+                           g_strerror (errno));
+      finish_splice_fds (task, error);
+      return G_SOURCE_REMOVE;
+    }
+
+  return G_SOURCE_CONTINUE;
+}
+
+static gboolean
+try_splice_fds_async (GTask           *task,
+                      TransferRequest *request)
+{
+  int in_fd, out_fd;
+
+  if (!G_IS_UNIX_INPUT_STREAM (request->istream) ||
+      !G_IS_UNIX_OUTPUT_STREAM (request->ostream))
+    return FALSE;
+
+  in_fd = g_unix_input_stream_get_fd (G_UNIX_INPUT_STREAM (request->istream));
+  out_fd =
+    g_unix_output_stream_get_fd (G_UNIX_OUTPUT_STREAM (request->ostream));
+  if (!g_unix_set_fd_nonblocking (in_fd, TRUE, NULL) ||
+      !g_unix_set_fd_nonblocking (out_fd, TRUE, NULL))
+    return FALSE;
+
+  watch_splice_stream (task, G_OBJECT (request->istream));
+
+  return TRUE;
+}
+#endif /* HAVE_SPLICE */
+
 static void
 source_read_cb (MetaSelectionSource *source,
                 GAsyncResult        *result,
@@ -386,6 +608,15 @@ source_read_cb (MetaSelectionSource *source,
   request = g_task_get_task_data (task);
   request->istream = stream;
 
+#ifdef HAVE_SPLICE
+  /* If both ends are file descriptors (e.g. a Wayland data source read
+   * by a Wayland client), let the kernel move the pages instead of
+   * bouncing them through user space buffers.
+   */
+  if (try_splice_fds_async (task, request))
+    return;
+#endif
+
   if (request->len < 0)
     {
       g_output_stream_splice_async (request->ostream,
@@ -2,6 +2,47 @@
 
 #include "tests/clutter-test-utils.h"
 
+#define TEST_TYPE_ACTOR         (test_actor_get_type ())
+
+typedef struct _TestActor               TestActor;
+typedef struct _ClutterActorClass       TestActorClass;
+
+struct _TestActor
+{
+  ClutterActor parent_instance;
+
+  int n_empty_allocations;
+};
+
+GType test_actor_get_type (void);
+
+G_DEFINE_TYPE (TestActor, test_actor, CLUTTER_TYPE_ACTOR);
+
+static void
+test_actor_allocate (ClutterActor          *self,
+                     const ClutterActorBox *box)
+{
+  TestActor *test = (TestActor *) self;
+
+  if (clutter_actor_box_get_area (box) == 0.f)
+    test->n_empty_allocations++;
+
+  CLUTTER_ACTOR_CLASS (test_actor_parent_class)->allocate (self, box);
+}
+
+static void
+test_actor_class_init (TestActorClass *klass)
+{
+  ClutterActorClass *actor_class = CLUTTER_ACTOR_CLASS (klass);
+
+  actor_class->allocate = test_actor_allocate;
+}
+
+static void
+test_actor_init (TestActor *self)
+{
+}
+
 static void
 actor_basic_layout (void)
 {
@@ -92,7 +133,115 @@ actor_margin_layout (void)
   clutter_actor_destroy (vase);
 }
 
+static void
+on_queue_relayout (ClutterActor *actor,
+                   int          *n_queued)
+{
+  (*n_queued)++;
+}
+
+static void
+relayout_boundary_unallocated (void)
+{
+  ClutterActor *stage = clutter_test_get_stage ();
+  ClutterActor *vase;
+  ClutterActor *shelf;
+  ClutterActor *flower;
+  ClutterActorBox allocation;
+  graphene_point_t p;
+
+  vase = clutter_actor_new ();
+  clutter_actor_set_name (vase, "Vase");
+  clutter_actor_set_layout_manager (vase, clutter_box_layout_new ());
+  clutter_actor_add_child (stage, vase);
+
+  graphene_point_init (&p, 50, 50);
+  clutter_test_assert_actor_at_point (stage, &p, stage);
+
+  /* Mapped with a fixed size, but not allocated yet: the shelf can't be
+   * a relayout boundary, as there is no allocation box to reuse.
+   */
+  shelf = g_object_new (TEST_TYPE_ACTOR, NULL);
+  clutter_actor_set_name (shelf, "Shelf");
+  clutter_actor_set_size (shelf, 300, 100);
+  clutter_actor_set_layout_manager (shelf, clutter_box_layout_new ());
+  clutter_actor_add_child (vase, shelf);
+  g_assert_true (clutter_actor_is_mapped (shelf));
+
+  flower = clutter_actor_new ();
+  clutter_actor_set_background_color (flower, CLUTTER_COLOR_Red);
+  clutter_actor_set_size (flower, 100, 100);
+  clutter_actor_set_name (flower, "Red Flower");
+  clutter_actor_add_child (shelf, flower);
+
+  clutter_test_assert_actor_at_point (stage, &p, flower);
+
+  clutter_actor_get_allocation_box (shelf, &allocation);
+  g_assert_cmpfloat (clutter_actor_box_get_width (&allocation), ==, 300);
+  g_assert_cmpfloat (clutter_actor_box_get_height (&allocation), ==, 100);
+  g_assert_cmpint (((TestActor *) shelf)->n_empty_allocations, ==, 0);
+
+  clutter_actor_destroy (vase);
+}
+
+static void
+actor_relayout_boundary (void)
+{
+  ClutterActor *stage = clutter_test_get_stage ();
+  ClutterActor *vase;
+  ClutterActor *shelf;
+  ClutterActor *flower[2];
+  graphene_point_t p;
+  int n_queued = 0;
+
+  vase = clutter_actor_new ();
+  clutter_actor_set_name (vase, "Vase");
+  clutter_actor_set_layout_manager (vase, clutter_box_layout_new ());
+  clutter_actor_add_child (stage, vase);
+
+  /* fixed size, so its children can't affect the layout of the vase */
+  shelf = clutter_actor_new ();
+  clutter_actor_set_name (shelf, "Shelf");
+  clutter_actor_set_size (shelf, 300, 100);
+  clutter_actor_set_layout_manager (shelf, clutter_box_layout_new ());
+  clutter_actor_add_child (vase, shelf);
+
+  flower[0] = clutter_actor_new ();
+  clutter_actor_set_background_color (flower[0], CLUTTER_COLOR_Red);
+  clutter_actor_set_size (flower[0], 100, 100);
+  clutter_actor_set_name (flower[0], "Red Flower");
+  clutter_actor_add_child (shelf, flower[0]);
+
+  flower[1] = clutter_actor_new ();
+  clutter_actor_set_background_color (flower[1], CLUTTER_COLOR_Yellow);
+  clutter_actor_set_size (flower[1], 100, 100);
+  clutter_actor_set_name (flower[1], "Yellow Flower");
+  clutter_actor_add_child (shelf, flower[1]);
+
+  graphene_point_init (&p, 150, 50);
+  clutter_test_assert_actor_at_point (stage, &p, flower[1]);
+
+  g_signal_connect (vase, "queue-relayout",
+                    G_CALLBACK (on_queue_relayout), &n_queued);
+
+  /* The relayout stops at the shelf, which is still allocated again */
+  clutter_actor_set_width (flower[0], 200);
+
+  graphene_point_init (&p, 250, 50);
+  clutter_test_assert_actor_at_point (stage, &p, flower[1]);
+  g_assert_cmpint (n_queued, ==, 0);
+
+  /* Resizing the shelf itself must still relayout the vase */
+  clutter_actor_set_width (shelf, 350);
+  g_assert_cmpint (n_queued, ==, 1);
+
+  clutter_actor_destroy (vase);
+
+  relayout_boundary_unallocated ();
+}
+
 CLUTTER_TEST_SUITE (
   CLUTTER_TEST_UNIT ("/actor/layout/basic", actor_basic_layout)
   CLUTTER_TEST_UNIT ("/actor/layout/margin", actor_margin_layout)
+  CLUTTER_TEST_UNIT ("/actor/layout/relayout-boundary", actor_relayout_boundary)
 )
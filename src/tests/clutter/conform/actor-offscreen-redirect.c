@@ -447,6 +447,91 @@ actor_offscreen_redirect (void)
   clutter_actor_destroy (data.unrelated_actor);
 }
 
+typedef struct
+{
+  ClutterActor *stage;
+  FooActor *foo_actor;
+  ClutterEffect *effect;
+  gboolean was_painted;
+} EffectCacheData;
+
+static void
+verify_effect_paint_count (EffectCacheData *data,
+                           int              expected_paint_count)
+{
+  guchar *pixel;
+
+  data->foo_actor->paint_count = 0;
+
+  pixel = clutter_stage_read_pixels (CLUTTER_STAGE (data->stage),
+                                     50, 50, /* x/y */
+                                     1, 1 /* width/height */);
+  g_free (pixel);
+
+  g_assert_cmpint (expected_paint_count, ==, data->foo_actor->paint_count);
+}
+
+static gboolean
+run_verify_effect_cache (gpointer user_data)
+{
+  EffectCacheData *data = user_data;
+
+  /* The first paint fills the offscreen buffer */
+  verify_effect_paint_count (data, 1);
+
+  /* Nothing changed, the cached contents should be used */
+  verify_effect_paint_count (data, 0);
+
+  /* Opacity is applied when painting the offscreen buffer */
+  clutter_actor_set_opacity (CLUTTER_ACTOR (data->foo_actor), 127);
+  verify_effect_paint_count (data, 0);
+
+  /* Changing the effect's uniforms reuses the cached contents */
+  clutter_desaturate_effect_set_factor (CLUTTER_DESATURATE_EFFECT (data->effect),
+                                        0.5);
+  verify_effect_paint_count (data, 0);
+
+  /* Invalidating the effect paints the actor again, once */
+  clutter_offscreen_effect_invalidate (CLUTTER_OFFSCREEN_EFFECT (data->effect));
+  verify_effect_paint_count (data, 1);
+  verify_effect_paint_count (data, 0);
+
+  /* The actor's contents changed */
+  clutter_actor_queue_redraw (CLUTTER_ACTOR (data->foo_actor));
+  verify_effect_paint_count (data, 1);
+
+  data->was_painted = TRUE;
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+actor_offscreen_effect_cache (void)
+{
+  EffectCacheData data = { 0 };
+
+  data.stage = clutter_test_get_stage ();
+  data.foo_actor = g_object_new (foo_actor_get_type (), NULL);
+  clutter_actor_set_size (CLUTTER_ACTOR (data.foo_actor), 100, 100);
+  clutter_actor_add_child (data.stage, CLUTTER_ACTOR (data.foo_actor));
+
+  data.effect = clutter_desaturate_effect_new (1.0);
+  clutter_actor_add_effect (CLUTTER_ACTOR (data.foo_actor), data.effect);
+
+  clutter_actor_show (data.stage);
+
+  clutter_threads_add_repaint_func_full (CLUTTER_REPAINT_FLAGS_POST_PAINT,
+                                         run_verify_effect_cache,
+                                         &data,
+                                         NULL);
+
+  while (!data.was_painted)
+    g_main_context_iteration (NULL, FALSE);
+
+  clutter_actor_destroy (CLUTTER_ACTOR (data.foo_actor));
+}
+
 CLUTTER_TEST_SUITE (
   CLUTTER_TEST_UNIT ("/actor/offscreen/redirect", actor_offscreen_redirect)
+  CLUTTER_TEST_UNIT ("/actor/offscreen/effect-cache", actor_offscreen_effect_cache)
 )
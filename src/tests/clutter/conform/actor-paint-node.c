@@ -0,0 +1,230 @@
+#define CLUTTER_DISABLE_DEPRECATION_WARNINGS
+#include <clutter/clutter.h>
+
+#include "tests/clutter-test-utils.h"
+
+typedef struct _FooActor
+{
+  ClutterActor parent;
+
+  int paint_count;
+  int paint_node_count;
+} FooActor;
+
+typedef struct _FooActorClass
+{
+  ClutterActorClass parent_class;
+} FooActorClass;
+
+static GType foo_actor_get_type (void);
+
+G_DEFINE_TYPE (FooActor, foo_actor, CLUTTER_TYPE_ACTOR)
+
+static void
+foo_actor_paint (ClutterActor        *actor,
+                 ClutterPaintContext *paint_context)
+{
+  FooActor *foo_actor = (FooActor *) actor;
+
+  foo_actor->paint_count++;
+
+  CLUTTER_ACTOR_CLASS (foo_actor_parent_class)->paint (actor, paint_context);
+}
+
+static void
+foo_actor_paint_node (ClutterActor     *actor,
+                      ClutterPaintNode *root)
+{
+  FooActor *foo_actor = (FooActor *) actor;
+
+  foo_actor->paint_node_count++;
+}
+
+static void
+foo_actor_class_init (FooActorClass *klass)
+{
+  ClutterActorClass *actor_class = CLUTTER_ACTOR_CLASS (klass);
+
+  actor_class->paint = foo_actor_paint;
+  actor_class->paint_node = foo_actor_paint_node;
+}
+
+static void
+foo_actor_init (FooActor *self)
+{
+}
+
+/* An image counting how often its paint nodes are built */
+typedef struct _TestImage
+{
+  ClutterImage parent_instance;
+} TestImage;
+
+typedef struct _TestImageClass
+{
+  ClutterImageClass parent_class;
+} TestImageClass;
+
+static GType test_image_get_type (void);
+
+static ClutterContentInterface *parent_content_iface;
+static int n_content_paints;
+
+static void
+test_image_paint_content (ClutterContent      *content,
+                          ClutterActor        *actor,
+                          ClutterPaintNode    *root,
+                          ClutterPaintContext *paint_context)
+{
+  n_content_paints++;
+
+  parent_content_iface->paint_content (content, actor, root, paint_context);
+}
+
+static void
+test_image_content_iface_init (ClutterContentInterface *iface)
+{
+  parent_content_iface = g_type_interface_peek_parent (iface);
+
+  iface->paint_content = test_image_paint_content;
+}
+
+G_DEFINE_TYPE_WITH_CODE (TestImage, test_image, CLUTTER_TYPE_IMAGE,
+                         G_IMPLEMENT_INTERFACE (CLUTTER_TYPE_CONTENT,
+                                                test_image_content_iface_init))
+
+static void
+test_image_class_init (TestImageClass *klass)
+{
+}
+
+static void
+test_image_init (TestImage *self)
+{
+}
+
+static void
+verify_paint (FooActor *foo_actor,
+              gboolean  expect_rebuilt)
+{
+  ClutterActor *stage = clutter_test_get_stage ();
+  GMainLoop *main_loop = g_main_loop_new (NULL, TRUE);
+  gulong paint_handler;
+
+  paint_handler = g_signal_connect_data (CLUTTER_STAGE (stage),
+                                         "after-paint",
+                                         G_CALLBACK (g_main_loop_quit),
+                                         main_loop,
+                                         NULL,
+                                         G_CONNECT_SWAPPED);
+
+  /* Only queue a redraw on the stage, the actor is painted again as part
+   * of it without having queued a redraw itself */
+  clutter_actor_queue_redraw (stage);
+
+  foo_actor->paint_count = 0;
+  foo_actor->paint_node_count = 0;
+  n_content_paints = 0;
+
+  g_main_loop_run (main_loop);
+
+  g_clear_signal_handler (&paint_handler, stage);
+  g_main_loop_unref (main_loop);
+
+  g_assert_cmpint (foo_actor->paint_count, ==, 1);
+  g_assert_cmpint (n_content_paints, ==, expect_rebuilt ? 1 : 0);
+
+  /* Nodes from a paint_node() override are never retained */
+  g_assert_cmpint (foo_actor->paint_node_count, ==, 1);
+}
+
+static void
+actor_paint_node_retained (void)
+{
+  ClutterActor *stage = clutter_test_get_stage ();
+  ClutterActor *container;
+  ClutterContent *image;
+  FooActor *foo_actor;
+  ClutterActor *actor;
+
+  container = clutter_actor_new ();
+  clutter_actor_add_child (stage, container);
+
+  foo_actor = g_object_new (foo_actor_get_type (), NULL);
+  actor = CLUTTER_ACTOR (foo_actor);
+  clutter_actor_set_size (actor, 50, 50);
+  clutter_actor_set_background_color (actor, CLUTTER_COLOR_Red);
+  image = g_object_new (test_image_get_type (), NULL);
+  clutter_actor_set_content (actor, image);
+  g_object_unref (image);
+  clutter_actor_add_child (container, actor);
+
+  clutter_actor_show (stage);
+
+  verify_paint (foo_actor, TRUE);
+  verify_paint (foo_actor, FALSE);
+
+  clutter_actor_set_background_color (actor, CLUTTER_COLOR_Blue);
+  verify_paint (foo_actor, TRUE);
+  verify_paint (foo_actor, FALSE);
+
+  clutter_actor_set_size (actor, 60, 60);
+  verify_paint (foo_actor, TRUE);
+  verify_paint (foo_actor, FALSE);
+
+  clutter_actor_set_opacity (actor, 128);
+  verify_paint (foo_actor, TRUE);
+  verify_paint (foo_actor, FALSE);
+
+  /* The paint opacity is baked into the nodes, so changing it from a
+   * parent has to rebuild them as well */
+  clutter_actor_set_opacity (container, 128);
+  verify_paint (foo_actor, TRUE);
+  verify_paint (foo_actor, FALSE);
+
+  image = g_object_new (test_image_get_type (), NULL);
+  clutter_actor_set_content (actor, image);
+  verify_paint (foo_actor, TRUE);
+  verify_paint (foo_actor, FALSE);
+
+  clutter_content_invalidate (image);
+  verify_paint (foo_actor, TRUE);
+  verify_paint (foo_actor, FALSE);
+
+  clutter_actor_hide (actor);
+  clutter_actor_show (actor);
+  verify_paint (foo_actor, TRUE);
+  verify_paint (foo_actor, FALSE);
+
+  clutter_actor_destroy (container);
+  g_object_unref (image);
+}
+
+static void
+actor_paint_node_override (void)
+{
+  ClutterActor *stage = clutter_test_get_stage ();
+  FooActor *foo_actor;
+  ClutterActor *actor;
+  int i;
+
+  foo_actor = g_object_new (foo_actor_get_type (), NULL);
+  actor = CLUTTER_ACTOR (foo_actor);
+  clutter_actor_set_size (actor, 50, 50);
+  clutter_actor_set_background_color (actor, CLUTTER_COLOR_Red);
+  clutter_actor_add_child (stage, actor);
+
+  clutter_actor_show (stage);
+
+  /* Without content there is nothing to rebuild, but the paint_node()
+   * override still has to be called on every frame */
+  for (i = 0; i < 3; i++)
+    verify_paint (foo_actor, FALSE);
+
+  clutter_actor_destroy (actor);
+}
+
+CLUTTER_TEST_SUITE (
+  CLUTTER_TEST_UNIT ("/actor/paint-node/retained", actor_paint_node_retained);
+  CLUTTER_TEST_UNIT ("/actor/paint-node/override", actor_paint_node_override)
+)
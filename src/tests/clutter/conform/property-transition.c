@@ -0,0 +1,311 @@
+#define CLUTTER_DISABLE_DEPRECATION_WARNINGS
+#include <clutter/clutter.h>
+
+#include "tests/clutter-test-utils.h"
+
+#define TEST_DURATION_MS 1000
+#define TEST_STEP_MS 125
+
+/* An actor implementing ClutterAnimatable on its own, which makes
+ * property transitions go through the generic GValue path rather than
+ * writing the actor properties directly */
+typedef struct _TestAnimatableActor
+{
+  ClutterActor parent_instance;
+} TestAnimatableActor;
+
+typedef struct _TestAnimatableActorClass
+{
+  ClutterActorClass parent_class;
+} TestAnimatableActorClass;
+
+static GType test_animatable_actor_get_type (void);
+
+static ClutterAnimatableInterface *parent_animatable_iface;
+
+static void
+test_animatable_actor_set_final_state (ClutterAnimatable *animatable,
+                                       const char        *property_name,
+                                       const GValue      *value)
+{
+  parent_animatable_iface->set_final_state (animatable, property_name, value);
+}
+
+static void
+test_animatable_actor_animatable_iface_init (ClutterAnimatableInterface *iface)
+{
+  parent_animatable_iface = g_type_interface_peek_parent (iface);
+
+  iface->set_final_state = test_animatable_actor_set_final_state;
+}
+
+G_DEFINE_TYPE_WITH_CODE (TestAnimatableActor, test_animatable_actor,
+                         CLUTTER_TYPE_ACTOR,
+                         G_IMPLEMENT_INTERFACE (CLUTTER_TYPE_ANIMATABLE,
+                                                test_animatable_actor_animatable_iface_init))
+
+static void
+test_animatable_actor_class_init (TestAnimatableActorClass *klass)
+{
+}
+
+static void
+test_animatable_actor_init (TestAnimatableActor *self)
+{
+}
+
+typedef struct
+{
+  const char *property_name;
+  GType value_type;
+  double from;
+  double to;
+} TransitionTest;
+
+static void
+set_interval_value (GValue *value,
+                    GType   value_type,
+                    double  number)
+{
+  g_value_init (value, value_type);
+
+  switch (value_type)
+    {
+    case G_TYPE_FLOAT:
+      g_value_set_float (value, (float) number);
+      break;
+    case G_TYPE_DOUBLE:
+      g_value_set_double (value, number);
+      break;
+    case G_TYPE_UINT:
+      g_value_set_uint (value, (unsigned int) number);
+      break;
+    default:
+      g_assert_not_reached ();
+    }
+}
+
+static ClutterTransition *
+create_transition (ClutterActor   *actor,
+                   TransitionTest *test)
+{
+  ClutterTransition *transition;
+  GValue from = G_VALUE_INIT;
+  GValue to = G_VALUE_INIT;
+
+  set_interval_value (&from, test->value_type, test->from);
+  set_interval_value (&to, test->value_type, test->to);
+
+  transition = clutter_property_transition_new (test->property_name);
+  clutter_timeline_set_duration (CLUTTER_TIMELINE (transition),
+                                 TEST_DURATION_MS);
+  clutter_transition_set_from_value (transition, &from);
+  clutter_transition_set_to_value (transition, &to);
+  clutter_transition_set_animatable (transition, CLUTTER_ANIMATABLE (actor));
+
+  g_value_unset (&from);
+  g_value_unset (&to);
+
+  return transition;
+}
+
+static void
+notify_cb (GObject    *object,
+           GParamSpec *pspec,
+           int        *n_notifies)
+{
+  (*n_notifies)++;
+}
+
+static void
+property_transition_direct (void)
+{
+  TransitionTest tests[] = {
+    { "x", G_TYPE_FLOAT, 10.0, 250.0 },
+    { "opacity", G_TYPE_UINT, 0.0, 255.0 },
+    { "scale-x", G_TYPE_DOUBLE, 0.5, 2.0 },
+  };
+  unsigned int i;
+
+  for (i = 0; i < G_N_ELEMENTS (tests); i++)
+    {
+      TransitionTest *test = &tests[i];
+      g_autofree char *signal_name = NULL;
+      ClutterActor *actor, *generic_actor;
+      ClutterTransition *transition, *generic_transition;
+      int n_notifies = 0, n_generic_notifies = 0;
+      unsigned int elapsed;
+
+      actor = clutter_actor_new ();
+      generic_actor = g_object_new (test_animatable_actor_get_type (), NULL);
+      g_object_ref_sink (actor);
+      g_object_ref_sink (generic_actor);
+
+      signal_name = g_strdup_printf ("notify::%s", test->property_name);
+      g_signal_connect (actor, signal_name,
+                        G_CALLBACK (notify_cb), &n_notifies);
+      g_signal_connect (generic_actor, signal_name,
+                        G_CALLBACK (notify_cb), &n_generic_notifies);
+
+      transition = create_transition (actor, test);
+      generic_transition = create_transition (generic_actor, test);
+
+      for (elapsed = 0; elapsed <= TEST_DURATION_MS; elapsed += TEST_STEP_MS)
+        {
+          GValue value = G_VALUE_INIT;
+          GValue generic_value = G_VALUE_INIT;
+
+          clutter_timeline_advance (CLUTTER_TIMELINE (transition), elapsed);
+          clutter_timeline_advance (CLUTTER_TIMELINE (generic_transition),
+                                    elapsed);
+          g_signal_emit_by_name (transition, "new-frame", (int) elapsed);
+          g_signal_emit_by_name (generic_transition, "new-frame",
+                                 (int) elapsed);
+
+          g_object_get_property (G_OBJECT (actor),
+                                 test->property_name, &value);
+          g_object_get_property (G_OBJECT (generic_actor),
+                                 test->property_name, &generic_value);
+
+          g_assert_true (g_param_values_cmp (
+            g_object_class_find_property (G_OBJECT_GET_CLASS (actor),
+                                          test->property_name),
+            &value, &generic_value) == 0);
+
+          g_value_unset (&value);
+          g_value_unset (&generic_value);
+        }
+
+      g_assert_cmpint (n_notifies, >, 0);
+      g_assert_cmpint (n_notifies, ==, n_generic_notifies);
+
+      g_object_unref (transition);
+      g_object_unref (generic_transition);
+      clutter_actor_destroy (actor);
+      clutter_actor_destroy (generic_actor);
+      g_object_unref (actor);
+      g_object_unref (generic_actor);
+    }
+}
+
+static gboolean
+new_frame_hook (GSignalInvocationHint *ihint,
+                unsigned int           n_param_values,
+                const GValue          *param_values,
+                gpointer               user_data)
+{
+  int *n_new_frames = user_data;
+
+  (*n_new_frames)++;
+
+  return TRUE;
+}
+
+static void
+property_transition_new_frame_hook (void)
+{
+  ClutterActor *stage = clutter_test_get_stage ();
+  ClutterActor *actor;
+  ClutterTransition *transition;
+  int n_new_frames = 0;
+  unsigned int signal_id;
+  gulong hook_id;
+
+  actor = clutter_actor_new ();
+  clutter_actor_set_size (actor, 50, 50);
+  clutter_actor_add_child (stage, actor);
+  clutter_actor_show (stage);
+
+  signal_id = g_signal_lookup ("new-frame", CLUTTER_TYPE_TIMELINE);
+  hook_id = g_signal_add_emission_hook (signal_id, 0,
+                                        new_frame_hook, &n_new_frames,
+                                        NULL);
+
+  /* Nothing is connected to the transition, the emission hook still
+   * has to see every frame of it */
+  clutter_actor_save_easing_state (actor);
+  clutter_actor_set_easing_duration (actor, 100);
+  clutter_actor_set_x (actor, 100);
+  clutter_actor_restore_easing_state (actor);
+
+  transition = clutter_actor_get_transition (actor, "x");
+  g_assert_nonnull (transition);
+  g_signal_connect_swapped (transition, "completed",
+                            G_CALLBACK (clutter_test_quit), NULL);
+  clutter_test_main ();
+
+  g_assert_cmpint (n_new_frames, >, 0);
+
+  g_signal_remove_emission_hook (signal_id, hook_id);
+  clutter_actor_destroy (actor);
+}
+
+static void
+has_pointer_cb (ClutterActor *actor)
+{
+  if (clutter_actor_has_pointer (actor))
+    clutter_test_quit ();
+}
+
+static void
+wait_for_pointer (ClutterActor *actor)
+{
+  gulong notify_id;
+
+  if (clutter_actor_has_pointer (actor))
+    return;
+
+  notify_id = g_signal_connect (actor, "notify::has-pointer",
+                                G_CALLBACK (has_pointer_cb), NULL);
+  clutter_test_main ();
+  g_signal_handler_disconnect (actor, notify_id);
+}
+
+static void
+property_transition_repick (void)
+{
+  ClutterActor *stage = clutter_test_get_stage ();
+  ClutterVirtualInputDevice *pointer;
+  ClutterActor *below, *moving;
+  ClutterSeat *seat;
+
+  below = clutter_actor_new ();
+  clutter_actor_set_reactive (below, TRUE);
+  clutter_actor_set_position (below, 100, 0);
+  clutter_actor_set_size (below, 100, 100);
+  clutter_actor_add_child (stage, below);
+
+  moving = clutter_actor_new ();
+  clutter_actor_set_reactive (moving, TRUE);
+  clutter_actor_set_size (moving, 100, 100);
+  clutter_actor_add_child (stage, moving);
+
+  clutter_actor_show (stage);
+
+  seat = clutter_backend_get_default_seat (clutter_get_default_backend ());
+  pointer = clutter_seat_create_virtual_device (seat, CLUTTER_POINTER_DEVICE);
+  clutter_virtual_input_device_notify_absolute_motion (pointer, 0, 150, 50);
+  wait_for_pointer (below);
+
+  /* Moving an actor under the pointer without the pointer itself moving
+   * has to hand the pointer over once the animation has run */
+  clutter_actor_save_easing_state (moving);
+  clutter_actor_set_easing_duration (moving, 100);
+  clutter_actor_set_x (moving, 100);
+  clutter_actor_restore_easing_state (moving);
+
+  wait_for_pointer (moving);
+
+  g_assert_true (clutter_actor_has_pointer (moving));
+  g_assert_false (clutter_actor_has_pointer (below));
+
+  g_object_unref (pointer);
+  clutter_actor_destroy (moving);
+  clutter_actor_destroy (below);
+}
+
+CLUTTER_TEST_SUITE (
+  CLUTTER_TEST_UNIT ("/property-transition/direct", property_transition_direct);
+  CLUTTER_TEST_UNIT ("/property-transition/new-frame-hook", property_transition_new_frame_hook);
+  CLUTTER_TEST_UNIT ("/property-transition/repick", property_transition_repick)
+)
@@ -547,6 +547,72 @@ text_idempotent_use_markup (void)
   clutter_actor_destroy (CLUTTER_ACTOR (text));
 }
 
+static void
+text_shared_layout (void)
+{
+  ClutterText *labels[3];
+  ClutterText *entry;
+  PangoLayout *layout;
+  PangoContext *shared_context;
+  int i;
+
+  for (i = 0; i < G_N_ELEMENTS (labels); i++)
+    {
+      labels[i] = CLUTTER_TEXT (clutter_text_new_full ("Sans 10",
+                                                       "Shared label",
+                                                       CLUTTER_COLOR_Black));
+      g_object_ref_sink (labels[i]);
+    }
+
+  entry = CLUTTER_TEXT (clutter_text_new_full ("Sans 10",
+                                               "Shared label",
+                                               CLUTTER_COLOR_Black));
+  g_object_ref_sink (entry);
+  clutter_text_set_editable (entry, TRUE);
+
+  /* Labels are shaped with the shared contexts rather than their own */
+  layout = clutter_text_get_layout (labels[0]);
+  shared_context = pango_layout_get_context (layout);
+  g_assert_true (shared_context !=
+                 clutter_actor_get_pango_context (CLUTTER_ACTOR (labels[0])));
+  g_assert_true (shared_context ==
+                 pango_layout_get_context (clutter_text_get_layout (labels[1])));
+
+  /* ... but every actor hands out a layout of its own, which stays the
+   * same as long as the contents don't change
+   */
+  g_assert_true (clutter_text_get_layout (labels[0]) ==
+                 clutter_text_get_layout (labels[0]));
+  g_assert_true (clutter_text_get_layout (labels[0]) !=
+                 clutter_text_get_layout (labels[1]));
+
+  /* so changing it doesn't affect what other actors show */
+  pango_layout_set_width (layout, 10 * PANGO_SCALE);
+  pango_layout_set_text (layout, "Changed label", -1);
+  g_assert_cmpint (pango_layout_get_width (clutter_text_get_layout (labels[1])),
+                   ==,
+                   pango_layout_get_width (clutter_text_get_layout (labels[2])));
+  g_assert_cmpstr (pango_layout_get_text (clutter_text_get_layout (labels[1])),
+                   ==,
+                   "Shared label");
+
+  clutter_text_set_text (labels[1], "Other label");
+  g_assert_cmpstr (pango_layout_get_text (clutter_text_get_layout (labels[1])),
+                   ==,
+                   "Other label");
+  g_assert_cmpstr (pango_layout_get_text (clutter_text_get_layout (labels[2])),
+                   ==,
+                   "Shared label");
+
+  /* Editable actors keep their layouts to themselves */
+  g_assert_true (pango_layout_get_context (clutter_text_get_layout (entry)) ==
+                 clutter_actor_get_pango_context (CLUTTER_ACTOR (entry)));
+
+  for (i = 0; i < G_N_ELEMENTS (labels); i++)
+    clutter_actor_destroy (CLUTTER_ACTOR (labels[i]));
+  clutter_actor_destroy (CLUTTER_ACTOR (entry));
+}
+
 CLUTTER_TEST_SUITE (
   CLUTTER_TEST_UNIT ("/text/utf8-validation", text_utf8_validation)
   CLUTTER_TEST_UNIT ("/text/set-empty", text_set_empty)
@@ -561,4 +627,5 @@ CLUTTER_TEST_SUITE (
   CLUTTER_TEST_UNIT ("/text/cursor", text_cursor)
   CLUTTER_TEST_UNIT ("/text/event", text_event)
   CLUTTER_TEST_UNIT ("/text/idempotent-use-markup", text_idempotent_use_markup)
+  CLUTTER_TEST_UNIT ("/text/shared-layout", text_shared_layout)
 )
@@ -0,0 +1,153 @@
+#include "cogl-config.h"
+
+#include "cogl/cogl.h"
+#include "cogl/cogl-atlas.h"
+#include "cogl/cogl-atlas-texture-private.h"
+#include "cogl/cogl-rectangle-map.h"
+#include "tests/cogl-test-utils.h"
+
+#define MAX_TEXTURES 4096
+#define TEXTURE_SIZE 14
+#define MAX_IDLE_ITERATIONS 10000
+
+static uint32_t
+color_for_texture (int tex_num)
+{
+  return ((tex_num & 0xff) << 24) | (((tex_num * 7) & 0xff) << 16) | 0xff;
+}
+
+static CoglAtlasTexture *
+create_texture (int tex_num)
+{
+  uint32_t color = color_for_texture (tex_num);
+  uint8_t data[TEXTURE_SIZE * TEXTURE_SIZE * 4];
+  CoglAtlasTexture *atlas_tex;
+  GError *error = NULL;
+  int i;
+
+  for (i = 0; i < TEXTURE_SIZE * TEXTURE_SIZE; i++)
+    {
+      data[i * 4 + 0] = color >> 24;
+      data[i * 4 + 1] = (color >> 16) & 0xff;
+      data[i * 4 + 2] = (color >> 8) & 0xff;
+      data[i * 4 + 3] = color & 0xff;
+    }
+
+  atlas_tex = cogl_atlas_texture_new_from_data (test_ctx,
+                                                TEXTURE_SIZE, TEXTURE_SIZE,
+                                                COGL_PIXEL_FORMAT_RGBA_8888_PRE,
+                                                TEXTURE_SIZE * 4,
+                                                data,
+                                                &error);
+  g_assert_no_error (error);
+
+  return atlas_tex;
+}
+
+static void
+verify_texture (CoglAtlasTexture *atlas_tex,
+                int               tex_num)
+{
+  uint8_t data[TEXTURE_SIZE * TEXTURE_SIZE * 4];
+  int i;
+
+  cogl_texture_get_data (COGL_TEXTURE (atlas_tex),
+                         COGL_PIXEL_FORMAT_RGBA_8888_PRE,
+                         TEXTURE_SIZE * 4,
+                         data);
+
+  for (i = 0; i < TEXTURE_SIZE * TEXTURE_SIZE; i++)
+    test_utils_compare_pixel (data + i * 4, color_for_texture (tex_num));
+}
+
+static void
+test_atlas_defragment (void)
+{
+  CoglAtlasTexture *textures[MAX_TEXTURES] = { 0 };
+  CoglRectangleMapEntry old_rectangles[MAX_TEXTURES];
+  CoglAtlas *atlas;
+  unsigned int rectangle_area;
+  unsigned int largest_gap;
+  gboolean any_moved = FALSE;
+  int n_textures;
+  int tex_num, i;
+
+  textures[0] = create_texture (0);
+  atlas = textures[0]->atlas;
+  g_assert_nonnull (atlas);
+  rectangle_area = textures[0]->rectangle.width * textures[0]->rectangle.height;
+
+  /* Fill the atlas up completely so that there is no free space left
+     at the end of it */
+  for (n_textures = 1; n_textures < MAX_TEXTURES; n_textures++)
+    {
+      if (_cogl_rectangle_map_get_largest_gap (atlas->map) < rectangle_area)
+        break;
+
+      textures[n_textures] = create_texture (n_textures);
+      g_assert_true (textures[n_textures]->atlas == atlas);
+    }
+
+  g_assert_cmpuint (_cogl_rectangle_map_get_largest_gap (atlas->map),
+                    <,
+                    rectangle_area);
+
+  /* Punch holes all over the atlas in a checkerboard pattern, so that
+     no two holes are next to each other */
+  for (tex_num = 0; tex_num < n_textures; tex_num++)
+    {
+      CoglRectangleMapEntry *rectangle = &textures[tex_num]->rectangle;
+
+      if ((rectangle->x / rectangle->width +
+           rectangle->y / rectangle->height) % 2 == 0)
+        continue;
+
+      cogl_object_unref (textures[tex_num]);
+      textures[tex_num] = NULL;
+    }
+
+  g_assert_true (_cogl_atlas_is_fragmented (atlas));
+  largest_gap = _cogl_rectangle_map_get_largest_gap (atlas->map);
+
+  for (tex_num = 0; tex_num < n_textures; tex_num++)
+    {
+      if (textures[tex_num])
+        old_rectangles[tex_num] = textures[tex_num]->rectangle;
+    }
+
+  /* Removing the textures queued compacting the atlas when idle */
+  for (i = 0; i < MAX_IDLE_ITERATIONS; i++)
+    {
+      if (!g_main_context_iteration (NULL, FALSE))
+        break;
+    }
+  g_assert_cmpint (i, <, MAX_IDLE_ITERATIONS);
+
+  for (tex_num = 0; tex_num < n_textures; tex_num++)
+    {
+      CoglRectangleMapEntry *old_rectangle = &old_rectangles[tex_num];
+
+      if (!textures[tex_num])
+        continue;
+
+      if (textures[tex_num]->rectangle.x != old_rectangle->x ||
+          textures[tex_num]->rectangle.y != old_rectangle->y)
+        any_moved = TRUE;
+
+      /* The contents have to have been copied along with the
+         rectangle */
+      verify_texture (textures[tex_num], tex_num);
+    }
+
+  g_assert_true (any_moved);
+  g_assert_cmpuint (_cogl_rectangle_map_get_largest_gap (atlas->map),
+                    >,
+                    largest_gap);
+
+  for (tex_num = 0; tex_num < n_textures; tex_num++)
+    g_clear_pointer (&textures[tex_num], cogl_object_unref);
+}
+
+COGL_TEST_SUITE (
+  g_test_add_func ("/atlas/defragment", test_atlas_defragment);
+)
@@ -0,0 +1,130 @@
+#include "cogl-config.h"
+
+#include <pango/pangocairo.h>
+
+#include "cogl/cogl.h"
+#include "cogl-pango/cogl-pango-glyph-cache.h"
+#include "tests/cogl-test-utils.h"
+
+#define MAX_FILLER_GLYPHS 4096
+
+typedef struct
+{
+  CoglPangoGlyphCache *cache;
+  PangoFont *font;
+  PangoGlyph glyph;
+  PangoGlyph next_filler_glyph;
+} GlyphCacheTest;
+
+static void
+init_glyph_cache_test (GlyphCacheTest *test,
+                       PangoContext   *context)
+{
+  g_autoptr (PangoLayout) layout = NULL;
+  PangoFontDescription *font_desc;
+  PangoLayoutLine *line;
+  PangoLayoutRun *run;
+
+  /* Large glyphs fill up the atlases quickly. Mipmapping keeps them out
+     of the global atlas, so the reorganizations all happen in the local
+     atlases of the cache */
+  font_desc = pango_font_description_from_string ("Sans 150");
+  layout = pango_layout_new (context);
+  pango_layout_set_font_description (layout, font_desc);
+  pango_font_description_free (font_desc);
+  pango_layout_set_text (layout, "M", -1);
+
+  line = pango_layout_get_line_readonly (layout, 0);
+  run = line->runs->data;
+
+  test->cache = cogl_pango_glyph_cache_new (test_ctx, TRUE);
+  test->font = g_object_ref (run->item->analysis.font);
+  test->glyph = run->glyphs->glyphs[0].glyph;
+  test->next_filler_glyph = 1;
+}
+
+static void
+fini_glyph_cache_test (GlyphCacheTest *test)
+{
+  cogl_pango_glyph_cache_free (test->cache);
+  g_object_unref (test->font);
+}
+
+/* Adds other glyphs of the font until the generation of the cache
+   advanced by @n_generations, or @glyph is no longer cached */
+static void
+add_filler_glyphs (GlyphCacheTest *test,
+                   unsigned int    n_generations,
+                   gboolean        until_evicted)
+{
+  unsigned int target_generation;
+  int i;
+
+  target_generation =
+    cogl_pango_glyph_cache_get_generation (test->cache) + n_generations;
+
+  for (i = 0; i < MAX_FILLER_GLYPHS; i++)
+    {
+      PangoGlyph filler_glyph = test->next_filler_glyph++;
+
+      if (filler_glyph == test->glyph)
+        continue;
+
+      cogl_pango_glyph_cache_lookup (test->cache, TRUE,
+                                     test->font, filler_glyph);
+
+      if (until_evicted)
+        {
+          if (!cogl_pango_glyph_cache_lookup (test->cache, FALSE,
+                                              test->font, test->glyph))
+            return;
+        }
+      else if (cogl_pango_glyph_cache_get_generation (test->cache) >=
+               target_generation)
+        {
+          return;
+        }
+    }
+
+  g_assert_not_reached ();
+}
+
+static void
+test_pango_glyph_cache_pinned (void)
+{
+  g_autoptr (PangoFontMap) font_map = NULL;
+  g_autoptr (PangoContext) context = NULL;
+  GlyphCacheTest test;
+
+  font_map = pango_cairo_font_map_new ();
+  context = pango_font_map_create_context (font_map);
+  init_glyph_cache_test (&test, context);
+
+  /* Make the glyph old enough to be evicted */
+  g_assert_nonnull (cogl_pango_glyph_cache_lookup (test.cache, TRUE,
+                                                   test.font, test.glyph));
+  add_filler_glyphs (&test, 3, FALSE);
+
+  /* Looking it up again while ensuring a layout that forces several
+     reorganizations must keep it around until the layout is drawn */
+  cogl_pango_glyph_cache_pin_generation (test.cache);
+
+  g_assert_nonnull (cogl_pango_glyph_cache_lookup (test.cache, TRUE,
+                                                   test.font, test.glyph));
+  add_filler_glyphs (&test, 3, FALSE);
+  g_assert_nonnull (cogl_pango_glyph_cache_lookup (test.cache, FALSE,
+                                                   test.font, test.glyph));
+
+  cogl_pango_glyph_cache_unpin_generation (test.cache);
+
+  /* Once no layout uses it anymore it is evicted as usual */
+  add_filler_glyphs (&test, 0, TRUE);
+  g_assert_null (cogl_pango_glyph_cache_lookup (test.cache, FALSE,
+                                                test.font, test.glyph));
+
+  fini_glyph_cache_test (&test);
+}
+
+COGL_TEST_SUITE (
+  g_test_add_func ("/pango/glyph-cache/pinned", test_pango_glyph_cache_pinned);
+)
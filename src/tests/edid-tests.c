@@ -20,6 +20,7 @@
 #include "config.h"
 
 #include <glib.h>
+#include <string.h>
 
 #include "backends/edid.h"
 
@@ -61,6 +62,96 @@ unsigned char edid_blob[] = {
 unsigned int edid_blob_len = 384;
 
 
+static GBytes *
+create_edid_variant (uint8_t serial)
+{
+  uint8_t *data;
+
+  /* Changing the serial number gives a distinct blob that still decodes */
+  data = g_memdup2 (edid_blob, edid_blob_len);
+  data[0x0c] = serial;
+
+  return g_bytes_new_take (data, edid_blob_len);
+}
+
+static void
+assert_cache_hit (GBytes       *bytes,
+                  MetaEdidInfo *expected,
+                  gboolean      expect_hit)
+{
+  unsigned int hits;
+  MetaEdidInfo *info;
+
+  hits = meta_edid_info_get_cache_hits ();
+  info = meta_edid_info_new_from_bytes (bytes);
+
+  g_assert (meta_edid_info_get_cache_hits () == hits + (expect_hit ? 1 : 0));
+
+  if (expected)
+    {
+      g_assert (info != NULL);
+      g_assert (memcmp (info, expected, sizeof (MetaEdidInfo)) == 0);
+    }
+  else
+    {
+      g_assert (info == NULL);
+    }
+
+  g_free (info);
+}
+
+static void
+test_edid_cache (MetaEdidInfo *edid)
+{
+  GBytes *bytes;
+  GBytes *variants[EDID_CACHE_MAX_SIZE];
+  GBytes *invalid_bytes;
+  uint8_t *invalid_data;
+  int i;
+
+  bytes = g_bytes_new_static (edid_blob, edid_blob_len);
+  assert_cache_hit (bytes, edid, FALSE);
+  assert_cache_hit (bytes, edid, TRUE);
+
+  /* Blobs that fail to decode are cached as such */
+  invalid_data = g_memdup2 (edid_blob, edid_blob_len);
+  invalid_data[0] = 0xff;
+  invalid_bytes = g_bytes_new_take (invalid_data, edid_blob_len);
+  assert_cache_hit (invalid_bytes, NULL, FALSE);
+  assert_cache_hit (invalid_bytes, NULL, TRUE);
+  g_bytes_unref (invalid_bytes);
+
+  /* Filling the cache with other blobs evicts the least recently used
+   * entry, but keeps the most recent ones */
+  for (i = 0; i < EDID_CACHE_MAX_SIZE; i++)
+    {
+      MetaEdidInfo *variant_edid;
+
+      variants[i] = create_edid_variant (i);
+      variant_edid = meta_edid_info_new_parse (g_bytes_get_data (variants[i],
+                                                                 NULL));
+      g_assert (variant_edid != NULL);
+      assert_cache_hit (variants[i], variant_edid, FALSE);
+      g_free (variant_edid);
+    }
+
+  for (i = EDID_CACHE_MAX_SIZE - 1; i >= 0; i--)
+    {
+      MetaEdidInfo *variant_edid;
+
+      variant_edid = meta_edid_info_new_parse (g_bytes_get_data (variants[i],
+                                                                 NULL));
+      assert_cache_hit (variants[i], variant_edid, TRUE);
+      g_free (variant_edid);
+    }
+
+  assert_cache_hit (bytes, edid, FALSE);
+
+  for (i = 0; i < EDID_CACHE_MAX_SIZE; i++)
+    g_bytes_unref (variants[i]);
+  g_bytes_unref (bytes);
+}
+
 int
 main (int    argc,
       char **argv)
@@ -76,4 +167,8 @@ main (int    argc,
             (META_EDID_TF_TRADITIONAL_GAMMA_SDR | META_EDID_TF_PQ));
   g_assert (edid->colorimetry ==
             (META_EDID_COLORIMETRY_BT2020YCC | META_EDID_COLORIMETRY_BT2020RGB));
+
+  test_edid_cache (edid);
+
+  g_free (edid);
 }
@@ -21,10 +21,13 @@
 
 #include "tests/monitor-store-unit-tests.h"
 
+#include <glib/gstdio.h>
+
 #include "backends/meta-backend-private.h"
 #include "backends/meta-monitor-config-store.h"
 #include "backends/meta-monitor-config-manager.h"
 #include "backends/meta-monitor-manager-private.h"
+#include "backends/meta-settings-private.h"
 #include "tests/meta-monitor-test-utils.h"
 #include "tests/unit-tests.h"
 
@@ -227,7 +230,7 @@ check_monitor_store_configurations (MonitorStoreTestExpect *expect)
 }
 
 static void
-meta_test_monitor_store_single (void)
+check_single_configuration (float refresh_rate)
 {
   MonitorStoreTestExpect expect = {
     .configurations = {
@@ -252,7 +255,7 @@ meta_test_monitor_store_single (void)
                 .mode = {
                   .width = 1920,
                   .height = 1080,
-                  .refresh_rate = 60.000495910644531
+                  .refresh_rate = refresh_rate
                 }
               }
             },
@@ -265,9 +268,15 @@ meta_test_monitor_store_single (void)
     .n_configurations = 1
   };
 
+  check_monitor_store_configurations (&expect);
+}
+
+static void
+meta_test_monitor_store_single (void)
+{
   meta_set_custom_monitor_config (test_context, "single.xml");
 
-  check_monitor_store_configurations (&expect);
+  check_single_configuration (60.000495910644531);
 }
 
 static void
@@ -1036,6 +1045,123 @@ meta_test_monitor_store_policy_dbus_invalid (void)
   g_assert_cmpint (policy->enable_dbus, ==, FALSE);
 }
 
+static MetaMonitorConfigStore *
+get_monitor_config_store (void)
+{
+  MetaBackend *backend = meta_get_backend ();
+  MetaMonitorManager *monitor_manager =
+    meta_backend_get_monitor_manager (backend);
+
+  return meta_monitor_config_manager_get_store (monitor_manager->config_manager);
+}
+
+static void
+load_user_config (const char *path,
+                  gboolean    expect_cached)
+{
+  MetaMonitorConfigStore *config_store = get_monitor_config_store ();
+  g_autoptr (GError) error = NULL;
+
+  if (!meta_monitor_config_store_set_custom_user (config_store, path, &error))
+    g_error ("Failed to read user config: %s", error->message);
+
+  g_assert_cmpint (meta_monitor_config_store_is_user_config_cached (config_store),
+                   ==,
+                   expect_cached);
+}
+
+static void
+set_file_contents (const char *path,
+                   const char *contents,
+                   gssize      length)
+{
+  g_autoptr (GError) error = NULL;
+
+  if (!g_file_set_contents (path, contents, length, &error))
+    g_error ("Failed to write '%s': %s", path, error->message);
+}
+
+static void
+meta_test_monitor_store_cache (void)
+{
+  MetaBackend *backend = meta_get_backend ();
+  MetaSettings *settings = meta_backend_get_settings (backend);
+  g_autoptr (GError) error = NULL;
+  g_autofree char *tmp_dir = NULL;
+  g_autofree char *path = NULL;
+  g_autoptr (GFile) file = NULL;
+  g_autoptr (GFile) cache_file = NULL;
+  const char *cache_path;
+  g_autofree char *contents = NULL;
+  g_autofree char *cache_contents = NULL;
+  g_autoptr (GString) edited_contents = NULL;
+  gsize cache_size;
+
+  tmp_dir = g_dir_make_tmp ("mutter-monitor-store-XXXXXX", &error);
+  g_assert_no_error (error);
+  path = g_build_filename (tmp_dir, "monitors.xml", NULL);
+  file = g_file_new_for_path (path);
+  cache_file = meta_monitor_config_store_get_cache_file (file);
+  cache_path = g_file_peek_path (cache_file);
+  g_assert_true (g_str_has_prefix (cache_path, g_get_user_cache_dir ()));
+
+  g_file_get_contents (g_test_get_filename (G_TEST_DIST,
+                                            "tests", "monitor-configs",
+                                            "single.xml", NULL),
+                       &contents, NULL, &error);
+  g_assert_no_error (error);
+  set_file_contents (path, contents, -1);
+
+  /* The first read parses the XML and writes the cache, which the next
+   * read then uses */
+  load_user_config (path, FALSE);
+  check_single_configuration (60.000495910644531);
+  g_assert_true (g_file_test (cache_path, G_FILE_TEST_EXISTS));
+
+  load_user_config (path, TRUE);
+  check_single_configuration (60.000495910644531);
+
+  /* A corrupt cache is ignored and replaced */
+  set_file_contents (cache_path, "garbage", -1);
+  load_user_config (path, FALSE);
+  check_single_configuration (60.000495910644531);
+  load_user_config (path, TRUE);
+
+  /* So is a truncated one */
+  g_file_get_contents (cache_path, &cache_contents, &cache_size, &error);
+  g_assert_no_error (error);
+  set_file_contents (cache_path, cache_contents, cache_size / 2);
+  load_user_config (path, FALSE);
+  check_single_configuration (60.000495910644531);
+  load_user_config (path, TRUE);
+
+  /* Editing the XML makes the cache stale */
+  edited_contents = g_string_new (contents);
+  g_string_replace (edited_contents, "60.000495910644531", "59.94", 1);
+  set_file_contents (path, edited_contents->str, edited_contents->len);
+  load_user_config (path, FALSE);
+  check_single_configuration (59.94);
+  load_user_config (path, TRUE);
+  check_single_configuration (59.94);
+
+  /* The logical monitor layouts depend on the default layout mode, so
+   * changing it invalidates the cache as well */
+  meta_settings_override_experimental_features (settings);
+  load_user_config (path, FALSE);
+  check_single_configuration (59.94);
+  load_user_config (path, TRUE);
+
+  meta_settings_enable_experimental_feature (
+    settings,
+    META_EXPERIMENTAL_FEATURE_SCALE_MONITOR_FRAMEBUFFER);
+  load_user_config (path, FALSE);
+  check_single_configuration (59.94);
+
+  g_assert_cmpint (g_unlink (cache_path), ==, 0);
+  g_assert_cmpint (g_unlink (path), ==, 0);
+  g_assert_cmpint (g_rmdir (tmp_dir), ==, 0);
+}
+
 void
 init_monitor_store_tests (void)
 {
@@ -1081,4 +1207,6 @@ init_monitor_store_tests (void)
                    meta_test_monitor_store_policy_dbus);
   g_test_add_func ("/backends/monitor-store/dbus-invalid",
                    meta_test_monitor_store_policy_dbus_invalid);
+  g_test_add_func ("/backends/monitor-store/cache",
+                   meta_test_monitor_store_cache);
 }
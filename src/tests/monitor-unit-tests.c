@@ -675,6 +675,127 @@ meta_test_monitor_one_disconnected_linear_config (void)
   check_monitor_test_clients_state ();
 }
 
+static void
+emulate_hotplug_cycle (MonitorTestCaseSetup *docked_setup,
+                       MonitorTestCaseSetup *undocked_setup)
+{
+  MetaBackend *backend = meta_get_backend ();
+  MetaMonitorManager *monitor_manager =
+    meta_backend_get_monitor_manager (backend);
+  MetaMonitorManagerTest *monitor_manager_test =
+    META_MONITOR_MANAGER_TEST (monitor_manager);
+
+  meta_monitor_manager_test_emulate_hotplug (monitor_manager_test,
+                                             meta_create_monitor_test_setup (test_backend,
+                                                                             undocked_setup,
+                                                                             MONITOR_TEST_FLAG_NO_STORED));
+  meta_monitor_manager_test_emulate_hotplug (monitor_manager_test,
+                                             meta_create_monitor_test_setup (test_backend,
+                                                                             docked_setup,
+                                                                             MONITOR_TEST_FLAG_NO_STORED));
+}
+
+static void
+meta_test_monitor_candidate_config_cache (void)
+{
+  MetaBackend *backend = meta_get_backend ();
+  MetaMonitorManager *monitor_manager =
+    meta_backend_get_monitor_manager (backend);
+  MetaMonitorConfigManager *config_manager = monitor_manager->config_manager;
+  MonitorTestCase test_case = initial_test_case;
+  MonitorTestCaseSetup undocked_setup;
+  MetaMonitorsConfig *docked_config;
+  MetaMonitorsConfig *undocked_config;
+  MetaMonitorsConfig *mirror_config;
+
+  undocked_setup = test_case.setup;
+  undocked_setup.n_outputs = 1;
+
+  emulate_hotplug (meta_create_monitor_test_setup (test_backend,
+                                                   &test_case.setup,
+                                                   MONITOR_TEST_FLAG_NO_STORED));
+  docked_config = meta_monitor_config_manager_get_current (config_manager);
+  g_assert_true (meta_monitor_config_manager_get_candidate (config_manager) ==
+                 docked_config);
+
+  emulate_hotplug (meta_create_monitor_test_setup (test_backend,
+                                                   &undocked_setup,
+                                                   MONITOR_TEST_FLAG_NO_STORED));
+  undocked_config = meta_monitor_config_manager_get_current (config_manager);
+  g_assert_true (undocked_config != docked_config);
+
+  /* Going back to a setup that has been seen before should reuse the
+   * configuration that was generated for it the first time around */
+  emulate_hotplug (meta_create_monitor_test_setup (test_backend,
+                                                   &test_case.setup,
+                                                   MONITOR_TEST_FLAG_NO_STORED));
+  g_assert_true (meta_monitor_config_manager_get_current (config_manager) ==
+                 docked_config);
+  META_TEST_LOG_CALL ("Checking monitor configuration",
+                      meta_check_monitor_configuration (test_context,
+                                                        &test_case.expect));
+  check_monitor_test_clients_state ();
+
+  emulate_hotplug (meta_create_monitor_test_setup (test_backend,
+                                                   &undocked_setup,
+                                                   MONITOR_TEST_FLAG_NO_STORED));
+  g_assert_true (meta_monitor_config_manager_get_current (config_manager) ==
+                 undocked_config);
+
+  /* A configuration from the history, here a mirror picked with the
+   * display switcher, takes
+   * precedence over the cached one and doesn't end up in the cache */
+  emulate_hotplug (meta_create_monitor_test_setup (test_backend,
+                                                   &test_case.setup,
+                                                   MONITOR_TEST_FLAG_NO_STORED));
+  meta_monitor_manager_switch_config (monitor_manager,
+                                      META_MONITOR_SWITCH_CONFIG_ALL_MIRROR);
+  mirror_config = meta_monitor_config_manager_get_current (config_manager);
+  g_assert_true (mirror_config != docked_config);
+
+  emulate_hotplug (meta_create_monitor_test_setup (test_backend,
+                                                   &undocked_setup,
+                                                   MONITOR_TEST_FLAG_NO_STORED));
+  g_assert_true (meta_monitor_config_manager_get_current (config_manager) ==
+                 undocked_config);
+
+  emulate_hotplug (meta_create_monitor_test_setup (test_backend,
+                                                   &test_case.setup,
+                                                   MONITOR_TEST_FLAG_NO_STORED));
+  g_assert_true (meta_monitor_config_manager_get_current (config_manager) ==
+                 mirror_config);
+  g_assert_true (meta_monitor_config_manager_get_candidate (config_manager) ==
+                 docked_config);
+
+  if (g_test_perf ())
+    {
+      int n_cycles = 100;
+      double uncached_time, cached_time;
+      int i;
+
+      g_test_timer_start ();
+      for (i = 0; i < n_cycles; i++)
+        {
+          meta_monitor_config_manager_clear_candidates (config_manager);
+          emulate_hotplug_cycle (&test_case.setup, &undocked_setup);
+        }
+      uncached_time = g_test_timer_elapsed ();
+
+      g_test_timer_start ();
+      for (i = 0; i < n_cycles; i++)
+        emulate_hotplug_cycle (&test_case.setup, &undocked_setup);
+      cached_time = g_test_timer_elapsed ();
+
+      g_test_minimized_result (cached_time / n_cycles,
+                               "%d hotplug cycles took %.1f ms generating "
+                               "configurations and %.1f ms using cached "
+                               "ones",
+                               n_cycles,
+                               uncached_time * 1000,
+                               cached_time * 1000);
+    }
+}
+
 static void
 meta_test_monitor_one_off_linear_config (void)
 {
@@ -9350,6 +9471,7 @@ test_case_setup (void       **fixture,
                                                     TRUE);
   meta_monitor_config_manager_set_current (config_manager, NULL);
   meta_monitor_config_manager_clear_history (config_manager);
+  meta_monitor_config_manager_clear_candidates (config_manager);
 }
 
 static void
@@ -9392,6 +9514,8 @@ init_monitor_tests (void)
                     meta_test_monitor_initial_linear_config);
   add_monitor_test ("/backends/monitor/one-disconnected-linear-config",
                     meta_test_monitor_one_disconnected_linear_config);
+  add_monitor_test ("/backends/monitor/candidate-config-cache",
+                    meta_test_monitor_candidate_config_cache);
   add_monitor_test ("/backends/monitor/one-off-linear-config",
                     meta_test_monitor_one_off_linear_config);
   add_monitor_test ("/backends/monitor/preferred-linear-config",
@@ -0,0 +1,228 @@
+/*
+ * Copyright (C) 2023 Buddies of Budgie
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+ * 02111-1307, USA.
+ *
+ */
+
+#include "config.h"
+
+#include "backends/native/meta-barrier-native.h"
+#include "backends/native/meta-seat-native.h"
+#include "meta-test/meta-context-test.h"
+#include "meta/barrier.h"
+#include "meta/meta-backend.h"
+
+#define N_BARRIERS_PER_AXIS 300
+#define BARRIER_SPACING 10
+#define BARRIER_LENGTH 4000
+#define N_BENCHMARK_MOTIONS 200000
+
+static MetaContext *test_context;
+
+static MetaBarrierManagerNative *
+get_barrier_manager (void)
+{
+  MetaBackend *backend = meta_context_get_backend (test_context);
+  ClutterSeat *seat = meta_backend_get_default_seat (backend);
+
+  return meta_seat_native_get_barrier_manager (META_SEAT_NATIVE (seat));
+}
+
+/*
+ * Creates a grid of N_BARRIERS_PER_AXIS vertical and N_BARRIERS_PER_AXIS
+ * horizontal barriers blocking in all directions, placed at
+ * BARRIER_SPACING / 2 + n * BARRIER_SPACING.
+ */
+static GPtrArray *
+create_barrier_grid (void)
+{
+  MetaBackend *backend = meta_context_get_backend (test_context);
+  GPtrArray *barriers;
+  int i;
+
+  barriers = g_ptr_array_new ();
+
+  for (i = 0; i < N_BARRIERS_PER_AXIS; i++)
+    {
+      int position = BARRIER_SPACING / 2 + i * BARRIER_SPACING;
+      MetaBarrier *barrier;
+      g_autoptr (GError) error = NULL;
+
+      barrier = meta_barrier_new (backend,
+                                  position, 0,
+                                  position, BARRIER_LENGTH,
+                                  0,
+                                  &error);
+      g_assert_no_error (error);
+      g_ptr_array_add (barriers, barrier);
+
+      barrier = meta_barrier_new (backend,
+                                  0, position,
+                                  BARRIER_LENGTH, position,
+                                  0,
+                                  &error);
+      g_assert_no_error (error);
+      g_ptr_array_add (barriers, barrier);
+    }
+
+  return barriers;
+}
+
+static void
+destroy_barrier_grid (GPtrArray *barriers)
+{
+  /* Dispatch pending hit and left signals while the barriers are alive. */
+  while (g_main_context_iteration (NULL, FALSE));
+
+  g_ptr_array_foreach (barriers, (GFunc) meta_barrier_destroy, NULL);
+  g_ptr_array_free (barriers, TRUE);
+}
+
+static void
+meta_test_barriers_clamp (void)
+{
+  MetaBarrierManagerNative *manager = get_barrier_manager ();
+  GPtrArray *barriers;
+  float x, y;
+
+  barriers = create_barrier_grid ();
+
+  /* Motion within a cell isn't affected. */
+  x = 12.0f;
+  y = 13.0f;
+  meta_barrier_manager_native_process_motion_in_impl (manager, 0,
+                                                      11.0f, 11.0f,
+                                                      &x, &y);
+  g_assert_cmpfloat (x, ==, 12.0f);
+  g_assert_cmpfloat (y, ==, 13.0f);
+
+  /* Crossing several vertical barriers stops at the first one. */
+  x = 143.0f;
+  y = 12.0f;
+  meta_barrier_manager_native_process_motion_in_impl (manager, 1,
+                                                      11.0f, 12.0f,
+                                                      &x, &y);
+  g_assert_cmpfloat (x, ==, 15.0f);
+  g_assert_cmpfloat (y, ==, 12.0f);
+
+  /* Same for horizontal barriers, moving in the negative direction. */
+  x = 1012.0f;
+  y = 903.0f;
+  meta_barrier_manager_native_process_motion_in_impl (manager, 2,
+                                                      1012.0f, 1499.0f,
+                                                      &x, &y);
+  g_assert_cmpfloat (x, ==, 1012.0f);
+  g_assert_cmpfloat (y, ==, 1495.0f);
+
+  /* Diagonal motion gets clamped on both axes. */
+  x = 2499.0f;
+  y = 2499.0f;
+  meta_barrier_manager_native_process_motion_in_impl (manager, 3,
+                                                      2001.0f, 1001.0f,
+                                                      &x, &y);
+  g_assert_cmpfloat (x, ==, 2005.0f);
+  g_assert_cmpfloat (y, ==, 1005.0f);
+
+  destroy_barrier_grid (barriers);
+
+  /* With the barriers gone, nothing is clamped anymore. */
+  x = 143.0f;
+  y = 12.0f;
+  meta_barrier_manager_native_process_motion_in_impl (manager, 4,
+                                                      11.0f, 12.0f,
+                                                      &x, &y);
+  g_assert_cmpfloat (x, ==, 143.0f);
+  g_assert_cmpfloat (y, ==, 12.0f);
+}
+
+static void
+meta_test_barriers_benchmark (void)
+{
+  MetaBarrierManagerNative *manager = get_barrier_manager ();
+  GPtrArray *barriers;
+  GRand *rand;
+  double elapsed_s;
+  int i;
+
+  if (!g_test_perf ())
+    {
+      g_test_skip ("Only run in performance mode (-m perf)");
+      return;
+    }
+
+  barriers = create_barrier_grid ();
+  rand = g_rand_new_with_seed (0);
+
+  g_test_timer_start ();
+
+  for (i = 0; i < N_BENCHMARK_MOTIONS; i++)
+    {
+      int cell_x = g_rand_int_range (rand, 0, N_BARRIERS_PER_AXIS - 1);
+      int cell_y = g_rand_int_range (rand, 0, N_BARRIERS_PER_AXIS - 1);
+      float prev_x, prev_y;
+      float x, y;
+
+      /* Small motion within a cell, as most pointer motion is. */
+      prev_x = BARRIER_SPACING / 2 + cell_x * BARRIER_SPACING + 2.0f;
+      prev_y = BARRIER_SPACING / 2 + cell_y * BARRIER_SPACING + 2.0f;
+      x = prev_x + 3.0f;
+      y = prev_y + 3.0f;
+
+      meta_barrier_manager_native_process_motion_in_impl (manager, i,
+                                                          prev_x, prev_y,
+                                                          &x, &y);
+      g_assert_cmpfloat (x, ==, prev_x + 3.0f);
+      g_assert_cmpfloat (y, ==, prev_y + 3.0f);
+    }
+
+  elapsed_s = g_test_timer_elapsed ();
+
+  g_test_minimized_result (elapsed_s * G_USEC_PER_SEC / N_BENCHMARK_MOTIONS,
+                           "%d barriers: %.3f µs per motion",
+                           N_BARRIERS_PER_AXIS * 2,
+                           elapsed_s * G_USEC_PER_SEC / N_BENCHMARK_MOTIONS);
+
+  g_rand_free (rand);
+  destroy_barrier_grid (barriers);
+}
+
+static void
+init_tests (void)
+{
+  g_test_add_func ("/backends/native/barriers/clamp",
+                   meta_test_barriers_clamp);
+  g_test_add_func ("/backends/native/barriers/benchmark",
+                   meta_test_barriers_benchmark);
+}
+
+int
+main (int    argc,
+      char **argv)
+{
+  g_autoptr (MetaContext) context = NULL;
+
+  context = meta_create_test_context (META_CONTEXT_TEST_TYPE_HEADLESS,
+                                      META_CONTEXT_TEST_FLAG_NO_X11);
+  g_assert (meta_context_configure (context, &argc, &argv, NULL));
+
+  test_context = context;
+
+  init_tests ();
+
+  return meta_context_test_run_tests (META_CONTEXT_TEST (context),
+                                      META_TEST_RUN_FLAG_NONE);
+}
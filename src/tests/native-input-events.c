@@ -0,0 +1,306 @@
+/*
+ * Copyright (C) 2026 Buddies of Budgie
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include <glib.h>
+
+#include "backends/native/meta-input-thread.h"
+
+static ClutterEvent *
+create_motion_event (double dx,
+                     double dy,
+                     double dx_unaccel,
+                     double dy_unaccel)
+{
+  ClutterEvent *event;
+
+  event = clutter_event_new (CLUTTER_MOTION);
+  event->motion.flags |= CLUTTER_EVENT_FLAG_RELATIVE_MOTION;
+  event->motion.dx = dx;
+  event->motion.dy = dy;
+  event->motion.dx_unaccel = dx_unaccel;
+  event->motion.dy_unaccel = dy_unaccel;
+
+  return event;
+}
+
+static void
+assert_motion_history_entry (const ClutterMotionHistoryEntry *entry,
+                             int64_t                          time_us,
+                             double                           dx,
+                             double                           dy,
+                             double                           dx_unaccel,
+                             double                           dy_unaccel)
+{
+  g_assert_cmpint (entry->time_us, ==, time_us);
+  g_assert_cmpfloat (entry->dx, ==, dx);
+  g_assert_cmpfloat (entry->dy, ==, dy);
+  g_assert_cmpfloat (entry->dx_unaccel, ==, dx_unaccel);
+  g_assert_cmpfloat (entry->dy_unaccel, ==, dy_unaccel);
+}
+
+static ClutterEvent *
+create_scroll_event (ClutterScrollSource scroll_source,
+                     double              dx,
+                     double              dy)
+{
+  ClutterEvent *event;
+
+  event = clutter_event_new (CLUTTER_SCROLL);
+  event->scroll.scroll_source = scroll_source;
+  clutter_event_set_scroll_delta (event, dx, dy);
+
+  return event;
+}
+
+static void
+meta_test_input_events_compress_motion (void)
+{
+  ClutterEvent *event, *next_event;
+  double dx, dy, dx_unaccel, dy_unaccel;
+
+  event = create_motion_event (1.5, -2.0, 3.0, -4.0);
+  next_event = create_motion_event (0.25, 1.0, 0.5, 2.0);
+  g_assert_true (meta_seat_impl_is_compressible_event (event, next_event));
+
+  meta_seat_impl_compress_event (event, next_event);
+  g_assert_true (clutter_event_get_relative_motion (next_event,
+                                                    &dx, &dy,
+                                                    &dx_unaccel,
+                                                    &dy_unaccel));
+  g_assert_cmpfloat (dx, ==, 1.75);
+  g_assert_cmpfloat (dy, ==, -1.0);
+  g_assert_cmpfloat (dx_unaccel, ==, 3.5);
+  g_assert_cmpfloat (dy_unaccel, ==, -2.0);
+
+  /* Folding in yet another event keeps accumulating */
+  meta_seat_impl_compress_event (event, next_event);
+  g_assert_true (clutter_event_get_relative_motion (next_event,
+                                                    &dx, &dy,
+                                                    &dx_unaccel,
+                                                    &dy_unaccel));
+  g_assert_cmpfloat (dx, ==, 3.25);
+  g_assert_cmpfloat (dy, ==, -3.0);
+  g_assert_cmpfloat (dx_unaccel, ==, 6.5);
+  g_assert_cmpfloat (dy_unaccel, ==, -6.0);
+
+  clutter_event_free (event);
+  clutter_event_free (next_event);
+
+  /* An absolute event following relative motion picks up its deltas */
+  event = create_motion_event (1.0, 2.0, 3.0, 4.0);
+  next_event = clutter_event_new (CLUTTER_MOTION);
+  g_assert_true (meta_seat_impl_is_compressible_event (event, next_event));
+
+  meta_seat_impl_compress_event (event, next_event);
+  g_assert_true (clutter_event_get_relative_motion (next_event,
+                                                    &dx, &dy,
+                                                    &dx_unaccel,
+                                                    &dy_unaccel));
+  g_assert_cmpfloat (dx, ==, 1.0);
+  g_assert_cmpfloat (dy, ==, 2.0);
+  g_assert_cmpfloat (dx_unaccel, ==, 3.0);
+  g_assert_cmpfloat (dy_unaccel, ==, 4.0);
+
+  clutter_event_free (event);
+  clutter_event_free (next_event);
+
+  /* Absolute motion has no deltas to carry over */
+  event = clutter_event_new (CLUTTER_MOTION);
+  next_event = create_motion_event (1.0, 2.0, 3.0, 4.0);
+
+  meta_seat_impl_compress_event (event, next_event);
+  g_assert_true (clutter_event_get_relative_motion (next_event,
+                                                    &dx, &dy,
+                                                    &dx_unaccel,
+                                                    &dy_unaccel));
+  g_assert_cmpfloat (dx, ==, 1.0);
+  g_assert_cmpfloat (dy, ==, 2.0);
+  g_assert_cmpfloat (dx_unaccel, ==, 3.0);
+  g_assert_cmpfloat (dy_unaccel, ==, 4.0);
+
+  clutter_event_free (event);
+  clutter_event_free (next_event);
+}
+
+static void
+meta_test_input_events_compress_motion_history (void)
+{
+  const ClutterMotionHistoryEntry *motion_history;
+  ClutterEvent *event, *next_event, *copy;
+  unsigned int n_entries, i;
+  double dx, dy, dx_unaccel, dy_unaccel;
+  double total_dx = 0.0;
+
+  event = create_motion_event (1.0, 2.0, 3.0, 4.0);
+  event->motion.time_us = 1000;
+  g_assert_null (clutter_event_get_motion_history (event, &n_entries));
+  g_assert_cmpuint (n_entries, ==, 0);
+
+  /* Every compressed sample keeps its own timestamp and deltas */
+  next_event = create_motion_event (0.5, 1.5, 2.5, 3.5);
+  next_event->motion.time_us = 2000;
+  meta_seat_impl_compress_event (event, next_event);
+  clutter_event_free (event);
+  event = next_event;
+
+  next_event = create_motion_event (-1.0, -2.0, -3.0, -4.0);
+  next_event->motion.time_us = 3000;
+  meta_seat_impl_compress_event (event, next_event);
+  clutter_event_free (event);
+
+  motion_history = clutter_event_get_motion_history (next_event, &n_entries);
+  g_assert_cmpuint (n_entries, ==, 3);
+  assert_motion_history_entry (&motion_history[0], 1000, 1.0, 2.0, 3.0, 4.0);
+  assert_motion_history_entry (&motion_history[1], 2000, 0.5, 1.5, 2.5, 3.5);
+  assert_motion_history_entry (&motion_history[2], 3000,
+                               -1.0, -2.0, -3.0, -4.0);
+
+  g_assert_true (clutter_event_get_relative_motion (next_event,
+                                                    &dx, &dy,
+                                                    &dx_unaccel,
+                                                    &dy_unaccel));
+  g_assert_cmpfloat (dx, ==, 0.5);
+  g_assert_cmpfloat (dy, ==, 1.5);
+  g_assert_cmpfloat (dx_unaccel, ==, 2.5);
+  g_assert_cmpfloat (dy_unaccel, ==, 3.5);
+
+  /* Copies carry the history along */
+  copy = clutter_event_copy (next_event);
+  motion_history = clutter_event_get_motion_history (copy, &n_entries);
+  g_assert_cmpuint (n_entries, ==, 3);
+  assert_motion_history_entry (&motion_history[1], 2000, 0.5, 1.5, 2.5, 3.5);
+  clutter_event_free (copy);
+  clutter_event_free (next_event);
+
+  /* A long history is bounded, without losing any motion */
+  event = create_motion_event (1.0, 0.0, 1.0, 0.0);
+  for (i = 1; i < 1000; i++)
+    {
+      next_event = create_motion_event (i, 0.0, i, 0.0);
+      next_event->motion.time_us = i;
+      meta_seat_impl_compress_event (event, next_event);
+      clutter_event_free (event);
+      event = next_event;
+    }
+
+  motion_history = clutter_event_get_motion_history (event, &n_entries);
+  g_assert_cmpuint (n_entries, <, 1000);
+  for (i = 0; i < n_entries; i++)
+    total_dx += motion_history[i].dx;
+
+  g_assert_true (clutter_event_get_relative_motion (event, &dx, NULL,
+                                                    NULL, NULL));
+  g_assert_cmpfloat (dx, ==, 1.0 + 999.0 * 1000.0 / 2.0);
+  g_assert_cmpfloat (total_dx, ==, dx);
+  assert_motion_history_entry (&motion_history[n_entries - 1],
+                               999, 999.0, 0.0, 999.0, 0.0);
+  clutter_event_free (event);
+}
+
+static void
+meta_test_input_events_incompressible_motion (void)
+{
+  ClutterEvent *event, *next_event;
+
+  event = create_motion_event (1.0, 1.0, 1.0, 1.0);
+
+  next_event = create_motion_event (1.0, 1.0, 1.0, 1.0);
+  next_event->motion.modifier_state = CLUTTER_SHIFT_MASK;
+  g_assert_false (meta_seat_impl_is_compressible_event (event, next_event));
+  clutter_event_free (next_event);
+
+  next_event = create_motion_event (1.0, 1.0, 1.0, 1.0);
+  next_event->motion.axes = g_new0 (double, CLUTTER_INPUT_AXIS_LAST);
+  g_assert_false (meta_seat_impl_is_compressible_event (event, next_event));
+  g_assert_false (meta_seat_impl_is_compressible_event (next_event, event));
+  clutter_event_free (next_event);
+
+  next_event = create_scroll_event (CLUTTER_SCROLL_SOURCE_FINGER, 1.0, 1.0);
+  g_assert_false (meta_seat_impl_is_compressible_event (event, next_event));
+  g_assert_false (meta_seat_impl_is_compressible_event (next_event, event));
+  clutter_event_free (next_event);
+
+  clutter_event_free (event);
+}
+
+static void
+meta_test_input_events_compress_scroll (void)
+{
+  ClutterEvent *event, *next_event;
+  double dx, dy;
+
+  event = create_scroll_event (CLUTTER_SCROLL_SOURCE_FINGER, 0.5, -1.0);
+  next_event = create_scroll_event (CLUTTER_SCROLL_SOURCE_FINGER, 0.25, 2.0);
+  g_assert_true (meta_seat_impl_is_compressible_event (event, next_event));
+
+  meta_seat_impl_compress_event (event, next_event);
+  clutter_event_get_scroll_delta (next_event, &dx, &dy);
+  g_assert_cmpfloat (dx, ==, 0.75);
+  g_assert_cmpfloat (dy, ==, 1.0);
+
+  clutter_event_free (next_event);
+
+  /* A finished scroll sequence is kept apart from the next one */
+  event->scroll.finish_flags = CLUTTER_SCROLL_FINISHED_VERTICAL;
+  next_event = create_scroll_event (CLUTTER_SCROLL_SOURCE_FINGER, 0.0, 1.0);
+  g_assert_false (meta_seat_impl_is_compressible_event (event, next_event));
+  clutter_event_free (next_event);
+  event->scroll.finish_flags = CLUTTER_SCROLL_FINISHED_NONE;
+
+  next_event = create_scroll_event (CLUTTER_SCROLL_SOURCE_CONTINUOUS, 0.0, 1.0);
+  g_assert_false (meta_seat_impl_is_compressible_event (event, next_event));
+  clutter_event_free (next_event);
+
+  next_event = clutter_event_new (CLUTTER_SCROLL);
+  next_event->scroll.direction = CLUTTER_SCROLL_DOWN;
+  next_event->scroll.scroll_source = CLUTTER_SCROLL_SOURCE_FINGER;
+  g_assert_false (meta_seat_impl_is_compressible_event (event, next_event));
+  clutter_event_free (next_event);
+
+  clutter_event_free (event);
+
+  /* Wheel deltas carry v120 values, these are never merged */
+  event = create_scroll_event (CLUTTER_SCROLL_SOURCE_WHEEL, 0.0, 0.5);
+  next_event = create_scroll_event (CLUTTER_SCROLL_SOURCE_WHEEL, 0.0, 0.5);
+  g_assert_false (meta_seat_impl_is_compressible_event (event, next_event));
+  clutter_event_free (next_event);
+  clutter_event_free (event);
+}
+
+static void
+init_input_events_tests (void)
+{
+  g_test_add_func ("/backends/native/input-events/compress-motion",
+                   meta_test_input_events_compress_motion);
+  g_test_add_func ("/backends/native/input-events/compress-motion-history",
+                   meta_test_input_events_compress_motion_history);
+  g_test_add_func ("/backends/native/input-events/incompressible-motion",
+                   meta_test_input_events_incompressible_motion);
+  g_test_add_func ("/backends/native/input-events/compress-scroll",
+                   meta_test_input_events_compress_scroll);
+}
+
+int
+main (int    argc,
+      char **argv)
+{
+  g_test_init (&argc, &argv, NULL);
+  init_input_events_tests ();
+  return g_test_run ();
+}
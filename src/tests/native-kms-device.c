@@ -21,6 +21,7 @@
 #include "config.h"
 
 #include "backends/native/meta-backend-native-private.h"
+#include "backends/native/meta-crtc-kms.h"
 #include "backends/native/meta-kms-connector.h"
 #include "backends/native/meta-kms-crtc.h"
 #include "backends/native/meta-kms-device.h"
@@ -408,6 +409,76 @@ meta_test_kms_device_power_save (void)
                     meta_kms_crtc_get_id (crtc));
 }
 
+static void
+meta_test_kms_device_scanout_test_cache (void)
+{
+  MetaKmsDevice *device;
+  MetaKmsCrtc *crtc;
+  MetaKmsConnector *connector;
+  MetaKmsMode *mode;
+  MetaCrtcKms *crtc_kms;
+  MetaKmsUpdate *update;
+  g_autoptr (MetaDrmBuffer) buffer = NULL;
+  g_autoptr (MetaDrmBuffer) other_buffer = NULL;
+  gboolean passed;
+  int i;
+
+  device = meta_get_test_kms_device (test_context);
+  crtc = meta_get_test_kms_crtc (device);
+  connector = meta_get_test_kms_connector (device);
+  mode = meta_kms_connector_get_preferred_mode (connector);
+  crtc_kms = meta_crtc_kms_from_kms_crtc (crtc);
+  g_assert_nonnull (meta_crtc_get_config (META_CRTC (crtc_kms)));
+
+  buffer = meta_create_test_mode_dumb_buffer (device, mode);
+  other_buffer = meta_create_test_dumb_buffer (device, 64, 64);
+
+  meta_crtc_kms_invalidate_scanout_tests (crtc_kms);
+  g_assert_false (meta_crtc_kms_lookup_scanout_test (crtc_kms, buffer,
+                                                     &passed));
+
+  /* Results are kept per primary plane configuration */
+  meta_crtc_kms_cache_scanout_test (crtc_kms, buffer, TRUE);
+  g_assert_true (meta_crtc_kms_lookup_scanout_test (crtc_kms, buffer,
+                                                    &passed));
+  g_assert_true (passed);
+  g_assert_false (meta_crtc_kms_lookup_scanout_test (crtc_kms, other_buffer,
+                                                     &passed));
+
+  /* Passed results don't expire */
+  for (i = 0; i < META_CRTC_KMS_SCANOUT_TEST_FAILED_MAX_LOOKUPS * 2; i++)
+    {
+      g_assert_true (meta_crtc_kms_lookup_scanout_test (crtc_kms, buffer,
+                                                        &passed));
+      g_assert_true (passed);
+    }
+
+  /* Failed results, e.g. of a real commit that hit a busy CRTC, are tested
+   * again after a while */
+  meta_crtc_kms_cache_scanout_test (crtc_kms, buffer, FALSE);
+  for (i = 0; i < META_CRTC_KMS_SCANOUT_TEST_FAILED_MAX_LOOKUPS; i++)
+    {
+      g_assert_true (meta_crtc_kms_lookup_scanout_test (crtc_kms, buffer,
+                                                        &passed));
+      g_assert_false (passed);
+    }
+  g_assert_false (meta_crtc_kms_lookup_scanout_test (crtc_kms, buffer,
+                                                     &passed));
+
+  /* Setting the mode drops all results */
+  meta_crtc_kms_cache_scanout_test (crtc_kms, buffer, TRUE);
+  meta_crtc_kms_cache_scanout_test (crtc_kms, other_buffer, FALSE);
+
+  update = meta_kms_update_new (device);
+  meta_crtc_kms_set_mode (crtc_kms, update);
+  meta_kms_update_free (update);
+
+  g_assert_false (meta_crtc_kms_lookup_scanout_test (crtc_kms, buffer,
+                                                     &passed));
+  g_assert_false (meta_crtc_kms_lookup_scanout_test (crtc_kms, other_buffer,
+                                                     &passed));
+}
+
 static void
 init_tests (void)
 {
@@ -417,6 +488,8 @@ init_tests (void)
                    meta_test_kms_device_mode_set);
   g_test_add_func ("/backends/native/kms/device/power-save",
                    meta_test_kms_device_power_save);
+  g_test_add_func ("/backends/native/kms/device/scanout-test-cache",
+                   meta_test_kms_device_scanout_test_cache);
 }
 
 int
@@ -22,11 +22,14 @@
 
 #include <xf86drmMode.h>
 
+#include "backends/meta-renderer-view.h"
+#include "backends/meta-settings-private.h"
 #include "backends/native/meta-backend-native-private.h"
 #include "backends/native/meta-crtc-kms.h"
 #include "backends/native/meta-device-pool.h"
 #include "backends/native/meta-drm-buffer.h"
 #include "backends/native/meta-onscreen-native.h"
+#include "backends/native/meta-renderer-native.h"
 #include "backends/native/meta-kms.h"
 #include "backends/native/meta-kms-device.h"
 #include "core/display-private.h"
@@ -51,6 +54,11 @@ typedef struct
   } scanout;
 
   gboolean wait_for_scanout;
+
+  struct {
+    int n_queued;
+    gboolean expect_queued;
+  } synchronized_flips;
 } KmsRenderingTest;
 
 static MetaContext *test_context;
@@ -91,6 +99,115 @@ meta_test_kms_render_basic (void)
   g_signal_handler_disconnect (stage, handler_id);
 }
 
+static void
+on_synchronized_flips_after_paint (ClutterStage     *stage,
+                                   ClutterStageView *stage_view,
+                                   KmsRenderingTest *test)
+{
+  MetaBackend *backend = meta_context_get_backend (test_context);
+  MetaRenderer *renderer = meta_backend_get_renderer (backend);
+  MetaRendererNative *renderer_native = META_RENDERER_NATIVE (renderer);
+
+  /* The flip is held back until the frame has been dispatched */
+  if (meta_renderer_native_has_synchronized_flips (renderer_native))
+    test->synchronized_flips.n_queued++;
+}
+
+static void
+on_synchronized_flips_presented (ClutterStage     *stage,
+                                 ClutterStageView *stage_view,
+                                 ClutterFrameInfo *frame_info,
+                                 KmsRenderingTest *test)
+{
+  test->number_of_frames_left--;
+  if (test->number_of_frames_left == 0)
+    g_main_loop_quit (test->loop);
+  else
+    clutter_actor_queue_redraw (CLUTTER_ACTOR (stage));
+}
+
+static void
+meta_test_kms_render_synchronized_flips (void)
+{
+  MetaBackend *backend = meta_context_get_backend (test_context);
+  MetaSettings *settings = meta_backend_get_settings (backend);
+  MetaRenderer *renderer = meta_backend_get_renderer (backend);
+  ClutterActor *stage = meta_backend_get_stage (backend);
+  const char * const synchronized_flips_features[] = {
+    "kms-synchronized-flips",
+    NULL
+  };
+  GSettings *mutter_settings;
+  MetaRendererView *view;
+  MetaCrtc *crtc;
+  MetaKmsCrtc *kms_crtc;
+  MetaKmsDevice *kms_device;
+  KmsRenderingTest test;
+  gulong after_paint_handler_id;
+  gulong presented_handler_id;
+
+  view = META_RENDERER_VIEW (meta_renderer_get_views (renderer)->data);
+  crtc = meta_renderer_view_get_crtc (view);
+  kms_crtc = meta_crtc_kms_get_kms_crtc (META_CRTC_KMS (crtc));
+  kms_device = meta_kms_crtc_get_device (kms_crtc);
+
+  /* The test context overrides the experimental features, so make sure
+   * the keyword is accepted by the schema separately */
+  mutter_settings = g_settings_new ("org.gnome.mutter");
+  g_assert_true (g_settings_set_strv (mutter_settings,
+                                      "experimental-features",
+                                      synchronized_flips_features));
+  g_assert_cmpuint (g_settings_get_flags (mutter_settings,
+                                          "experimental-features"),
+                    ==,
+                    META_EXPERIMENTAL_FEATURE_KMS_SYNCHRONIZED_FLIPS);
+  g_settings_reset (mutter_settings, "experimental-features");
+  g_object_unref (mutter_settings);
+
+  meta_settings_enable_experimental_feature (
+    settings,
+    META_EXPERIMENTAL_FEATURE_KMS_SYNCHRONIZED_FLIPS);
+
+  test = (KmsRenderingTest) {
+    .number_of_frames_left = N_FRAMES_PER_TEST,
+    .loop = g_main_loop_new (NULL, FALSE),
+    .synchronized_flips = {
+      .expect_queued = !!(meta_kms_device_get_flags (kms_device) &
+                          META_KMS_DEVICE_FLAG_ATOMIC),
+    },
+  };
+  after_paint_handler_id =
+    g_signal_connect (stage, "after-paint",
+                      G_CALLBACK (on_synchronized_flips_after_paint), &test);
+  presented_handler_id =
+    g_signal_connect (stage, "presented",
+                      G_CALLBACK (on_synchronized_flips_presented), &test);
+
+  /* Every frame has to be presented, through the renderer posting the held
+   * back flips, or the main loop never quits */
+  clutter_actor_queue_redraw (CLUTTER_ACTOR (stage));
+  g_main_loop_run (test.loop);
+  g_main_loop_unref (test.loop);
+
+  g_assert_cmpint (test.number_of_frames_left, ==, 0);
+  g_assert_false (meta_renderer_native_has_synchronized_flips (
+    META_RENDERER_NATIVE (renderer)));
+
+  /* Only atomic mode setting commits flips of several CRTCs together */
+  if (test.synchronized_flips.expect_queued)
+    g_assert_cmpint (test.synchronized_flips.n_queued, >, 0);
+  else
+    g_assert_cmpint (test.synchronized_flips.n_queued, ==, 0);
+
+  g_signal_handler_disconnect (stage, after_paint_handler_id);
+  g_signal_handler_disconnect (stage, presented_handler_id);
+
+  meta_settings_override_experimental_features (settings);
+  meta_settings_enable_experimental_feature (
+    settings,
+    META_EXPERIMENTAL_FEATURE_SCALE_MONITOR_FRAMEBUFFER);
+}
+
 static void
 on_scanout_before_update (ClutterStage     *stage,
                           ClutterStageView *stage_view,
@@ -343,6 +460,8 @@ init_tests (void)
                    meta_test_kms_render_basic);
   g_test_add_func ("/backends/native/kms/render/client-scanout",
                    meta_test_kms_render_client_scanout);
+  g_test_add_func ("/backends/native/kms/render/synchronized-flips",
+                   meta_test_kms_render_synchronized_flips);
 }
 
 int
@@ -217,6 +217,189 @@ meta_test_kms_update_mode_sets (void)
   meta_kms_update_free (update);
 }
 
+static gboolean
+get_test_kms_crtc_pair (MetaKmsDevice  *device,
+                        MetaKmsCrtc   **crtc,
+                        MetaKmsCrtc   **other_crtc)
+{
+  GList *crtcs;
+
+  crtcs = meta_kms_device_get_crtcs (device);
+  if (g_list_length (crtcs) < 2)
+    {
+      g_test_skip ("Needs a device with at least two CRTCs");
+      return FALSE;
+    }
+
+  *crtc = crtcs->data;
+  *other_crtc = crtcs->next->data;
+  return TRUE;
+}
+
+static void
+meta_test_kms_update_merge (void)
+{
+  MetaKmsDevice *device;
+  MetaKmsUpdate *update;
+  MetaKmsUpdate *other_update;
+  MetaKmsCrtc *crtc;
+  MetaKmsCrtc *other_crtc;
+  MetaKmsConnector *connector;
+  MetaKmsPlane *primary_plane;
+  MetaKmsPlane *other_primary_plane;
+  MetaKmsMode *mode;
+  g_autoptr (MetaDrmBuffer) primary_buffer = NULL;
+  g_autoptr (MetaDrmBuffer) other_primary_buffer = NULL;
+  MetaKmsPlaneAssignment *primary_plane_assignment;
+  MetaKmsPlaneAssignment *other_primary_plane_assignment;
+  GList *plane_assignments;
+
+  device = meta_get_test_kms_device (test_context);
+  if (!get_test_kms_crtc_pair (device, &crtc, &other_crtc))
+    return;
+
+  connector = meta_get_test_kms_connector (device);
+  mode = meta_kms_connector_get_preferred_mode (connector);
+
+  primary_plane = meta_kms_device_get_primary_plane_for (device, crtc);
+  other_primary_plane = meta_kms_device_get_primary_plane_for (device,
+                                                               other_crtc);
+
+  update = meta_kms_update_new (device);
+  meta_kms_update_include_crtc (update, crtc);
+  primary_buffer = meta_create_test_mode_dumb_buffer (device, mode);
+  primary_plane_assignment =
+    meta_kms_update_assign_plane (update,
+                                  crtc,
+                                  primary_plane,
+                                  primary_buffer,
+                                  meta_get_mode_fixed_rect_16 (mode),
+                                  meta_get_mode_rect (mode),
+                                  META_KMS_ASSIGN_PLANE_FLAG_NONE);
+  meta_kms_update_mode_set (update, crtc,
+                            g_list_append (NULL, connector),
+                            mode);
+
+  other_update = meta_kms_update_new (device);
+  meta_kms_update_include_crtc (other_update, other_crtc);
+  other_primary_buffer = meta_create_test_mode_dumb_buffer (device, mode);
+  other_primary_plane_assignment =
+    meta_kms_update_assign_plane (other_update,
+                                  other_crtc,
+                                  other_primary_plane,
+                                  other_primary_buffer,
+                                  meta_get_mode_fixed_rect_16 (mode),
+                                  meta_get_mode_rect (mode),
+                                  META_KMS_ASSIGN_PLANE_FLAG_NONE);
+
+  meta_kms_update_merge_from (update, other_update);
+
+  g_assert_true (meta_kms_update_includes_crtc (update, crtc));
+  g_assert_true (meta_kms_update_includes_crtc (update, other_crtc));
+  plane_assignments = meta_kms_update_get_plane_assignments (update);
+  g_assert_cmpuint (g_list_length (plane_assignments), ==, 2);
+  g_assert_nonnull (g_list_find (plane_assignments, primary_plane_assignment));
+  g_assert_nonnull (g_list_find (plane_assignments,
+                                 other_primary_plane_assignment));
+  g_assert (primary_plane_assignment->update == update);
+  g_assert (other_primary_plane_assignment->update == update);
+  g_assert (meta_kms_update_get_primary_plane_assignment (update,
+                                                          other_crtc) ==
+            other_primary_plane_assignment);
+  g_assert_cmpuint (g_list_length (meta_kms_update_get_mode_sets (update)),
+                    ==, 1);
+
+  /* Splitting the other CRTC back out leaves the first one untouched */
+  other_update = meta_kms_update_split_crtc (update, other_crtc);
+
+  g_assert_true (meta_kms_update_includes_crtc (update, crtc));
+  g_assert_false (meta_kms_update_includes_crtc (update, other_crtc));
+  g_assert_true (meta_kms_update_includes_crtc (other_update, other_crtc));
+  plane_assignments = meta_kms_update_get_plane_assignments (update);
+  g_assert_cmpuint (g_list_length (plane_assignments), ==, 1);
+  g_assert (plane_assignments->data == primary_plane_assignment);
+  g_assert (primary_plane_assignment->update == update);
+  g_assert_cmpuint (g_list_length (meta_kms_update_get_mode_sets (update)),
+                    ==, 1);
+
+  plane_assignments = meta_kms_update_get_plane_assignments (other_update);
+  g_assert_cmpuint (g_list_length (plane_assignments), ==, 1);
+  g_assert (plane_assignments->data == other_primary_plane_assignment);
+  g_assert (other_primary_plane_assignment->update == other_update);
+  g_assert_null (meta_kms_update_get_mode_sets (other_update));
+
+  meta_kms_update_free (update);
+  meta_kms_update_free (other_update);
+}
+
+static void
+meta_test_kms_update_merge_failure (void)
+{
+  MetaKmsDevice *device;
+  MetaKms *kms;
+  MetaKmsUpdate *update;
+  MetaKmsCrtc *crtc;
+  MetaKmsCrtc *other_crtc;
+  MetaKmsConnector *connector;
+  MetaKmsMode *mode;
+  g_autoptr (MetaDrmBuffer) primary_buffer = NULL;
+  g_autoptr (MetaDrmBuffer) other_primary_buffer = NULL;
+  g_autoptr (GList) crtcs = NULL;
+  MetaKmsFeedback *feedback;
+  const MetaKmsCrtcState *crtc_state;
+
+  device = meta_get_test_kms_device (test_context);
+  if (!get_test_kms_crtc_pair (device, &crtc, &other_crtc))
+    return;
+
+  kms = meta_kms_device_get_kms (device);
+  connector = meta_get_test_kms_connector (device);
+  mode = meta_kms_connector_get_preferred_mode (connector);
+
+  update = meta_kms_ensure_pending_update_for_crtc (kms, crtc);
+  primary_buffer = meta_create_test_mode_dumb_buffer (device, mode);
+  meta_kms_update_mode_set (update, crtc,
+                            g_list_append (NULL, connector),
+                            mode);
+  meta_kms_update_assign_plane (update,
+                                crtc,
+                                meta_kms_device_get_primary_plane_for (device,
+                                                                       crtc),
+                                primary_buffer,
+                                meta_get_mode_fixed_rect_16 (mode),
+                                meta_get_mode_rect (mode),
+                                META_KMS_ASSIGN_PLANE_FLAG_NONE);
+
+  /* The other CRTC has no mode set, so flipping a buffer on it fails, and
+   * with it the commit of the merged update */
+  update = meta_kms_ensure_pending_update_for_crtc (kms, other_crtc);
+  other_primary_buffer = meta_create_test_mode_dumb_buffer (device, mode);
+  meta_kms_update_assign_plane (update,
+                                other_crtc,
+                                meta_kms_device_get_primary_plane_for (device,
+                                                                       other_crtc),
+                                other_primary_buffer,
+                                meta_get_mode_fixed_rect_16 (mode),
+                                meta_get_mode_rect (mode),
+                                META_KMS_ASSIGN_PLANE_FLAG_NONE);
+
+  crtcs = g_list_append (crtcs, crtc);
+  crtcs = g_list_append (crtcs, other_crtc);
+  feedback = meta_kms_post_pending_updates_for_crtcs_sync (kms, crtcs,
+                                                           META_KMS_UPDATE_FLAG_NONE);
+  g_assert_nonnull (feedback);
+  g_assert_nonnull (meta_kms_feedback_get_error (feedback));
+  meta_kms_feedback_free (feedback);
+
+  g_assert_null (meta_kms_get_pending_update_for_crtc (kms, crtc));
+  g_assert_null (meta_kms_get_pending_update_for_crtc (kms, other_crtc));
+
+  /* Posted on its own, the update of the first CRTC went through */
+  crtc_state = meta_kms_crtc_get_current_state (crtc);
+  g_assert_nonnull (crtc_state);
+  g_assert_true (crtc_state->is_active);
+}
+
 static void
 init_tests (void)
 {
@@ -228,6 +411,10 @@ init_tests (void)
                    meta_test_kms_update_plane_assignments);
   g_test_add_func ("/backends/native/kms/update/mode-sets",
                    meta_test_kms_update_mode_sets);
+  g_test_add_func ("/backends/native/kms/update/merge",
+                   meta_test_kms_update_merge);
+  g_test_add_func ("/backends/native/kms/update/merge-failure",
+                   meta_test_kms_update_merge_failure);
 }
 
 int
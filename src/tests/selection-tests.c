@@ -0,0 +1,480 @@
+/*
+ * Copyright (C) 2026 Buddies of Budgie
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include <fcntl.h>
+#include <gio/gunixinputstream.h>
+#include <gio/gunixoutputstream.h>
+#include <glib-unix.h>
+#include <glib/gstdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "core/display-private.h"
+#include "core/meta-clipboard-manager.h"
+#include "meta-test/meta-context-test.h"
+#include "meta/display.h"
+#include "meta/meta-selection.h"
+#include "meta/meta-selection-source-memory.h"
+
+#define TEST_MIMETYPE "application/x-mutter-test"
+
+#define TEST_TYPE_FD_SELECTION_SOURCE (test_fd_selection_source_get_type ())
+G_DECLARE_FINAL_TYPE (TestFdSelectionSource, test_fd_selection_source,
+                      TEST, FD_SELECTION_SOURCE, MetaSelectionSource)
+
+struct _TestFdSelectionSource
+{
+  MetaSelectionSource parent;
+
+  int fd;
+};
+
+G_DEFINE_TYPE (TestFdSelectionSource, test_fd_selection_source,
+               META_TYPE_SELECTION_SOURCE)
+
+static MetaContext *test_context;
+
+static void
+test_fd_selection_source_read_async (MetaSelectionSource *source,
+                                     const char          *mimetype,
+                                     GCancellable        *cancellable,
+                                     GAsyncReadyCallback  callback,
+                                     gpointer             user_data)
+{
+  TestFdSelectionSource *fd_source = TEST_FD_SELECTION_SOURCE (source);
+  g_autoptr (GTask) task = NULL;
+  GInputStream *stream;
+
+  task = g_task_new (source, cancellable, callback, user_data);
+
+  stream = g_unix_input_stream_new (fd_source->fd, TRUE);
+  fd_source->fd = -1;
+  g_task_return_pointer (task, stream, g_object_unref);
+}
+
+static GInputStream *
+test_fd_selection_source_read_finish (MetaSelectionSource  *source,
+                                      GAsyncResult         *result,
+                                      GError              **error)
+{
+  return g_task_propagate_pointer (G_TASK (result), error);
+}
+
+static GList *
+test_fd_selection_source_get_mimetypes (MetaSelectionSource *source)
+{
+  return g_list_prepend (NULL, g_strdup (TEST_MIMETYPE));
+}
+
+static void
+test_fd_selection_source_finalize (GObject *object)
+{
+  TestFdSelectionSource *fd_source = TEST_FD_SELECTION_SOURCE (object);
+
+  if (fd_source->fd != -1)
+    close (fd_source->fd);
+
+  G_OBJECT_CLASS (test_fd_selection_source_parent_class)->finalize (object);
+}
+
+static void
+test_fd_selection_source_class_init (TestFdSelectionSourceClass *klass)
+{
+  MetaSelectionSourceClass *source_class = META_SELECTION_SOURCE_CLASS (klass);
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+  object_class->finalize = test_fd_selection_source_finalize;
+
+  source_class->read_async = test_fd_selection_source_read_async;
+  source_class->read_finish = test_fd_selection_source_read_finish;
+  source_class->get_mimetypes = test_fd_selection_source_get_mimetypes;
+}
+
+static void
+test_fd_selection_source_init (TestFdSelectionSource *fd_source)
+{
+  fd_source->fd = -1;
+}
+
+static MetaSelectionSource *
+test_fd_selection_source_new (int fd)
+{
+  TestFdSelectionSource *fd_source;
+
+  fd_source = g_object_new (TEST_TYPE_FD_SELECTION_SOURCE, NULL);
+  fd_source->fd = fd;
+
+  return META_SELECTION_SOURCE (fd_source);
+}
+
+typedef struct
+{
+  gboolean done;
+  gboolean success;
+  GError *error;
+} TransferResult;
+
+static void
+transfer_cb (MetaSelection  *selection,
+             GAsyncResult   *result,
+             TransferResult *transfer_result)
+{
+  transfer_result->success =
+    meta_selection_transfer_finish (selection, result,
+                                    &transfer_result->error);
+  transfer_result->done = TRUE;
+}
+
+static void
+transfer_fd (int             in_fd,
+             int             out_fd,
+             gssize          size,
+             GCancellable   *cancellable,
+             TransferResult *transfer_result)
+{
+  MetaDisplay *display = meta_context_get_display (test_context);
+  MetaSelection *selection = meta_display_get_selection (display);
+  MetaSelectionSource *source;
+  GOutputStream *output;
+
+  source = test_fd_selection_source_new (in_fd);
+  meta_selection_set_owner (selection, META_SELECTION_PRIMARY, source);
+
+  output = g_unix_output_stream_new (out_fd, TRUE);
+  meta_selection_transfer_async (selection,
+                                 META_SELECTION_PRIMARY,
+                                 TEST_MIMETYPE,
+                                 size,
+                                 output,
+                                 cancellable,
+                                 (GAsyncReadyCallback) transfer_cb,
+                                 transfer_result);
+
+  while (!transfer_result->done)
+    g_main_context_iteration (NULL, TRUE);
+
+  /* Let the transfer drop its references to the streams. */
+  while (g_main_context_iteration (NULL, FALSE));
+
+  meta_selection_unset_owner (selection, META_SELECTION_PRIMARY, source);
+
+  /* Neither the source, nor the output stream outlive the transfer. */
+  g_object_add_weak_pointer (G_OBJECT (source), (gpointer *) &source);
+  g_object_add_weak_pointer (G_OBJECT (output), (gpointer *) &output);
+  g_object_unref (source);
+  g_object_unref (output);
+  g_assert_null (source);
+  g_assert_null (output);
+}
+
+static GBytes *
+create_test_contents (size_t size)
+{
+  uint8_t *data;
+  size_t i;
+
+  data = g_malloc (size);
+  for (i = 0; i < size; i++)
+    data[i] = i % 251;
+
+  return g_bytes_new_take (data, size);
+}
+
+static GBytes *
+read_all (int fd)
+{
+  GByteArray *array;
+  uint8_t buffer[4096];
+  ssize_t n_read;
+
+  array = g_byte_array_new ();
+  while ((n_read = read (fd, buffer, sizeof (buffer))) > 0)
+    g_byte_array_append (array, buffer, n_read);
+  g_assert_cmpint (n_read, ==, 0);
+
+  return g_byte_array_free_to_bytes (array);
+}
+
+static void
+assert_contents_prefix (GBytes *contents,
+                        GBytes *expected,
+                        size_t  size)
+{
+  g_assert_cmpuint (g_bytes_get_size (contents), ==, size);
+  g_assert_cmpmem (g_bytes_get_data (contents, NULL), size,
+                   g_bytes_get_data (expected, NULL), size);
+}
+
+static void
+write_pipe_contents (int     fd,
+                     GBytes *contents)
+{
+  size_t size;
+  const uint8_t *data = g_bytes_get_data (contents, &size);
+
+  g_assert_cmpint (write (fd, data, size), ==, size);
+}
+
+static void
+meta_test_selection_transfer_pipe (void)
+{
+  g_autoptr (GBytes) contents = NULL;
+  g_autoptr (GBytes) transferred = NULL;
+  TransferResult transfer_result = { 0 };
+  int in_pipe[2], out_pipe[2];
+
+  /* Stay below the default pipe capacity so nothing needs to drain the
+   * output pipe while the transfer runs.
+   */
+  contents = create_test_contents (32 * 1024);
+
+  g_assert_true (g_unix_open_pipe (in_pipe, FD_CLOEXEC, NULL));
+  g_assert_true (g_unix_open_pipe (out_pipe, FD_CLOEXEC, NULL));
+  write_pipe_contents (in_pipe[1], contents);
+  close (in_pipe[1]);
+
+  transfer_fd (in_pipe[0], out_pipe[1], -1, NULL, &transfer_result);
+  g_assert_no_error (transfer_result.error);
+  g_assert_true (transfer_result.success);
+
+  transferred = read_all (out_pipe[0]);
+  close (out_pipe[0]);
+  assert_contents_prefix (transferred, contents, g_bytes_get_size (contents));
+}
+
+static void
+meta_test_selection_transfer_pipe_limited (void)
+{
+  g_autoptr (GBytes) contents = NULL;
+  g_autoptr (GBytes) transferred = NULL;
+  TransferResult transfer_result = { 0 };
+  int in_pipe[2], out_pipe[2];
+
+  contents = create_test_contents (32 * 1024);
+
+  g_assert_true (g_unix_open_pipe (in_pipe, FD_CLOEXEC, NULL));
+  g_assert_true (g_unix_open_pipe (out_pipe, FD_CLOEXEC, NULL));
+  write_pipe_contents (in_pipe[1], contents);
+  close (in_pipe[1]);
+
+  transfer_fd (in_pipe[0], out_pipe[1], 1000, NULL, &transfer_result);
+  g_assert_no_error (transfer_result.error);
+  g_assert_true (transfer_result.success);
+
+  /* Transfers with a size limit leave the output stream open. */
+  transferred = read_all (out_pipe[0]);
+  close (out_pipe[0]);
+  assert_contents_prefix (transferred, contents, 1000);
+}
+
+static void
+meta_test_selection_transfer_file (void)
+{
+  g_autoptr (GBytes) contents = NULL;
+  g_autoptr (GBytes) transferred = NULL;
+  g_autofree char *in_path = NULL;
+  g_autofree char *out_path = NULL;
+  TransferResult transfer_result = { 0 };
+  int in_fd, out_fd;
+
+  /* splice(2) needs a pipe on one end, so a transfer between two regular
+   * files has to fall back to the stream copy.
+   */
+  contents = create_test_contents (256 * 1024);
+
+  in_fd = g_file_open_tmp ("mutter-selection-in-XXXXXX", &in_path, NULL);
+  g_assert_cmpint (in_fd, >=, 0);
+  write_pipe_contents (in_fd, contents);
+  g_assert_cmpint (lseek (in_fd, 0, SEEK_SET), ==, 0);
+
+  out_fd = g_file_open_tmp ("mutter-selection-out-XXXXXX", &out_path, NULL);
+  g_assert_cmpint (out_fd, >=, 0);
+
+  transfer_fd (in_fd, out_fd, -1, NULL, &transfer_result);
+  g_assert_no_error (transfer_result.error);
+  g_assert_true (transfer_result.success);
+
+  out_fd = g_open (out_path, O_RDONLY, 0);
+  g_assert_cmpint (out_fd, >=, 0);
+  transferred = read_all (out_fd);
+  close (out_fd);
+  assert_contents_prefix (transferred, contents, g_bytes_get_size (contents));
+
+  g_unlink (in_path);
+  g_unlink (out_path);
+}
+
+static gboolean
+cancel_idle_cb (gpointer user_data)
+{
+  g_cancellable_cancel (G_CANCELLABLE (user_data));
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+meta_test_selection_transfer_pipe_cancel (void)
+{
+  g_autoptr (GCancellable) cancellable = NULL;
+  TransferResult transfer_result = { 0 };
+  int in_pipe[2], out_pipe[2];
+
+  g_assert_true (g_unix_open_pipe (in_pipe, FD_CLOEXEC, NULL));
+  g_assert_true (g_unix_open_pipe (out_pipe, FD_CLOEXEC, NULL));
+
+  /* The write end stays open without data, so the splice would wait
+   * forever unless the transfer gets cancelled.
+   */
+  cancellable = g_cancellable_new ();
+  g_idle_add (cancel_idle_cb, cancellable);
+
+  transfer_fd (in_pipe[0], out_pipe[1], -1, cancellable, &transfer_result);
+  g_assert_error (transfer_result.error, G_IO_ERROR, G_IO_ERROR_CANCELLED);
+  g_assert_false (transfer_result.success);
+  g_clear_error (&transfer_result.error);
+
+  close (in_pipe[1]);
+  close (out_pipe[0]);
+}
+
+static gboolean
+clipboard_history_contains (GBytes *content)
+{
+  MetaDisplay *display = meta_context_get_display (test_context);
+  GList *l;
+
+  for (l = display->clipboard_history; l; l = l->next)
+    {
+      MetaClipboardEntry *entry = l->data;
+
+      if (entry->content == content)
+        return TRUE;
+    }
+
+  return FALSE;
+}
+
+static GBytes *
+save_clipboard (const char *text)
+{
+  MetaDisplay *display = meta_context_get_display (test_context);
+  MetaSelection *selection = meta_display_get_selection (display);
+  g_autoptr (MetaSelectionSource) source = NULL;
+  g_autoptr (GBytes) bytes = NULL;
+
+  bytes = g_bytes_new (text, strlen (text));
+  source = meta_selection_source_memory_new ("text/plain", bytes);
+  meta_selection_set_owner (selection, META_SELECTION_CLIPBOARD, source);
+
+  while (!display->saved_clipboard)
+    g_main_context_iteration (NULL, TRUE);
+
+  g_assert_cmpmem (g_bytes_get_data (display->saved_clipboard, NULL),
+                   g_bytes_get_size (display->saved_clipboard),
+                   text, strlen (text));
+
+  return g_bytes_ref (display->saved_clipboard);
+}
+
+static void
+meta_test_selection_clipboard_history (void)
+{
+  MetaDisplay *display = meta_context_get_display (test_context);
+  MetaSelection *selection = meta_display_get_selection (display);
+  g_autoptr (GBytes) first = NULL;
+  g_autoptr (GBytes) second = NULL;
+  g_autoptr (GBytes) content = NULL;
+  g_autoptr (MetaSelectionSource) unsupported_source = NULL;
+  MetaClipboardEntry *entry;
+  int i;
+
+  first = save_clipboard ("Clipboard contents");
+  second = save_clipboard ("Other clipboard contents");
+  g_assert_true (clipboard_history_contains (first));
+  g_assert_true (clipboard_history_contains (second));
+
+  /* Copying earlier contents again reuses their mapping, and makes them
+   * the most recent entry.
+   */
+  content = save_clipboard ("Clipboard contents");
+  g_assert_true (content == first);
+  entry = display->clipboard_history->data;
+  g_assert_true (entry->content == first);
+  g_clear_pointer (&content, g_bytes_unref);
+
+  /* Unsupported contents leave the history alone. */
+  unsupported_source = test_fd_selection_source_new (-1);
+  meta_selection_set_owner (selection, META_SELECTION_CLIPBOARD,
+                            unsupported_source);
+  g_assert_null (display->saved_clipboard);
+  g_assert_true (clipboard_history_contains (first));
+
+  /* The history is bounded, older entries are dropped from it. */
+  for (i = 0; i < 16; i++)
+    {
+      g_autofree char *text = NULL;
+
+      text = g_strdup_printf ("Clipboard contents %d", i);
+      content = save_clipboard (text);
+      g_assert_true (clipboard_history_contains (content));
+      g_clear_pointer (&content, g_bytes_unref);
+    }
+
+  g_assert_cmpuint (g_list_length (display->clipboard_history), <, 16);
+  g_assert_false (clipboard_history_contains (first));
+  g_assert_false (clipboard_history_contains (second));
+
+  /* Once dropped, copying the same contents again creates a new mapping. */
+  content = save_clipboard ("Clipboard contents");
+  g_assert_true (content != first);
+  g_assert_true (clipboard_history_contains (content));
+}
+
+static void
+init_tests (void)
+{
+  g_test_add_func ("/core/selection/transfer/pipe",
+                   meta_test_selection_transfer_pipe);
+  g_test_add_func ("/core/selection/transfer/pipe-limited",
+                   meta_test_selection_transfer_pipe_limited);
+  g_test_add_func ("/core/selection/transfer/file",
+                   meta_test_selection_transfer_file);
+  g_test_add_func ("/core/selection/transfer/pipe-cancel",
+                   meta_test_selection_transfer_pipe_cancel);
+  g_test_add_func ("/core/selection/clipboard/history",
+                   meta_test_selection_clipboard_history);
+}
+
+int
+main (int    argc,
+      char **argv)
+{
+  g_autoptr (MetaContext) context = NULL;
+
+  context = meta_create_test_context (META_CONTEXT_TEST_TYPE_HEADLESS,
+                                      META_CONTEXT_TEST_FLAG_NO_X11);
+  g_assert (meta_context_configure (context, &argc, &argv, NULL));
+
+  test_context = context;
+
+  init_tests ();
+
+  return meta_context_test_run_tests (META_CONTEXT_TEST (context),
+                                      META_TEST_RUN_FLAG_NONE);
+}
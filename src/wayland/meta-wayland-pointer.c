@@ -346,30 +346,20 @@ meta_wayland_pointer_broadcast_frame (MetaWaylandPointer *pointer)
     }
 }
 
-void
-meta_wayland_pointer_send_relative_motion (MetaWaylandPointer *pointer,
-                                           const ClutterEvent *event)
+static void
+send_relative_motion_sample (MetaWaylandPointer *pointer,
+                             uint64_t            time_us,
+                             double              dx,
+                             double              dy,
+                             double              dx_unaccel,
+                             double              dy_unaccel)
 {
   struct wl_resource *resource;
-  double dx, dy;
-  double dx_unaccel, dy_unaccel;
-  uint64_t time_us;
   uint32_t time_us_hi;
   uint32_t time_us_lo;
   wl_fixed_t dxf, dyf;
   wl_fixed_t dx_unaccelf, dy_unaccelf;
 
-  if (!pointer->focus_client)
-    return;
-
-  if (!clutter_event_get_relative_motion (event,
-                                          &dx, &dy,
-                                          &dx_unaccel, &dy_unaccel))
-    return;
-
-  time_us = clutter_event_get_time_us (event);
-  if (time_us == 0)
-    time_us = clutter_event_get_time (event) * 1000ULL;
   time_us_hi = (uint32_t) (time_us >> 32);
   time_us_lo = (uint32_t) time_us;
   dxf = wl_fixed_from_double (dx);
@@ -390,6 +380,50 @@ meta_wayland_pointer_send_relative_motion (MetaWaylandPointer *pointer,
     }
 }
 
+void
+meta_wayland_pointer_send_relative_motion (MetaWaylandPointer *pointer,
+                                           const ClutterEvent *event)
+{
+  const ClutterMotionHistoryEntry *motion_history;
+  unsigned int n_entries, i;
+  double dx, dy;
+  double dx_unaccel, dy_unaccel;
+  uint64_t time_us;
+
+  if (!pointer->focus_client)
+    return;
+
+  if (!clutter_event_get_relative_motion (event,
+                                          &dx, &dy,
+                                          &dx_unaccel, &dy_unaccel))
+    return;
+
+  /* Compressed motion events carry each of the samples they were made of,
+   * pass them on individually so clients get the full device rate.
+   */
+  motion_history = clutter_event_get_motion_history (event, &n_entries);
+  if (motion_history)
+    {
+      for (i = 0; i < n_entries; i++)
+        {
+          send_relative_motion_sample (pointer,
+                                       motion_history[i].time_us,
+                                       motion_history[i].dx,
+                                       motion_history[i].dy,
+                                       motion_history[i].dx_unaccel,
+                                       motion_history[i].dy_unaccel);
+        }
+      return;
+    }
+
+  time_us = clutter_event_get_time_us (event);
+  if (time_us == 0)
+    time_us = clutter_event_get_time (event) * 1000ULL;
+
+  send_relative_motion_sample (pointer, time_us,
+                               dx, dy, dx_unaccel, dy_unaccel);
+}
+
 void
 meta_wayland_pointer_send_motion (MetaWaylandPointer *pointer,
                                   const ClutterEvent *event)
@@ -62,6 +62,10 @@ struct _MetaXWaylandManager
   guint abstract_fd_watch_id;
   guint unix_fd_watch_id;
 
+  guint prelaunch_idle_watch_id;
+  gboolean prelaunch_scheduled;
+  gboolean xserver_used;
+
   struct wl_display *wayland_display;
   struct wl_client *client;
   struct wl_resource *xserver_resource;
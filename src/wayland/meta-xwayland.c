@@ -50,7 +50,9 @@
 #include "backends/meta-settings-private.h"
 #include "meta/main.h"
 #include "meta/meta-backend.h"
+#include "meta/meta-idle-monitor.h"
 #include "meta/meta-x11-errors.h"
+#include "meta/window.h"
 #include "wayland/meta-xwayland-surface.h"
 #include "x11/meta-x11-display-private.h"
 
@@ -60,6 +62,10 @@
 #define XWAYLAND_LISTENFD "-listen"
 #endif
 
+/* How long the user has to be idle before Xwayland is started in the
+ * background when it is prelaunched */
+#define XWAYLAND_PRELAUNCH_IDLE_TIME_MS 3000
+
 #define TMP_UNIX_DIR         "/tmp"
 #define X11_TMP_UNIX_DIR     "/tmp/.X11-unix"
 #define X11_TMP_UNIX_PATH    "/tmp/.X11-unix/X"
@@ -429,11 +435,19 @@ xserver_died (GObject      *source,
     }
   else if (x11_display_policy == META_X11_DISPLAY_POLICY_ON_DEMAND)
     {
+      MetaXWaylandManager *manager = &compositor->xwayland_manager;
       g_autoptr (GError) error = NULL;
 
       if (display->x11_display)
         meta_display_shutdown_x11 (display);
 
+      /* Xwayland closed itself after its last X11 client went away; if it
+       * had any, prelaunch it again so the next X11 client doesn't have to
+       * wait for it either. */
+      if (g_subprocess_get_successful (proc) && manager->xserver_used)
+        manager->prelaunch_scheduled = FALSE;
+      manager->xserver_used = FALSE;
+
       if (!meta_xwayland_init (&compositor->xwayland_manager,
                                compositor,
                                compositor->wayland_display,
@@ -792,6 +806,7 @@ meta_xwayland_start_xserver (MetaXWaylandManager *manager,
     meta_wayland_compositor_get_default ();
   MetaX11DisplayPolicy x11_display_policy =
     meta_context_get_x11_display_policy (compositor->context);
+  char terminate_delay[16];
 #endif
   struct {
     const char *extension_name;
@@ -886,9 +901,11 @@ meta_xwayland_start_xserver (MetaXWaylandManager *manager,
     {
       if (x11_display_policy == META_X11_DISPLAY_POLICY_ON_DEMAND)
         {
-          /* Terminate after a 10 seconds delay */
+          g_snprintf (terminate_delay, sizeof (terminate_delay), "%u",
+                      meta_settings_get_xwayland_autoclose_delay (settings));
+
           args[i++] = "-terminate";
-          args[i++] = "10";
+          args[i++] = terminate_delay;
         }
       else
         {
@@ -948,12 +965,23 @@ meta_xwayland_start_xserver_finish (MetaXWaylandManager  *manager,
   return g_task_propagate_boolean (G_TASK (result), error);
 }
 
-static gboolean
-xdisplay_connection_activity_cb (gint         fd,
-                                 GIOCondition cond,
-                                 gpointer     user_data)
+static void
+clear_prelaunch_watch (MetaXWaylandManager *manager)
+{
+  MetaIdleMonitor *core_monitor;
+
+  if (!manager->prelaunch_idle_watch_id)
+    return;
+
+  core_monitor = meta_backend_get_core_idle_monitor (meta_get_backend ());
+  meta_idle_monitor_remove_watch (core_monitor,
+                                  manager->prelaunch_idle_watch_id);
+  manager->prelaunch_idle_watch_id = 0;
+}
+
+static void
+meta_xwayland_start_on_demand (MetaXWaylandManager *manager)
 {
-  MetaXWaylandManager *manager = user_data;
   MetaDisplay *display = meta_get_display ();
 
   meta_display_init_x11 (display, NULL,
@@ -962,10 +990,69 @@ xdisplay_connection_activity_cb (gint         fd,
   /* Stop watching both file descriptors */
   g_clear_handle_id (&manager->abstract_fd_watch_id, g_source_remove);
   g_clear_handle_id (&manager->unix_fd_watch_id, g_source_remove);
+  clear_prelaunch_watch (manager);
+}
+
+static gboolean
+xdisplay_connection_activity_cb (gint         fd,
+                                 GIOCondition cond,
+                                 gpointer     user_data)
+{
+  MetaXWaylandManager *manager = user_data;
+
+  manager->xserver_used = TRUE;
+  meta_xwayland_start_on_demand (manager);
 
   return G_SOURCE_REMOVE;
 }
 
+static void
+prelaunch_xserver_idle_cb (MetaIdleMonitor *monitor,
+                           guint            watch_id,
+                           gpointer         user_data)
+{
+  MetaXWaylandManager *manager = user_data;
+
+  /* The display might still be being set up if startup is slow, in
+   * which case the watch triggers again the next time the user goes
+   * idle. */
+  if (!meta_get_display ())
+    return;
+
+  meta_topic (META_DEBUG_WAYLAND, "Prelaunching Xwayland");
+
+  meta_xwayland_start_on_demand (manager);
+}
+
+static void
+maybe_schedule_prelaunch (MetaXWaylandManager *manager)
+{
+  MetaBackend *backend = meta_get_backend ();
+  MetaSettings *settings = meta_backend_get_settings (backend);
+  MetaIdleMonitor *core_monitor;
+
+  /* Only do this once per Xwayland that got used; if a prelaunched
+   * Xwayland was closed again without any X11 client showing up, it's
+   * started again only once it's needed. */
+  if (manager->prelaunch_scheduled)
+    return;
+
+  if (!meta_settings_is_experimental_feature_enabled (settings,
+                                                     META_EXPERIMENTAL_FEATURE_PRELAUNCH_XWAYLAND))
+    return;
+
+  /* Wait for the user to be idle so that starting Xwayland doesn't
+   * compete with whatever the user is doing, such as the session
+   * starting up or the first applications being launched. */
+  core_monitor = meta_backend_get_core_idle_monitor (backend);
+  manager->prelaunch_idle_watch_id =
+    meta_idle_monitor_add_idle_watch (core_monitor,
+                                      XWAYLAND_PRELAUNCH_IDLE_TIME_MS,
+                                      prelaunch_xserver_idle_cb,
+                                      manager, NULL);
+  manager->prelaunch_scheduled = TRUE;
+}
+
 static void
 meta_xwayland_stop_xserver (MetaXWaylandManager *manager)
 {
@@ -1035,6 +1122,8 @@ meta_xwayland_init (MetaXWaylandManager    *manager,
       manager->unix_fd_watch_id =
         g_unix_fd_add (manager->public_connection.unix_fd, G_IO_IN,
                        xdisplay_connection_activity_cb, manager);
+
+      maybe_schedule_prelaunch (manager);
     }
 
   return TRUE;
@@ -1093,6 +1182,15 @@ on_x11_display_setup (MetaDisplay         *display,
   meta_xwayland_init_xrandr (manager, x11_display);
 }
 
+static void
+on_window_created (MetaDisplay         *display,
+                   MetaWindow          *window,
+                   MetaXWaylandManager *manager)
+{
+  if (meta_window_get_client_type (window) == META_WINDOW_CLIENT_TYPE_X11)
+    manager->xserver_used = TRUE;
+}
+
 void
 meta_xwayland_init_display (MetaXWaylandManager *manager,
                             MetaDisplay         *display)
@@ -1101,6 +1199,8 @@ meta_xwayland_init_display (MetaXWaylandManager *manager,
                     G_CALLBACK (on_x11_display_setup), manager);
   g_signal_connect (display, "x11-display-closing",
                     G_CALLBACK (on_x11_display_closing), manager);
+  g_signal_connect (display, "window-created",
+                    G_CALLBACK (on_window_created), manager);
 }
 
 void
@@ -1137,6 +1237,7 @@ meta_xwayland_shutdown (MetaXWaylandManager *manager)
   char path[256];
 
   g_cancellable_cancel (manager->xserver_died_cancellable);
+  clear_prelaunch_watch (manager);
 
   XSetIOErrorHandler (x_io_error_noop);
 #ifdef HAVE_XSETIOERROREXITHANDLER
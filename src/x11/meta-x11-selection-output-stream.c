@@ -47,6 +47,8 @@ struct _MetaX11SelectionOutputStreamPrivate
   GMutex mutex;
   GCond cond;
   GByteArray *data;
+  size_t data_offset;
+  size_t max_request_size;
   guint flush_requested : 1;
 
   GTask *pending_task;
@@ -62,6 +64,34 @@ G_DEFINE_TYPE_WITH_PRIVATE (MetaX11SelectionOutputStream,
 
 static size_t get_element_size (int format);
 
+static size_t
+get_pending_size (MetaX11SelectionOutputStreamPrivate *priv)
+{
+  return priv->data->len - priv->data_offset;
+}
+
+static void
+consume_pending_data (MetaX11SelectionOutputStreamPrivate *priv,
+                      size_t                               size)
+{
+  priv->data_offset += size;
+
+  /* INCR transfers hand out the buffer in chunks of the maximum request
+   * size; only move the tail around once most of the buffer has been
+   * consumed, rather than on every chunk.
+   */
+  if (priv->data_offset == priv->data->len)
+    {
+      g_byte_array_set_size (priv->data, 0);
+      priv->data_offset = 0;
+    }
+  else if (priv->data_offset > priv->data->len / 2)
+    {
+      g_byte_array_remove_range (priv->data, 0, priv->data_offset);
+      priv->data_offset = 0;
+    }
+}
+
 static void
 meta_x11_selection_output_stream_notify_selection (MetaX11SelectionOutputStream *stream)
 {
@@ -100,7 +130,7 @@ meta_x11_selection_output_stream_can_flush (MetaX11SelectionOutputStream *stream
   if (priv->delete_pending)
     return FALSE;
   if (!g_output_stream_is_closing (G_OUTPUT_STREAM (stream)) &&
-      priv->data->len < get_element_size (priv->format))
+      get_pending_size (priv) < get_element_size (priv->format))
     return FALSE;
 
   return TRUE;
@@ -124,7 +154,7 @@ meta_x11_selection_output_stream_needs_flush_unlocked (MetaX11SelectionOutputStr
   MetaX11SelectionOutputStreamPrivate *priv =
     meta_x11_selection_output_stream_get_instance_private (stream);
 
-  if (priv->data->len == 0)
+  if (get_pending_size (priv) == 0)
     {
       if (priv->incr)
         return g_output_stream_is_closing (G_OUTPUT_STREAM (stream));
@@ -138,7 +168,7 @@ meta_x11_selection_output_stream_needs_flush_unlocked (MetaX11SelectionOutputStr
   if (priv->flush_requested)
     return TRUE;
 
-  return priv->data->len >= get_max_request_size (priv->x11_display);
+  return get_pending_size (priv) >= priv->max_request_size;
 }
 
 static gboolean
@@ -217,13 +247,13 @@ meta_x11_selection_output_stream_perform_flush (MetaX11SelectionOutputStream *st
   g_mutex_lock (&priv->mutex);
 
   element_size = get_element_size (priv->format);
-  n_elements = priv->data->len / element_size;
-  max_size = get_max_request_size (priv->x11_display);
+  n_elements = get_pending_size (priv) / element_size;
+  max_size = priv->max_request_size;
 
   if (!priv->incr)
     first_chunk = TRUE;
 
-  if (!priv->incr && priv->data->len > max_size)
+  if (!priv->incr && get_pending_size (priv) > max_size)
     {
       XWindowAttributes attrs;
 
@@ -250,7 +280,7 @@ meta_x11_selection_output_stream_perform_flush (MetaX11SelectionOutputStream *st
     {
       size_t copy_n_elements;
 
-      if (priv->incr && priv->data->len > 0)
+      if (priv->incr && get_pending_size (priv) > 0)
         priv->delete_pending = TRUE;
 
       copy_n_elements = MIN (n_elements, max_size / element_size);
@@ -261,9 +291,9 @@ meta_x11_selection_output_stream_perform_flush (MetaX11SelectionOutputStream *st
                        priv->xtype,
                        priv->format,
                        PropModeReplace,
-                       priv->data->data,
+                       priv->data->data + priv->data_offset,
                        copy_n_elements);
-      g_byte_array_remove_range (priv->data, 0, copy_n_elements * element_size);
+      consume_pending_data (priv, copy_n_elements * element_size);
     }
 
   if (first_chunk)
@@ -293,7 +323,9 @@ meta_x11_selection_output_stream_perform_flush (MetaX11SelectionOutputStream *st
           g_clear_object (&priv->pending_task);
         }
     }
-  else if (priv->pending_task && priv->data->len == 0 && !priv->delete_pending)
+  else if (priv->pending_task &&
+           get_pending_size (priv) == 0 &&
+           !priv->delete_pending)
     {
       size_t result;
 
@@ -316,7 +348,7 @@ meta_x11_selection_output_stream_invoke_flush (gpointer data)
       meta_x11_selection_output_stream_can_flush (stream))
     meta_x11_selection_output_stream_perform_flush (stream);
 
-  if (priv->delete_pending || priv->data->len > 0)
+  if (priv->delete_pending || get_pending_size (priv) > 0)
     return G_SOURCE_CONTINUE;
   else
     return G_SOURCE_REMOVE;
@@ -419,7 +451,7 @@ meta_x11_selection_output_request_flush (MetaX11SelectionOutputStream *stream)
 
   g_mutex_lock (&priv->mutex);
 
-  if (priv->data->len > 0)
+  if (get_pending_size (priv) > 0)
     priv->flush_requested = TRUE;
 
   needs_flush = meta_x11_selection_output_stream_needs_flush_unlocked (stream);
@@ -681,6 +713,7 @@ meta_x11_selection_output_stream_new (MetaX11Display *x11_display,
   priv->xtype = XInternAtom (x11_display->xdisplay, type, False);
   priv->format = format;
   priv->timestamp = timestamp;
+  priv->max_request_size = get_max_request_size (x11_display);
 
   return G_OUTPUT_STREAM (stream);
 }